@@ -45,6 +45,10 @@ if [ -f "$BINARY_PATH" ]; then
     mkdir -p "$BIN_DIR"
     cp "$BINARY_PATH" "$BIN_DIR/"
     echo "✅ Binary copied to $BIN_DIR/$BINARY_NAME"
+    # Token dump viewer (renders the tokens.tok written by hackasm -t)
+    if [ -f "$(dirname "$BINARY_PATH")/hacktok" ]; then
+        cp "$(dirname "$BINARY_PATH")/hacktok" "$BIN_DIR/"
+    fi
 else
     echo "❌ Binary not found at $BINARY_PATH"
     exit 1
@@ -1,7 +1,7 @@
 #!/bin/bash
 
 BUILD_TYPE="debug"
-TEST_NAMES=("token" "symbol_table" "parser" "code_generator")
+TEST_NAMES=("token" "symbol_table" "parser" "code_generator" "line_scanner" "parallel" "assembler" "server" "cache" "stream" "token_dump" "batch")
 
 while getopts "b:" opt; do
   case ${opt} in
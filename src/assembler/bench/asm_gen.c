@@ -0,0 +1,68 @@
+#include "asm_gen.h"
+
+static const char *const DESTS[] = {"", "M=", "D=", "MD=", "A=", "AM=", "AD=", "AMD="};
+static const char *const COMPS[] = {
+    "0", "1", "-1", "D", "A", "M", "!D", "!A", "!M", "-D", "-A", "-M", "D+1", "A+1",
+    "M+1", "D-1", "A-1", "M-1", "D+A", "D+M", "D-A", "D-M", "A-D", "M-D", "D&A", "D&M", "D|A", "D|M"
+};
+static const char *const JUMPS[] = {";JGT", ";JEQ", ";JGE", ";JLT", ";JNE", ";JLE", ";JMP"};
+
+#define COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+// xorshift64*: fast, and identical on every platform for a given seed
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+// True with the given probability
+static bool chance(uint64_t *state, const double probability) {
+    return (double)(next_random(state) >> 11) * 0x1.0p-53 < probability;
+}
+
+bool asm_gen_write(FILE *out, const AsmGenOptions *options) {
+    if (!out || !options || options->label_density < 0 || options->label_density > 1 ||
+        options->variable_density < 0 || options->variable_density > 1 ||
+        options->variables > ASM_GEN_MAX_VARIABLES) {
+        return false;
+    }
+
+    uint64_t state = options->seed ? options->seed : 1;
+    const uint64_t labels = (uint64_t)((double)options->lines * options->label_density);
+    const uint64_t label_every = labels ? options->lines / labels : 0;
+    uint64_t defined = 0;
+
+    for (uint64_t line = 0; line < options->lines; line++) {
+        // Labels are spread evenly, so label k is always defined and references may point forward
+        if (label_every && line % label_every == label_every - 1 && defined < labels) {
+            fprintf(out, "(LABEL_%llu)\n", (unsigned long long)defined++);
+            continue;
+        }
+
+        const uint64_t pick = next_random(&state) % 100;
+        if (pick < 2) {
+            fputs(pick == 0 ? "\n" : "// generated comment line\n", out);
+        } else if (pick < 50) {
+            // A-instruction: a variable, a label or a number
+            if (options->variables && chance(&state, options->variable_density)) {
+                fprintf(out, "@var_%llu\n", (unsigned long long)(next_random(&state) % options->variables));
+            } else if (labels && chance(&state, 0.3)) {
+                fprintf(out, "@LABEL_%llu\n", (unsigned long long)(next_random(&state) % labels));
+            } else {
+                fprintf(out, "@%llu\n", (unsigned long long)(next_random(&state) % 32768));
+            }
+        } else {
+            // C-instruction: dest=comp, or comp;jump now and then
+            const uint64_t bits = next_random(&state);
+            const char *comp = COMPS[(bits >> 8) % COUNT(COMPS)];
+            if (bits % 8 == 0) {
+                fprintf(out, "%s%s\n", comp, JUMPS[(bits >> 16) % COUNT(JUMPS)]);
+            } else {
+                fprintf(out, "%s%s\n", DESTS[1 + (bits >> 16) % (COUNT(DESTS) - 1)], comp);
+            }
+        }
+    }
+    return !ferror(out);
+}
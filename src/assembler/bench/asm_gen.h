@@ -0,0 +1,39 @@
+#ifndef ASM_GEN_H
+#define ASM_GEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Synthetic Hack assembly generator for benchmarks.
+ *
+ * Produces valid programs of an exact line count, mixing A-instructions (numbers, labels and
+ * variables), C-instructions over every dest/comp/jump mnemonic, label definitions and the
+ * occasional comment or blank line, in the proportions of compiler output such as Pong.asm.
+ * The same options and seed always give the same program.
+ */
+typedef struct {
+    uint64_t lines;            // Lines to write
+    double label_density;      // Fraction of lines that define a label (0..1)
+    double variable_density;   // Fraction of A-instructions that name a variable (0..1)
+    unsigned variables;        // Distinct variable names (at most ASM_GEN_MAX_VARIABLES)
+    uint64_t seed;
+} AsmGenOptions;
+
+#define ASM_GEN_MAX_VARIABLES 16000  // RAM addresses 16.. stay within 15 bits
+
+// Defaults close to compiled Jack code
+#define ASM_GEN_DEFAULTS {.lines = 100000, .label_density = 0.03, .variable_density = 0.02, \
+                          .variables = 64, .seed = 1}
+
+/**
+ * @brief Writes a generated program.
+ *
+ * @param out     Output stream.
+ * @param options Generator settings.
+ * @return true on success, false on invalid options or a write error.
+ */
+bool asm_gen_write(FILE *out, const AsmGenOptions *options);
+
+#endif // ASM_GEN_H
@@ -0,0 +1,179 @@
+#include "bench.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+#endif
+
+static uint64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t now_cycles(void) {
+#ifdef BENCH_HAS_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int compare_u64(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+bool bench_run(const char *name, const char *unit, const size_t items, const BenchFunc run, const BenchFunc reset,
+               void *context, const BenchOptions *options, BenchResult *result) {
+    if (!name || !run || !options || !result || items == 0 || options->repetitions == 0 ||
+        options->repetitions > BENCH_MAX_REPETITIONS) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < options->warmup; i++) {
+        if (reset) reset(context);
+        run(context);
+    }
+
+    uint64_t times[BENCH_MAX_REPETITIONS];
+    uint64_t cycles[BENCH_MAX_REPETITIONS];
+    for (unsigned i = 0; i < options->repetitions; i++) {
+        if (reset) reset(context);
+        const uint64_t start_cycles = now_cycles();
+        const uint64_t start = now_ns();
+        run(context);
+        times[i] = now_ns() - start;
+        cycles[i] = now_cycles() - start_cycles;
+    }
+    const unsigned count = options->repetitions;
+    qsort(times, count, sizeof(uint64_t), compare_u64);
+    qsort(cycles, count, sizeof(uint64_t), compare_u64);
+
+    const double median = (double)times[count / 2];
+    *result = (BenchResult){
+        .name = name,
+        .unit = unit ? unit : "items",
+        .items = items,
+        .repetitions = count,
+        .median_ns = median,
+        .p95_ns = (double)times[(count * 95 + 99) / 100 - 1],
+        .min_ns = (double)times[0],
+        .ns_per_item = median / (double)items,
+        .cycles_per_item = -1.0,
+        .items_per_second = median > 0 ? (double)items * 1e9 / median : 0.0,
+    };
+#ifdef BENCH_HAS_CYCLES
+    result->cycles_per_item = (double)cycles[count / 2] / (double)items;
+#endif
+    return true;
+}
+
+void bench_print(FILE *file, const BenchResult *result) {
+    fprintf(file, "%-28s %12.3f ms median %12.3f ms p95 %10.2f ns/%s", result->name, result->median_ns / 1e6,
+            result->p95_ns / 1e6, result->ns_per_item, result->unit);
+    if (result->cycles_per_item >= 0) fprintf(file, " %9.1f cycles/%s", result->cycles_per_item, result->unit);
+    fprintf(file, " %8.2f M%s/s\n", result->items_per_second / 1e6, result->unit);
+}
+
+void bench_write_json(FILE *file, const char *suite, const BenchResult *results, const size_t count) {
+    fprintf(file, "{\n  \"suite\": \"%s\",\n  \"results\": [\n", suite);
+    for (size_t i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"items\": %zu, \"repetitions\": %u, "
+                      "\"median_ns\": %.0f, \"p95_ns\": %.0f, \"min_ns\": %.0f, \"ns_per_item\": %.3f, ",
+                r->name, r->unit, r->items, r->repetitions, r->median_ns, r->p95_ns, r->min_ns, r->ns_per_item);
+        if (r->cycles_per_item >= 0) {
+            fprintf(file, "\"cycles_per_item\": %.2f, ", r->cycles_per_item);
+        } else {
+            fprintf(file, "\"cycles_per_item\": null, ");
+        }
+        fprintf(file, "\"items_per_second\": %.0f}%s\n", r->items_per_second, i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+// Value following "key": on a result line, or NAN if absent (or null)
+static double json_number(const char *line, const char *key) {
+    const char *found = strstr(line, key);
+    if (!found) return NAN;
+    char *end = NULL;
+    const double value = strtod(found + strlen(key), &end);
+    return end == found + strlen(key) ? NAN : value;
+}
+
+size_t bench_read_json(const char *path, BenchResult *results, char (*names)[BENCH_NAME_MAX], const size_t max) {
+    FILE *file = path ? fopen(path, "r") : NULL;
+    if (!file) return 0;
+
+    char line[1024];
+    size_t count = 0;
+    while (count < max && fgets(line, sizeof(line), file)) {
+        const char *name = strstr(line, "\"name\": \"");
+        if (!name) continue;
+        name += strlen("\"name\": \"");
+        const char *name_end = strchr(name, '"');
+        if (!name_end || name_end - name >= BENCH_NAME_MAX) continue;
+        memcpy(names[count], name, (size_t)(name_end - name));
+        names[count][name_end - name] = '\0';
+
+        BenchResult *result = &results[count];
+        *result = (BenchResult){
+            .name = names[count],
+            .unit = "items",
+            .items = (size_t)json_number(line, "\"items\": "),
+            .repetitions = (unsigned)json_number(line, "\"repetitions\": "),
+            .median_ns = json_number(line, "\"median_ns\": "),
+            .p95_ns = json_number(line, "\"p95_ns\": "),
+            .min_ns = json_number(line, "\"min_ns\": "),
+            .ns_per_item = json_number(line, "\"ns_per_item\": "),
+            .cycles_per_item = -1.0,
+            .items_per_second = json_number(line, "\"items_per_second\": "),
+        };
+        if (result->items == 0 || !(result->min_ns > 0) || !(result->median_ns > 0)) continue;
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+// Relative distance of the median above the fastest run
+static double run_noise(const BenchResult *result) {
+    return (result->median_ns - result->min_ns) / result->median_ns;
+}
+
+size_t bench_compare(FILE *report, const BenchResult *baseline, const size_t baseline_count,
+                     const BenchResult *current, const size_t current_count, const double threshold) {
+    size_t regressions = 0;
+    for (size_t i = 0; i < baseline_count; i++) {
+        const BenchResult *base = &baseline[i];
+        const BenchResult *now = NULL;
+        for (size_t j = 0; j < current_count && !now; j++) {
+            if (strcmp(current[j].name, base->name) == 0) now = &current[j];
+        }
+        if (!now) {
+            fprintf(report, "%-28s missing from this run\n", base->name);
+            continue;
+        }
+
+        const double base_rate = (double)base->items * 1e9 / base->min_ns;
+        const double now_rate = (double)now->items * 1e9 / now->min_ns;
+        const double change = now_rate / base_rate - 1.0;
+        const double allowed = threshold + fmax(run_noise(base), run_noise(now));
+        const bool regressed = change < -allowed;
+        regressions += regressed;
+        fprintf(report, "%-28s %+7.1f%% (allowed -%.1f%%) %s\n", base->name, change * 100.0, allowed * 100.0,
+                regressed ? "REGRESSION" : "ok");
+    }
+    for (size_t j = 0; j < current_count; j++) {
+        bool known = false;
+        for (size_t i = 0; i < baseline_count && !known; i++) known = strcmp(baseline[i].name, current[j].name) == 0;
+        if (!known) fprintf(report, "%-28s not in the baseline\n", current[j].name);
+    }
+    return regressions;
+}
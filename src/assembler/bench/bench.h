@@ -0,0 +1,98 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Minimal microbenchmark harness.
+ *
+ * A benchmark is a function doing 'items' units of work per call. It is run 'warmup' times
+ * unmeasured, then 'repetitions' times measured with the monotonic clock (and the time-stamp
+ * counter where the CPU has one). An optional reset function runs before every call, outside
+ * the measurement, to restore the state the work consumes (e.g. empty a table).
+ */
+typedef void (*BenchFunc)(void *context);
+
+typedef struct {
+    unsigned warmup;        // Unmeasured runs first
+    unsigned repetitions;   // Measured runs (at most BENCH_MAX_REPETITIONS)
+} BenchOptions;
+
+#define BENCH_MAX_REPETITIONS 1000
+
+typedef struct {
+    const char *name;
+    const char *unit;          // What one item is ("lines", "tokens", ...)
+    size_t items;              // Items per repetition
+    unsigned repetitions;
+    double median_ns;          // Per repetition
+    double p95_ns;
+    double min_ns;
+    double ns_per_item;        // From the median
+    double cycles_per_item;    // From the median; negative when no cycle counter is available
+    double items_per_second;   // From the median
+} BenchResult;
+
+/**
+ * @brief Runs one benchmark.
+ *
+ * @param name    Benchmark name (kept by pointer in the result).
+ * @param unit    Name of one item (kept by pointer in the result).
+ * @param items   Items processed by one call of 'run'.
+ * @param run     The measured work.
+ * @param reset   Called before every run, unmeasured (may be NULL).
+ * @param context Passed to 'run' and 'reset'.
+ * @param options Warmup and repetition counts.
+ * @param result  Output statistics.
+ * @return true on success, false on invalid arguments.
+ */
+bool bench_run(const char *name, const char *unit, size_t items, BenchFunc run, BenchFunc reset, void *context,
+               const BenchOptions *options, BenchResult *result);
+
+/**
+ * @brief Prints one result as a human-readable line.
+ */
+void bench_print(FILE *file, const BenchResult *result);
+
+/**
+ * @brief Writes results as one JSON object: {"suite": ..., "results": [{...}, ...]}.
+ *
+ * Every result carries its name, unit, items, repetitions, median/p95/min ns, ns and cycles per
+ * item (null without a cycle counter) and items per second, so runs from different commits can
+ * be compared by name.
+ */
+void bench_write_json(FILE *file, const char *suite, const BenchResult *results, size_t count);
+
+#define BENCH_NAME_MAX 64
+
+/**
+ * @brief Reads results written by bench_write_json() (one result object per line).
+ *
+ * @param path    JSON file.
+ * @param results Output results; their names point into 'names'.
+ * @param names   Storage for the names, one per result.
+ * @param max     Capacity of 'results' and 'names'.
+ * @return Number of results read, or 0 if the file is missing or holds none.
+ */
+size_t bench_read_json(const char *path, BenchResult *results, char (*names)[BENCH_NAME_MAX], size_t max);
+
+/**
+ * @brief Compares results with a baseline and reports throughput regressions.
+ *
+ * Throughput is taken from the fastest repetition (the least disturbed by other load). A
+ * benchmark regresses when it is slower than its baseline by more than 'threshold' plus the
+ * noise of the two runs, where the noise of a run is how far its median lies above its fastest
+ * repetition (relative to the median). Benchmarks missing from either side are reported only.
+ *
+ * @param report    Where to print one line per compared benchmark.
+ * @param baseline  Stored results.
+ * @param current   New results.
+ * @param threshold Allowed relative slowdown beyond the noise (e.g. 0.2 for 20%).
+ * @return Number of regressions.
+ */
+size_t bench_compare(FILE *report, const BenchResult *baseline, size_t baseline_count, const BenchResult *current,
+                     size_t current_count, double threshold);
+
+#endif // BENCH_H
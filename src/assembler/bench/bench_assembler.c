@@ -0,0 +1,476 @@
+/**
+ * @brief Benchmark suite for the Hack assembler (`bench_assembler`).
+ *
+ * Runs microbenchmarks of the hot stages (lex_line, advance, the fused lex_source_instructions,
+ * generate_binary, the symbol table and the token table) on a generated program, then end-to-end assemblies of generated programs
+ * of several sizes and of any sources given with `--source`. A table goes to stderr and the
+ * results to `--json` (standard output by default) in the bench.h JSON format.
+ *
+ * **Usage:**
+ *   bench_assembler [--json out.json] [--sizes 10000,100000,...] [--source file.asm]...
+ *                   [--repetitions N] [--no-micro]
+ *                   [--baseline baseline.json [--threshold fraction] [--update-baseline]]
+ *
+ * With `--baseline` the results are compared with the stored ones (see bench_compare()) and the
+ * exit status is non-zero if any benchmark regressed by more than the threshold (default 0.2)
+ * plus noise, in two runs in a row. `--update-baseline` writes the results as the new baseline.
+ *
+ * `cmake --build build --target bench` runs the full suite and writes build/bench.json.
+ */
+
+#include "asm_gen.h"
+#include "bench.h"
+#include "code_generator.h"
+#include "lexer.h"
+#include "parser.h"
+#include "symbol_table.h"
+#include "token.h"
+#include <assembler.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MICRO_LINES 100000        // Lines of the program the stage benchmarks work on
+#define MICRO_SYMBOLS 100000      // Distinct symbols for the symbol table benchmarks
+#define MICRO_TOKENS 1000000      // Records for the token table benchmarks
+#define MAX_RESULTS 64
+#define MAX_SOURCES 16
+#define DEFAULT_SIZES "10000,100000,1000000,10000000"
+#define DEFAULT_THRESHOLD 0.2      // Allowed slowdown against a baseline, beyond the measured noise
+
+#define USAGE "Usage: %s [--json out.json] [--sizes n,n,...] [--source file.asm]... [--repetitions N] [--no-micro]\n" \
+              "       [--baseline baseline.json [--threshold fraction] [--update-baseline]]\n"
+
+static volatile unsigned sink;    // Keeps measured results alive
+
+typedef struct {
+    // Generated program and its line offsets
+    char *source;
+    size_t source_size;
+    size_t *line_starts;
+    size_t line_count;
+
+    // Tables rebuilt by the resets
+    StringPool *string_pool;
+    SymbolTable *symbol_table;
+    TokenTable *token_table;
+    TokenTable *instruction_table;  // Records of the fused front end
+    Parser *parser;
+    size_t instruction_count;     // advance() calls for the whole program
+
+    // Encodable instructions (numeric A and C) collected from the parse
+    Instruction *instructions;
+    size_t encodable_count;
+
+    // Symbol table inputs
+    StringId *symbol_ids;
+    char (*symbol_names)[16];
+} MicroContext;
+
+static void reset_tables(MicroContext *context) {
+    symbol_table_free(context->symbol_table);
+    string_pool_free(context->string_pool);
+    context->string_pool = string_pool_create();
+    context->symbol_table = symbol_table_create(context->string_pool);
+    token_table_clear(context->token_table);
+    if (!context->string_pool || !context->symbol_table || !load_predefined_symbols(context->symbol_table)) {
+        fprintf(stderr, "Error: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void lex_reset(void *arg) {
+    reset_tables(arg);
+}
+
+static void lex_run(void *arg) {
+    MicroContext *context = arg;
+    int rom_address = 0;
+    for (size_t i = 0; i < context->line_count; i++) {
+        const size_t end = i + 1 < context->line_count ? context->line_starts[i + 1] : context->source_size;
+        if (lex_line(context->source, context->line_starts[i], end - context->line_starts[i], context->token_table,
+                     context->string_pool, context->symbol_table, &rom_address) != PROCESS_SUCCESS) {
+            fprintf(stderr, "Error: generated line %zu does not lex.\n", i + 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+    sink += (unsigned)rom_address;
+}
+
+static void lex_instructions_reset(void *arg) {
+    MicroContext *context = arg;
+    reset_tables(context);
+    token_table_clear(context->instruction_table);
+}
+
+static void lex_instructions_run(void *arg) {
+    MicroContext *context = arg;
+    int rom_address = 0;
+    int line_count = 0;
+    ScannedLine error_line;
+    if (lex_source_instructions(context->source, 0, context->source_size, context->instruction_table,
+                                context->string_pool, context->symbol_table, &rom_address, &line_count,
+                                &error_line) != PROCESS_SUCCESS) {
+        fprintf(stderr, "Error: generated line %d does not lex.\n", line_count);
+        exit(EXIT_FAILURE);
+    }
+    sink += (unsigned)rom_address;
+}
+
+static void advance_run(void *arg) {
+    MicroContext *context = arg;
+    parser_set_range(context->parser, 0, SIZE_MAX);
+    while (parser_has_more_commands(context->parser) && advance(context->parser)) {
+        sink += (unsigned)context->parser->instruction->type;
+    }
+}
+
+static void generate_binary_run(void *arg) {
+    const MicroContext *context = arg;
+    char binary[HACK_LINE_LENGTH + 1];
+    for (size_t i = 0; i < context->encodable_count; i++) {
+        generate_binary(&context->instructions[i], binary);
+        sink += (unsigned)binary[15];
+    }
+}
+
+static void encode_instruction_run(void *arg) {
+    const MicroContext *context = arg;
+    unsigned total = 0;
+    for (size_t i = 0; i < context->encodable_count; i++) total += encode_instruction(&context->instructions[i]);
+    sink += total;
+}
+
+static void symbol_reset(void *arg) {
+    MicroContext *context = arg;
+    symbol_table_free(context->symbol_table);
+    context->symbol_table = symbol_table_create(context->string_pool);
+}
+
+static void symbol_insert_run(void *arg) {
+    MicroContext *context = arg;
+    for (size_t i = 0; i < MICRO_SYMBOLS; i++) {
+        symbol_table_lookup_or_insert_id(context->symbol_table, context->symbol_ids[i], (int)(i & 0x7FFF), NULL);
+    }
+}
+
+static void symbol_lookup_id_run(void *arg) {
+    const MicroContext *context = arg;
+    int total = 0;
+    for (size_t i = 0; i < MICRO_SYMBOLS; i++) {
+        total += symbol_table_get_address_id(context->symbol_table, context->symbol_ids[i]);
+    }
+    sink += (unsigned)total;
+}
+
+static void symbol_lookup_name_run(void *arg) {
+    const MicroContext *context = arg;
+    int total = 0;
+    for (size_t i = 0; i < MICRO_SYMBOLS; i++) {
+        total += symbol_table_get_address(context->symbol_table, context->symbol_names[i]);
+    }
+    sink += (unsigned)total;
+}
+
+static void token_reset(void *arg) {
+    token_table_clear(((MicroContext *)arg)->token_table);
+}
+
+static void token_add_run(void *arg) {
+    MicroContext *context = arg;
+    for (size_t i = 0; i < MICRO_TOKENS; i++) {
+        const Token token = {.type = TOKEN_INTEGER, .value.integer = (int)i};
+        token_table_add(context->token_table, &token);
+    }
+}
+
+static void token_get_run(void *arg) {
+    const MicroContext *context = arg;
+    int total = 0;
+    for (size_t i = 0; i < MICRO_TOKENS; i++) {
+        total += ((const Token *)token_table_get(context->token_table, i))->value.integer;
+    }
+    sink += (unsigned)total;
+}
+
+// Generates the micro program and everything the stage benchmarks start from
+static bool micro_setup(MicroContext *context) {
+    AsmGenOptions options = ASM_GEN_DEFAULTS;
+    options.lines = MICRO_LINES;
+    FILE *out = open_memstream(&context->source, &context->source_size);
+    if (!out || !asm_gen_write(out, &options) || fclose(out) != 0) return false;
+
+    context->line_starts = malloc(MICRO_LINES * sizeof(size_t));
+    context->symbol_ids = malloc(MICRO_SYMBOLS * sizeof(StringId));
+    context->symbol_names = malloc(MICRO_SYMBOLS * sizeof(*context->symbol_names));
+    context->token_table = token_table_create(sizeof(Token), NULL, (TokenToStr)token_to_str);
+    context->instruction_table = token_table_create(sizeof(PackedInstruction), NULL, NULL);
+    if (!context->line_starts || !context->symbol_ids || !context->symbol_names || !context->token_table ||
+        !context->instruction_table) {
+        return false;
+    }
+    for (size_t offset = 0; offset < context->source_size && context->line_count < MICRO_LINES;) {
+        context->line_starts[context->line_count++] = offset;
+        const char *newline = memchr(context->source + offset, '\n', context->source_size - offset);
+        offset = newline ? (size_t)(newline - context->source) + 1 : context->source_size;
+    }
+
+    // Lex and parse once to get the token stream and the instructions
+    reset_tables(context);
+    lex_run(context);
+    context->parser = parser_create(context->token_table, context->symbol_table);
+    context->instructions = malloc(context->line_count * sizeof(Instruction));
+    if (!context->parser || !context->instructions) return false;
+    while (parser_has_more_commands(context->parser) && advance(context->parser)) {
+        const Instruction *instruction = context->parser->instruction;
+        context->instruction_count++;
+        if (instruction->type == A_INSTRUCTION_VALUE || instruction->type == C_INSTRUCTION) {
+            context->instructions[context->encodable_count++] = *instruction;
+        }
+    }
+    return context->instruction_count > 0;
+}
+
+static void micro_free(MicroContext *context) {
+    parser_free(context->parser);
+    token_table_free(context->token_table);
+    token_table_free(context->instruction_table);
+    symbol_table_free(context->symbol_table);
+    string_pool_free(context->string_pool);
+    free(context->source);
+    free(context->line_starts);
+    free(context->instructions);
+    free(context->symbol_ids);
+    free(context->symbol_names);
+}
+
+static size_t run_micro(const BenchOptions *options, BenchResult *results) {
+    MicroContext context = {0};
+    if (!micro_setup(&context)) {
+        fprintf(stderr, "Error: unable to set up the microbenchmarks.\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t count = 0;
+    bench_run("lex_line", "lines", context.line_count, lex_run, lex_reset, &context, options, &results[count++]);
+    bench_run("advance", "instructions", context.instruction_count, advance_run, NULL, &context, options,
+              &results[count++]);
+    bench_run("lex_source_instructions", "lines", context.line_count, lex_instructions_run, lex_instructions_reset,
+              &context, options, &results[count++]);
+    bench_run("generate_binary", "instructions", context.encodable_count, generate_binary_run, NULL, &context,
+              options, &results[count++]);
+    bench_run("encode_instruction", "instructions", context.encodable_count, encode_instruction_run, NULL, &context,
+              options, &results[count++]);
+
+    // Symbol table: a fresh pool of distinct names
+    reset_tables(&context);
+    for (size_t i = 0; i < MICRO_SYMBOLS; i++) {
+        snprintf(context.symbol_names[i], sizeof(context.symbol_names[i]), "sym_%zu", i);
+        context.symbol_ids[i] = string_pool_intern(context.string_pool, context.symbol_names[i],
+                                                   strlen(context.symbol_names[i]));
+    }
+    bench_run("symbol_table_insert", "symbols", MICRO_SYMBOLS, symbol_insert_run, symbol_reset, &context, options,
+              &results[count++]);
+    bench_run("symbol_table_lookup_id", "symbols", MICRO_SYMBOLS, symbol_lookup_id_run, NULL, &context, options,
+              &results[count++]);
+    bench_run("symbol_table_lookup_name", "symbols", MICRO_SYMBOLS, symbol_lookup_name_run, NULL, &context, options,
+              &results[count++]);
+
+    // Token table
+    bench_run("token_table_add", "tokens", MICRO_TOKENS, token_add_run, token_reset, &context, options,
+              &results[count++]);
+    bench_run("token_table_get", "tokens", MICRO_TOKENS, token_get_run, NULL, &context, options, &results[count++]);
+
+    micro_free(&context);
+    return count;
+}
+
+typedef struct {
+    const char *path;
+} AssembleContext;
+
+static void assemble_run(void *arg) {
+    const AssembleContext *context = arg;
+    FILE *source = fopen(context->path, "r");
+    FILE *target = fopen("/dev/null", "w");
+    const AssemblerConfig config = {
+        .source_asm = source,
+        .source_filepath = context->path,
+        .target_hack = target,
+        .target_filepath = "/dev/null",
+        .format = OUTPUT_FORMAT_HACK,
+    };
+    Assembler *assembler = source && target ? assembler_create(&config) : NULL;
+    if (!assembler || assembler_assemble(assembler) != 0) {
+        fprintf(stderr, "Error: unable to assemble '%s'.\n", context->path);
+        exit(EXIT_FAILURE);
+    }
+    assembler_free(assembler);
+    fclose(source);
+    fclose(target);
+}
+
+static size_t count_lines(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return 0;
+    size_t lines = 0;
+    int c;
+    while ((c = getc(file)) != EOF) lines += c == '\n';
+    fclose(file);
+    return lines;
+}
+
+// Times end-to-end assembly of one file; 'name' must stay valid as long as the result
+static bool run_assemble(const char *name, const char *path, const BenchOptions *options, BenchResult *result) {
+    AssembleContext context = {path};
+    const size_t lines = count_lines(path);
+    if (lines == 0) {
+        fprintf(stderr, "Error: '%s' is missing or empty.\n", path);
+        return false;
+    }
+    return bench_run(name, "lines", lines, assemble_run, NULL, &context, options, result);
+}
+
+// What to run, from the command line
+typedef struct {
+    const char *sizes;
+    const char *sources[MAX_SOURCES];
+    size_t source_count;
+    unsigned repetitions;
+    bool micro;
+} SuiteConfig;
+
+// Runs every selected benchmark; 'names' holds the generated names of the end-to-end results
+static size_t run_suite(const SuiteConfig *config, BenchResult *results, char (*names)[BENCH_NAME_MAX]) {
+    size_t count = 0;
+    if (config->micro) {
+        const BenchOptions options = {.warmup = 2, .repetitions = config->repetitions ? config->repetitions : 15};
+        count += run_micro(&options, results);
+        for (size_t i = 0; i < count; i++) bench_print(stderr, &results[i]);
+    }
+
+    // End-to-end: real sources first, then the synthetic corpus
+    for (size_t i = 0; i < config->source_count && count < MAX_RESULTS; i++) {
+        const char *slash = strrchr(config->sources[i], '/');
+        snprintf(names[count], BENCH_NAME_MAX, "assemble_%s", slash ? slash + 1 : config->sources[i]);
+        const BenchOptions options = {.warmup = 2, .repetitions = config->repetitions ? config->repetitions : 15};
+        if (!run_assemble(names[count], config->sources[i], &options, &results[count])) exit(EXIT_FAILURE);
+        bench_print(stderr, &results[count++]);
+    }
+
+    char corpus[] = "/tmp/hackasm_bench_XXXXXX.asm";
+    const int fd = mkstemps(corpus, 4);
+    if (fd < 0) {
+        fprintf(stderr, "Error: unable to create a temporary file.\n");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    for (const char *size = config->sizes; *size && count < MAX_RESULTS;) {
+        char *end = NULL;
+        const unsigned long long lines = strtoull(size, &end, 10);
+        if (end == size || lines == 0) break;
+        size = *end == ',' ? end + 1 : end;
+
+        AsmGenOptions generator = ASM_GEN_DEFAULTS;
+        generator.lines = lines;
+        FILE *out = fopen(corpus, "w");
+        const bool generated = out && asm_gen_write(out, &generator);
+        if (!out || fclose(out) != 0 || !generated) {
+            fprintf(stderr, "Error: unable to write the synthetic corpus.\n");
+            unlink(corpus);
+            exit(EXIT_FAILURE);
+        }
+        snprintf(names[count], BENCH_NAME_MAX, "assemble_synthetic_%llu", lines);
+        const unsigned repetitions = config->repetitions ? config->repetitions : lines >= 5000000 ? 3 : 7;
+        const BenchOptions options = {.warmup = 1, .repetitions = repetitions};
+        if (!run_assemble(names[count], corpus, &options, &results[count])) {
+            unlink(corpus);
+            exit(EXIT_FAILURE);
+        }
+        bench_print(stderr, &results[count++]);
+    }
+    unlink(corpus);
+    return count;
+}
+
+static bool write_results(const char *path, const BenchResult *results, const size_t count) {
+    FILE *json = path ? fopen(path, "w") : stdout;
+    if (!json) {
+        fprintf(stderr, "Error: unable to open '%s' for writing.\n", path);
+        return false;
+    }
+    bench_write_json(json, "hackasm", results, count);
+    return !path || fclose(json) == 0;
+}
+
+int main(const int argc, char *argv[]) {
+    SuiteConfig config = {.sizes = DEFAULT_SIZES, .micro = true};
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    double threshold = DEFAULT_THRESHOLD;
+    bool update_baseline = false;
+
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--json") == 0 && has_value) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--sizes") == 0 && has_value) {
+            config.sizes = argv[++i];
+        } else if (strcmp(argv[i], "--source") == 0 && has_value && config.source_count < MAX_SOURCES) {
+            config.sources[config.source_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--repetitions") == 0 && has_value && atoi(argv[i + 1]) > 0) {
+            config.repetitions = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-micro") == 0) {
+            config.micro = false;
+        } else if (strcmp(argv[i], "--baseline") == 0 && has_value) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && has_value && atof(argv[i + 1]) >= 0) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--update-baseline") == 0) {
+            update_baseline = true;
+        } else {
+            fprintf(stderr, "Error: Unrecognized or incomplete argument '%s'.\n", argv[i]);
+            fprintf(stderr, USAGE, argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (update_baseline && !baseline_path) {
+        fprintf(stderr, "Error: --update-baseline requires --baseline.\n");
+        return EXIT_FAILURE;
+    }
+
+    static BenchResult results[MAX_RESULTS];
+    static char names[MAX_RESULTS][BENCH_NAME_MAX];
+    size_t count = run_suite(&config, results, names);
+    if (json_path || !baseline_path) {
+        if (!write_results(json_path, results, count)) return EXIT_FAILURE;
+    }
+    if (!baseline_path) return EXIT_SUCCESS;
+
+    if (update_baseline) {
+        if (!write_results(baseline_path, results, count)) return EXIT_FAILURE;
+        fprintf(stderr, "Baseline written to %s\n", baseline_path);
+        return EXIT_SUCCESS;
+    }
+
+    static BenchResult baseline[MAX_RESULTS];
+    static char baseline_names[MAX_RESULTS][BENCH_NAME_MAX];
+    const size_t baseline_count = bench_read_json(baseline_path, baseline, baseline_names, MAX_RESULTS);
+    if (baseline_count == 0) {
+        fprintf(stderr, "Error: no baseline in '%s' (create one with --update-baseline).\n", baseline_path);
+        return EXIT_FAILURE;
+    }
+
+    // A regression must show up twice in a row, so a single disturbed run does not fail the check
+    size_t regressions = bench_compare(stderr, baseline, baseline_count, results, count, threshold);
+    if (regressions > 0) {
+        fprintf(stderr, "%zu benchmark(s) slower than the baseline; measuring again\n", regressions);
+        count = run_suite(&config, results, names);
+        regressions = bench_compare(stderr, baseline, baseline_count, results, count, threshold);
+    }
+    if (regressions > 0) {
+        fprintf(stderr, "FAILED: %zu benchmark(s) regressed beyond %.0f%% plus noise\n", regressions,
+                threshold * 100.0);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
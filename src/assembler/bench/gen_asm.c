@@ -0,0 +1,71 @@
+/**
+ * @brief Synthetic Hack assembly generator (`gen_asm`), for benchmarks and stress tests.
+ *
+ * **Usage:**
+ *   gen_asm [-n lines] [--labels fraction] [--variables fraction] [--variable-count N] [--seed S] [-o out.asm]
+ *
+ *   gen_asm -n 10000000 -o big.asm           // 10M lines with the default densities
+ *   gen_asm -n 100000 --labels 0.2 | hackasm - -o out.hack
+ *
+ * Writes to standard output unless `-o` is given. See asm_gen.h for what is generated.
+ */
+
+#include "asm_gen.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define USAGE "Usage: %s [-n lines] [--labels fraction] [--variables fraction] [--variable-count N] " \
+              "[--seed S] [-o out.asm]\n"
+
+static bool parse_number(const char *text, double *value) {
+    char *end = NULL;
+    *value = strtod(text, &end);
+    return *text != '\0' && *end == '\0';
+}
+
+int main(const int argc, char *argv[]) {
+    AsmGenOptions options = ASM_GEN_DEFAULTS;
+    const char *output = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        // Every option takes a value; all but -o take a number
+        double value = 0;
+        const bool is_output = strcmp(argv[i], "-o") == 0;
+        if (i + 1 >= argc || (!is_output && !parse_number(argv[i + 1], &value))) {
+            fprintf(stderr, "Error: %s requires a value.\n", argv[i]);
+            fprintf(stderr, USAGE, argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (is_output) {
+            output = argv[i + 1];
+        } else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--lines") == 0) {
+            options.lines = (uint64_t)value;
+        } else if (strcmp(argv[i], "--labels") == 0) {
+            options.label_density = value;
+        } else if (strcmp(argv[i], "--variables") == 0) {
+            options.variable_density = value;
+        } else if (strcmp(argv[i], "--variable-count") == 0) {
+            options.variables = (unsigned)value;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options.seed = (uint64_t)value;
+        } else {
+            fprintf(stderr, "Error: Unrecognized argument '%s'.\n", argv[i]);
+            fprintf(stderr, USAGE, argv[0]);
+            return EXIT_FAILURE;
+        }
+        i++;
+    }
+
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Unable to open '%s' for writing.\n", output);
+        return EXIT_FAILURE;
+    }
+    const bool written = asm_gen_write(out, &options);
+    if (output && fclose(out) != 0) return EXIT_FAILURE;
+    if (!written) {
+        fprintf(stderr, "Error: Invalid generator options or write failure.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
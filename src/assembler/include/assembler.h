@@ -1,15 +1,57 @@
 #ifndef ASSEMBLER_H
 #define ASSEMBLER_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
+// Bump whenever the output for a given source may change (build cache entries are keyed by it)
+#define ASSEMBLER_VERSION "1.1"
+
+/**
+ * @brief Output encodings supported by the assembler.
+ */
+typedef enum {
+    OUTPUT_FORMAT_HACK, // Textual .hack: one 16-character binary word per line
+    OUTPUT_FORMAT_BIN,  // Packed ROM image: header followed by little-endian 16-bit words
+} OutputFormat;
+
 typedef struct {
     FILE *source_asm;
     const char *source_filepath;
     FILE *target_hack;
     const char *target_filepath;
     FILE *token_output;
+    OutputFormat format;
+    unsigned jobs;  // Worker threads for large sources (0 = one per CPU, 1 = sequential)
+    bool streaming; // Single pass over source_asm in bounded memory (pipes allowed; 'jobs' is ignored)
 } AssemblerConfig;
 
+/*
+ * Packed ROM image layout (OUTPUT_FORMAT_BIN), all fields little-endian:
+ *
+ *   offset  size  field
+ *   0       4     magic        "HROM"
+ *   4       2     version      HACK_ROM_VERSION
+ *   6       2     header_size  HACK_ROM_HEADER_SIZE
+ *   8       4     word_count   number of 16-bit words that follow the header
+ *   12      4     checksum     Fletcher-32 over the words (see assembler_rom_checksum)
+ *   16      2*n   words
+ *
+ * The header is 16 bytes so the word array stays aligned when the image is mmapped.
+ */
+#define HACK_ROM_MAGIC "HROM"
+#define HACK_ROM_VERSION 1
+#define HACK_ROM_HEADER_SIZE 16
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t word_count;
+    uint32_t checksum;
+} HackRomHeader;
+
 // Forward declaration of the opaque Assembler type
 typedef struct Assembler Assembler;
 
@@ -20,6 +62,19 @@ typedef struct Assembler Assembler;
  */
 Assembler *assembler_create(const AssemblerConfig *config);
 
+/**
+ * @brief Prepare an instance for another run with a new configuration.
+ *
+ * Drops the tokens, labels and variables of the previous run but keeps the predefined
+ * symbols and every allocated table, so a warm instance assembles the next source
+ * without re-creating its tables or reloading the predefined symbols.
+ *
+ * @param assembler Assembler instance.
+ * @param config Pointer to the new configuration (caller-owned).
+ * @return true on success, false if the configuration is invalid or a table could not be reset.
+ */
+bool assembler_reset(Assembler *assembler, const AssemblerConfig *config);
+
 /**
  * @brief Runs the assembly process.
  * @param assembler Assembler instance.
@@ -33,4 +88,32 @@ int assembler_assemble(Assembler *assembler);
  */
 void assembler_free(Assembler *assembler);
 
+/**
+ * @brief Compute the Fletcher-32 checksum of a packed ROM word array.
+ * @param words Little-endian 16-bit words (as stored in the image, any alignment).
+ * @param word_count Number of words.
+ * @return Checksum as stored in the image header.
+ */
+uint32_t assembler_rom_checksum(const uint8_t *words, size_t word_count);
+
+/**
+ * @brief Fill in the header of a packed ROM image whose words already follow it.
+ * @param image Start of the image (HACK_ROM_HEADER_SIZE bytes reserved up front).
+ * @param size Total size of the image in bytes.
+ */
+void assembler_rom_finalize(uint8_t *image, size_t size);
+
+/**
+ * @brief Validate a packed ROM image and decode its header.
+ *
+ * Checks the magic, version, header size, that the image holds exactly word_count words, and the checksum.
+ * On success the words start at image + header->header_size.
+ *
+ * @param image Start of the image (e.g. an mmapped .bin file).
+ * @param size Size of the image in bytes.
+ * @param header Output: decoded header (host byte order).
+ * @return true if the image is valid, false otherwise.
+ */
+bool assembler_rom_validate(const uint8_t *image, size_t size, HackRomHeader *header);
+
 #endif // ASSEMBLER_H
@@ -1,161 +1,310 @@
 #include "assembler.h"
 #include "lexer.h"
-#include "parser.h"
+#include "parallel.h"
+#include "stream.h"
 #include "symbol_table.h"
 #include "code_generator.h"
-#include "token.h"
+#include "token_dump.h"
+#include <arena.h>
 #include <logger.h>
+#include <output_buffer.h>
+#include <source_buffer.h>
+#include <stats.h>
+#include <string_pool.h>
 #include <token_table.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define ASSEMBLER_ARENA_CHUNK ((size_t)2 << 20)  // First instruction arena chunk (one huge page)
 
 // Internal full definition of Assembler
 struct Assembler {
     AssemblerConfig config;
-    TokenTable *token_table;
+    SourceBuffer *source;
+    Arena *arena;               // Instruction storage; released in one pass over its chunks
+    StringPool *string_pool;
+    TokenTable *instructions;   // PackedInstruction records of the first pass
     SymbolTable *symbol_table;
-    Parser *parser;
+    size_t predefined_strings;  // Pool size right after the predefined symbols were loaded
 };
 
-Assembler *assembler_create(const AssemblerConfig *config) {
-    if (!config) return NULL;
+static void put_u16(uint8_t *dst, const uint16_t value) {
+    dst[0] = (uint8_t)(value & 0xFF);
+    dst[1] = (uint8_t)(value >> 8);
+}
 
-    // Validate required fields (file pointers and file paths)
-    if (!config->source_asm || !config->target_hack ||
-        !config->source_filepath || !config->target_filepath) {
-        return NULL;
+static void put_u32(uint8_t *dst, const uint32_t value) {
+    put_u16(dst, (uint16_t)(value & 0xFFFF));
+    put_u16(dst + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *src) {
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *src) {
+    return (uint32_t)get_u16(src) | ((uint32_t)get_u16(src + 2) << 16);
+}
+
+// Slot writers for the second pass: one text line, or one little-endian word
+static void write_hack_line(const uint16_t word, char *destination) {
+    word_to_ascii(word, destination);
+    destination[HACK_LINE_LENGTH - 1] = '\n';
+}
+
+static void write_rom_word(const uint16_t word, char *destination) {
+    put_u16((uint8_t *)destination, word);
+}
+
+void assembler_rom_finalize(uint8_t *image, const size_t size) {
+    const size_t word_count = (size - HACK_ROM_HEADER_SIZE) / sizeof(uint16_t);
+    memcpy(image, HACK_ROM_MAGIC, 4);
+    put_u16(image + 4, HACK_ROM_VERSION);
+    put_u16(image + 6, HACK_ROM_HEADER_SIZE);
+    put_u32(image + 8, (uint32_t)word_count);
+    put_u32(image + 12, assembler_rom_checksum(image + HACK_ROM_HEADER_SIZE, word_count));
+}
+
+uint32_t assembler_rom_checksum(const uint8_t *words, size_t word_count) {
+    uint32_t sum1 = 0xFFFF;
+    uint32_t sum2 = 0xFFFF;
+
+    // 359 words is the longest run before sum2 can overflow 32 bits, so the modulo is deferred per block
+    while (word_count > 0) {
+        const size_t block = word_count < 359 ? word_count : 359;
+        word_count -= block;
+        for (size_t i = 0; i < block; i++, words += 2) {
+            sum1 += get_u16(words);
+            sum2 += sum1;
+        }
+        sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+        sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
     }
+    sum1 = (sum1 & 0xFFFF) + (sum1 >> 16);
+    sum2 = (sum2 & 0xFFFF) + (sum2 >> 16);
+    return (sum2 << 16) | sum1;
+}
 
-    Assembler *assembler = calloc(1, sizeof(Assembler));
-    if (!assembler) return NULL;
+bool assembler_rom_validate(const uint8_t *image, const size_t size, HackRomHeader *header) {
+    if (!image || !header || size < HACK_ROM_HEADER_SIZE) return false;
+
+    memcpy(header->magic, image, 4);
+    header->version = get_u16(image + 4);
+    header->header_size = get_u16(image + 6);
+    header->word_count = get_u32(image + 8);
+    header->checksum = get_u32(image + 12);
+
+    if (memcmp(header->magic, HACK_ROM_MAGIC, 4) != 0) return false;
+    if (header->version != HACK_ROM_VERSION || header->header_size != HACK_ROM_HEADER_SIZE) return false;
+    if ((size - HACK_ROM_HEADER_SIZE) / sizeof(uint16_t) != header->word_count ||
+        (size - HACK_ROM_HEADER_SIZE) % sizeof(uint16_t) != 0) {
+        return false;
+    }
+    return assembler_rom_checksum(image + HACK_ROM_HEADER_SIZE, header->word_count) == header->checksum;
+}
 
+// Validate required fields (file pointers and file paths)
+static bool is_valid_config(const AssemblerConfig *config) {
+    return config && config->source_asm && config->target_hack &&
+           config->source_filepath && config->target_filepath;
+}
+
+static void apply_config(Assembler *assembler, const AssemblerConfig *config) {
     assembler->config.source_asm = config->source_asm;
     assembler->config.source_filepath = config->source_filepath;
     assembler->config.target_hack = config->target_hack;
     assembler->config.target_filepath = config->target_filepath;
     assembler->config.token_output = config->token_output;
+    assembler->config.format = config->format;
+    assembler->config.jobs = config->jobs;
+    assembler->config.streaming = config->streaming;
+}
 
-    // Create TokenTable
-    assembler->token_table = token_table_create((TokenFreeFunc)free_token, (TokenToStr)token_to_str);
-    if (!assembler->token_table) {
+Assembler *assembler_create(const AssemblerConfig *config) {
+    if (!is_valid_config(config)) return NULL;
+
+    Assembler *assembler = calloc(1, sizeof(Assembler));
+    if (!assembler) return NULL;
+    apply_config(assembler, config);
+
+    // Create StringPool shared by the instructions and the symbol table
+    assembler->string_pool = string_pool_create();
+    if (!assembler->string_pool) {
         free(assembler);
         return NULL;
     }
 
-    // Create SymbolTable
-    assembler->symbol_table = symbol_table_create();
-    if (!assembler->symbol_table) {
-        token_table_free(assembler->token_table);
+    // Create the instruction table, its chunks carved from an arena on (where available) huge pages
+    assembler->arena = arena_create(ASSEMBLER_ARENA_CHUNK, ARENA_HUGE_PAGES);
+    assembler->instructions = assembler->arena ? token_table_create_arena(assembler->arena,
+                                                                          sizeof(PackedInstruction), NULL, NULL)
+                                               : NULL;
+    if (!assembler->instructions) {
+        arena_free(assembler->arena);
+        string_pool_free(assembler->string_pool);
         free(assembler);
         return NULL;
     }
 
-    // Load predefined symbols into symbol table
-    if (!load_predefined_symbols(assembler->symbol_table)) {
-        token_table_free(assembler->token_table);
-        symbol_table_free(assembler->symbol_table);
+    // Create SymbolTable
+    assembler->symbol_table = symbol_table_create(assembler->string_pool);
+    if (!assembler->symbol_table) {
+        token_table_free(assembler->instructions);
+        arena_free(assembler->arena);
+        string_pool_free(assembler->string_pool);
         free(assembler);
         return NULL;
     }
 
-    // Create Parser:
-    assembler->parser = parser_create(assembler->token_table, assembler->symbol_table);
-    if (!assembler->parser) {
-        token_table_free(assembler->token_table);
+    // Load predefined symbols into symbol table
+    if (!load_predefined_symbols(assembler->symbol_table)) {
+        token_table_free(assembler->instructions);
+        arena_free(assembler->arena);
         symbol_table_free(assembler->symbol_table);
+        string_pool_free(assembler->string_pool);
         free(assembler);
         return NULL;
     }
+    assembler->predefined_strings = string_pool_count(assembler->string_pool);
 
     return assembler;
 }
 
+bool assembler_reset(Assembler *assembler, const AssemblerConfig *config) {
+    if (!assembler || !is_valid_config(config)) return false;
+
+    // Forget everything the last run added; the predefined symbols were interned first, so they survive
+    if (!symbol_table_truncate(assembler->symbol_table, (StringId)assembler->predefined_strings)) return false;
+    string_pool_truncate(assembler->string_pool, assembler->predefined_strings);
+    token_table_clear(assembler->instructions);
+    source_buffer_free(assembler->source);
+    assembler->source = NULL;
+
+    apply_config(assembler, config);
+    return true;
+}
+
 void assembler_free(Assembler *assembler) {
     if (!assembler) return;
 
-    // Free the parser if it was created
-    if (assembler->parser) {
-        parser_free(assembler->parser);
-    }
-
-    // Free the token table
-    if (assembler->token_table) {
-        token_table_free(assembler->token_table);
+    // Free the instruction table, then the arena holding its records
+    if (assembler->instructions) {
+        token_table_free(assembler->instructions);
     }
+    arena_free(assembler->arena);
 
     // Free the symbol table
     if (assembler->symbol_table) {
         symbol_table_free(assembler->symbol_table);
     }
 
+    // Free the interned strings
+    string_pool_free(assembler->string_pool);
+
+    // Unmap the source
+    source_buffer_free(assembler->source);
+
     // Finally, free the assembler struct itself
     free(assembler);
 }
 
+// Writes the token stream of the first pass for -t (before pass 2 resolves symbol records in place)
+static bool write_token_dump(const Assembler *assembler) {
+    TokenDump *dump = token_dump_create(assembler->config.token_output);
+    const bool dumped = dump && token_dump_write_instructions(dump, assembler->instructions, assembler->string_pool);
+    if (!token_dump_close(dump) || !dumped) {
+        GLOG(LOG_ERROR, "%s: failed to write token dump.", assembler->config.source_filepath);
+        return false;
+    }
+    return true;
+}
+
 int assembler_assemble(Assembler *assembler) {
     if (!assembler) return 1;
 
+    if (assembler->config.streaming) {
+        const int stream_status = stream_assemble(&assembler->config, assembler->instructions,
+                                                  assembler->string_pool, assembler->symbol_table);
+        STATS_COUNT("symbols", symbol_table_count(assembler->symbol_table) - assembler->predefined_strings);
+        return stream_status;
+    }
+
     int return_status = 0;
 
-    // First Pass - Tokenize lines and populate symbol table with labels
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
+    // Map (or read) the whole source once
+    source_buffer_free(assembler->source);
+    STATS_BEGIN(read_mark);
+    assembler->source = source_buffer_create(assembler->config.source_asm);
+    STATS_END("read", read_mark);
+    if (!assembler->source) {
+        GLOG(LOG_ERROR, "%s: unable to read source file.", assembler->config.source_filepath);
+        return 1;
+    }
+    const char *source = assembler->source->data;
+    const size_t source_size = assembler->source->size;
+
+    // First Pass - Lex and parse lines in place into instructions and populate symbol table with labels
     int rom_address = 0;
-    int line_num = 1;
-    while ((read = getline(&line, &len, assembler->config.source_asm)) != -1) {
-        const ProcessStatus status = lex_line(line, read, assembler->token_table,
-                                        assembler->symbol_table, &rom_address);
-        if (status != PROCESS_SUCCESS) {
-            if (status == PROCESS_INVALID) {
-                GLOG(LOG_ERROR, "%s:%d: syntax error: unable to process line - %s",
-                     assembler->config.source_filepath, line_num, line);
-            } else if (status == PROCESS_ERROR) {
-                GLOG(LOG_ERROR, "%s:%d: internal error (memory/system failure) while processing line.",
-                     assembler->config.source_filepath, line_num);
-            }
-            free(line);
-            return_status = 1;
-            goto end;
+    int line_num = 0;
+    ScannedLine error_line;
+    STATS_BEGIN(lex_mark);
+    const ProcessStatus status = parallel_lex_source(source, source_size, assembler->config.jobs,
+                                                     assembler->instructions, assembler->string_pool,
+                                                     assembler->symbol_table, &rom_address, &line_num, &error_line);
+    STATS_END("lex", lex_mark);
+    STATS_COUNT("lines", (uint64_t)line_num);
+    STATS_COUNT("bytes", source_size);
+    if (assembler->config.token_output && !write_token_dump(assembler)) return_status = 1;
+    if (status != PROCESS_SUCCESS) {
+        if (status == PROCESS_INVALID) {
+            GLOG(LOG_ERROR, "%s:%d: syntax error: unable to process line - %.*s",
+                 assembler->config.source_filepath, line_num, (int)(error_line.end - error_line.start),
+                 source + error_line.start);
+        } else if (status == PROCESS_ERROR) {
+            GLOG(LOG_ERROR, "%s:%d: internal error (memory/system failure) while processing line.",
+                 assembler->config.source_filepath, line_num);
         }
-        line_num++;
+        return 1;
+    }
+    // Second Pass - Every instruction has a fixed-size slot, so encode straight into one preallocated image
+    const bool packed = assembler->config.format == OUTPUT_FORMAT_BIN;
+    const size_t header_size = packed ? HACK_ROM_HEADER_SIZE : 0;
+    const size_t stride = packed ? sizeof(uint16_t) : HACK_LINE_LENGTH;
+    const size_t image_size = header_size + (size_t)rom_address * stride;
+    OutputBuffer *output = output_buffer_create(image_size);
+    char *image = output ? output_buffer_claim(output, image_size) : NULL;
+    if (!image) {
+        GLOG(LOG_ERROR, "%s: unable to allocate output buffer.", assembler->config.target_filepath);
+        output_buffer_free(output);
+        return 1;
     }
-    free(line);
-    token_table_reset(assembler->token_table);
 
-    // Second Pass - Code Generation
     int ram_address = 16;
-    while (parser_has_more_commands(assembler->parser)) {
-        if (!advance(assembler->parser)) break;
-        if (assembler->parser->instruction->type == L_INSTRUCTION) continue;
-        if (assembler->parser->instruction->type == A_INSTRUCTION_SYMBOL) {
-            const char *symbol = assembler->parser->instruction->symbol;
-            if (!symbol_table_contains(assembler->symbol_table, symbol)) {
-                if (!symbol_table_add(assembler->symbol_table, symbol, ram_address++)) {
-                    GLOG(LOG_ERROR, assembler->config.source_filepath, line_num,
-                        "Failed to add symbol '%s' to symbol table.", symbol);
-                    return_status = 1;
-                    goto end;
-                }
-            }
-            assembler->parser->instruction->value =
-                symbol_table_get_address(assembler->symbol_table, symbol);
-            assembler->parser->instruction->type = A_INSTRUCTION_VALUE;
-        }
-
-        // Generate binary instruction
-        char binary_instruction[17] = {0};
-        generate_binary(assembler->parser->instruction, binary_instruction);
-
-        // Write to the .hack output file
-        fprintf(assembler->config.target_hack, "%s\n", binary_instruction);
+    size_t encoded = 0;
+    const ProcessStatus encode_status = parallel_encode(assembler->instructions, assembler->symbol_table,
+                                                        assembler->config.jobs, &ram_address, image + header_size,
+                                                        stride, (size_t)rom_address,
+                                                        packed ? write_rom_word : write_hack_line, &encoded);
+    if (encode_status != PROCESS_SUCCESS) {
+        GLOG(LOG_ERROR, "%s: %s during code generation.", assembler->config.source_filepath,
+             encode_status == PROCESS_INVALID ? "malformed instruction" : "internal error (memory/system failure)");
+        return_status = 1;
     }
+    output->size = header_size + encoded * stride;  // Only the slots actually written
+    STATS_COUNT("instructions", token_table_size(assembler->instructions));
+    STATS_COUNT("symbols", symbol_table_count(assembler->symbol_table) - assembler->predefined_strings);
+    STATS_COUNT("variables", (uint64_t)(ram_address - 16));
+
+    if (packed) assembler_rom_finalize((uint8_t *)output->data, output->size);
 
-    end:
-    if (assembler->config.token_output) {
-        token_table_write_to_file(assembler->config.token_output, assembler->token_table);
+    // Hand the whole .hack image to the kernel in a single write
+    STATS_BEGIN(write_mark);
+    if (!output_buffer_flush(output, assembler->config.target_hack)) {
+        GLOG(LOG_ERROR, "%s: failed to write output file.", assembler->config.target_filepath);
+        return_status = 1;
     }
+    STATS_END("write", write_mark);
+    output_buffer_free(output);
     return return_status;  // 0 on success, 1 on failure
 }
@@ -0,0 +1,223 @@
+#include "batch.h"
+#include <limits.h>
+#include <logger.h>
+#include <thread_pool.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define BATCH_LOG_SIZE 16384    // Memory log kept per file (the latest output if a file logs more)
+
+// One file of the batch
+typedef struct {
+    const FileEntry *entry;
+    char target[PATH_MAX];
+    Logger *logger;         // In-memory log of this file
+    int status;             // 0 on success
+    bool cached;            // Output taken from the build cache
+    bool done;
+} BatchJob;
+
+// State shared by the workers and the reporting thread
+typedef struct {
+    BatchJob *jobs;
+    size_t count;
+    size_t next;            // Next job to claim
+    const BatchOptions *options;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+} Batch;
+
+// Writes the output path of 'entry' into 'target' (of PATH_MAX bytes), in 'dir' if given, else in the
+// output directory or next to the source
+static bool format_target_path(char *target, const FileEntry *entry, const char *dir, const BatchOptions *options) {
+    if (!dir) dir = options->output_dir ? options->output_dir : entry->source;
+    const size_t dir_length = strlen(dir);
+    const bool needs_slash = dir_length > 0 && dir[dir_length - 1] != '/';
+    const char *extension = options->format == OUTPUT_FORMAT_BIN ? ".bin" : ".hack";
+    const int length = snprintf(target, PATH_MAX, "%s%s%s%s", dir, needs_slash ? "/" : "", entry->base_name,
+                                extension);
+    return length > 0 && length < PATH_MAX;
+}
+
+static bool build_target_path(BatchJob *job, const BatchOptions *options) {
+    return format_target_path(job->target, job->entry, NULL, options);
+}
+
+// Output path of one list entry, for finding clashes
+typedef struct {
+    char *path;
+    size_t index;
+} BatchTarget;
+
+static int compare_targets(const void *a, const void *b) {
+    const BatchTarget *left = a, *right = b;
+    const int order = strcmp(left->path, right->path);
+    if (order != 0) return order;
+    return left->index < right->index ? -1 : left->index > right->index;
+}
+
+int batch_find_target_clash(const FileList *list, const BatchOptions *options, size_t clash[2]) {
+    if (!list || !options || !clash) return -1;
+    BatchTarget *targets = calloc(list->count ? list->count : 1, sizeof(BatchTarget));
+    if (!targets) return -1;
+
+    // Resolve each output directory, so different spellings of one directory compare equal
+    int found = 0;
+    size_t count = 0;
+    char dir[PATH_MAX], target[PATH_MAX];
+    for (; count < list->count; count++) {
+        const FileEntry *entry = &list->files[count];
+        const char *output_dir = options->output_dir ? options->output_dir : entry->source;
+        if (!format_target_path(target, entry, realpath(output_dir, dir) ? dir : output_dir, options)) break;
+        targets[count] = (BatchTarget){strdup(target), count};
+        if (!targets[count].path) break;
+    }
+    if (count < list->count) {
+        found = -1;
+    } else {
+        qsort(targets, count, sizeof(BatchTarget), compare_targets);
+        for (size_t i = 1; i < count && !found; i++) {
+            if (strcmp(targets[i - 1].path, targets[i].path) != 0) continue;
+            clash[0] = targets[i - 1].index;
+            clash[1] = targets[i].index;
+            found = 1;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) free(targets[i].path);
+    free(targets);
+    return found;
+}
+
+// Assembles one file with the job's logger installed for this thread
+static int run_job(BatchJob *job, const BatchOptions *options) {
+    const char *source_file = job->entry->full_path;
+    if (!build_target_path(job, options)) {
+        GLOG(LOG_ERROR, "%s: output path too long.", source_file);
+        return 1;
+    }
+
+    char key[BUILD_CACHE_KEY_LENGTH + 1];
+    const bool keyed = options->cache && build_cache_key(source_file, options->format, key);
+    if (keyed && build_cache_fetch(options->cache, key, options->format, job->target)) {
+        job->cached = true;
+        return 0;
+    }
+    build_cache_detach(job->target);
+
+    FILE *source = fopen(source_file, "r");
+    if (!source) {
+        GLOG(LOG_ERROR, "Failed to open source file '%s': %s", source_file, strerror(errno));
+        return 1;
+    }
+    FILE *target = fopen(job->target, options->format == OUTPUT_FORMAT_BIN ? "wb" : "w");
+    if (!target) {
+        GLOG(LOG_ERROR, "Failed to open target file '%s': %s", job->target, strerror(errno));
+        fclose(source);
+        return 1;
+    }
+
+    // Files already run concurrently, so each one is assembled on a single thread
+    const AssemblerConfig config = {
+        .source_asm = source,
+        .source_filepath = source_file,
+        .target_hack = target,
+        .target_filepath = job->target,
+        .format = options->format,
+        .jobs = 1,
+    };
+    int status = 1;
+    Assembler *assembler = assembler_create(&config);
+    if (assembler) {
+        status = assembler_assemble(assembler);
+        assembler_free(assembler);
+    } else {
+        GLOG(LOG_ERROR, "Failed to initialise assembler.");
+    }
+    fclose(source);
+    if (fclose(target) != 0) status = 1;
+    if (keyed && status == 0) build_cache_store(options->cache, key, options->format, job->target);
+    return status;
+}
+
+// Pool task: claims and assembles files until none are left
+static void batch_worker(void *arg) {
+    Batch *batch = arg;
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        const size_t index = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (index >= batch->count) return;
+
+        BatchJob *job = &batch->jobs[index];
+        job->logger = logger_create_memory(BATCH_LOG_SIZE, LOG_INFO, batch->options->use_colors);
+        logger_set_thread(job->logger);
+        job->status = run_job(job, batch->options);
+        logger_set_thread(NULL);
+
+        pthread_mutex_lock(&batch->lock);
+        job->done = true;
+        pthread_cond_broadcast(&batch->finished);
+        pthread_mutex_unlock(&batch->lock);
+    }
+}
+
+size_t assemble_batch(const FileList *list, const BatchOptions *options) {
+    if (!list || !options || list->count == 0) return 0;
+
+    Batch batch = {
+        .jobs = calloc(list->count, sizeof(BatchJob)),
+        .count = list->count,
+        .options = options,
+    };
+    if (!batch.jobs) {
+        fprintf(stderr, "Error: out of memory.\n");
+        return list->count;
+    }
+    for (size_t i = 0; i < list->count; i++) batch.jobs[i].entry = &list->files[i];
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.finished, NULL);
+
+    // Bound the concurrent jobs by the pool size, the file count and the descriptor budget
+    ThreadPool *pool = thread_pool_get_global();
+    size_t workers = options->jobs;
+    if (workers == 0) workers = pool ? thread_pool_size(pool) : 1;
+    if (workers > list->count) workers = list->count;
+    if (workers > BATCH_MAX_OPEN_FILES / 2) workers = BATCH_MAX_OPEN_FILES / 2;
+
+    TaskGroup *group = pool ? task_group_create(pool) : NULL;
+    size_t started = 0;
+    while (group && started < workers && task_group_submit(group, batch_worker, &batch)) started++;
+    if (started == 0) batch_worker(&batch);  // No pool available: do the work here
+
+    // Report in list order, each file as soon as it and all earlier files are done
+    size_t failed = 0;
+    for (size_t i = 0; i < batch.count; i++) {
+        BatchJob *job = &batch.jobs[i];
+        pthread_mutex_lock(&batch.lock);
+        while (!job->done) pthread_cond_wait(&batch.finished, &batch.lock);
+        pthread_mutex_unlock(&batch.lock);
+
+        if (job->status == 0) {
+            printf("%s%s -> %s\n", job->cached ? "cached  " : "ok      ", job->entry->full_path, job->target);
+        } else {
+            failed++;
+            printf("FAILED  %s\n", job->entry->full_path);
+            fflush(stdout);
+            logger_dump(job->logger, stderr);
+        }
+        logger_free(job->logger);
+        job->logger = NULL;
+    }
+
+    task_group_join(group);
+    pthread_cond_destroy(&batch.finished);
+    pthread_mutex_destroy(&batch.lock);
+    free(batch.jobs);
+
+    printf("%zu file(s) assembled, %zu failed\n", batch.count - failed, failed);
+    return failed;
+}
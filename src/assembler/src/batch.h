@@ -0,0 +1,50 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "cache.h"
+#include <assembler.h>
+#include <file_list.h>
+#include <stdbool.h>
+
+// Each running job holds a source and a target descriptor, so this caps concurrent jobs at half of it
+#define BATCH_MAX_OPEN_FILES 64
+
+typedef struct {
+    const char *output_dir;  // Directory for outputs, or NULL to write next to each source
+    OutputFormat format;     // Output encoding for every file
+    unsigned jobs;           // Files assembled concurrently (0 = one per pool worker)
+    bool use_colors;         // Color the per-file error logs
+    BuildCache *cache;       // Outputs of unchanged sources are taken from here (NULL = always assemble)
+} BatchOptions;
+
+/**
+ * @brief Finds two files of a list that would be written to the same output file.
+ *
+ * With an output directory the output name is only the source's base name, so d1/Main.asm and
+ * d2/Main.asm clash; assemble_batch would then write both to one file. Output directories are
+ * resolved first, so differently spelled paths to one directory are recognised.
+ *
+ * @param list Files to assemble.
+ * @param options Batch options (output_dir and format decide the output paths).
+ * @param clash Output: list indices of the first clashing pair, in list order.
+ * @return 1 if a clash was found, 0 if every file has an output of its own, -1 on failure.
+ */
+int batch_find_target_clash(const FileList *list, const BatchOptions *options, size_t clash[2]);
+
+/**
+ * @brief Assembles every file of a list, several at a time.
+ *
+ * Files are claimed by a fixed number of tasks on the global thread pool (at most
+ * BATCH_MAX_OPEN_FILES / 2, so open descriptors stay bounded); without a pool they are
+ * assembled on the calling thread. Each file is assembled sequentially with its own in-memory
+ * logger installed as the worker's thread logger. Results are reported on stdout in list order
+ * as soon as every earlier file has finished, with the log of each failed file on stderr.
+ * With a build cache, files whose output is cached are reported as "cached" instead.
+ *
+ * @param list Files to assemble (typically sorted for deterministic output).
+ * @param options Batch options.
+ * @return Number of files that failed.
+ */
+size_t assemble_batch(const FileList *list, const BatchOptions *options);
+
+#endif // BATCH_H
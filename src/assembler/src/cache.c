@@ -0,0 +1,271 @@
+#include "cache.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <source_buffer.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COPY_CHUNK_SIZE 65536
+
+struct BuildCache {
+    char dir[PATH_MAX];
+    uint64_t max_size;
+    atomic_bool stored;        // Something was added since opening, so the limit must be checked
+};
+
+// One cache file seen while trimming
+typedef struct {
+    char name[NAME_MAX + 1];
+    uint64_t size;
+    struct timespec used;
+} CacheEntry;
+
+static const uint64_t PRIME1 = 11400714785074694791ULL;
+static const uint64_t PRIME2 = 14029467366897019727ULL;
+static const uint64_t PRIME3 = 1609587929392839161ULL;
+static const uint64_t PRIME4 = 9650029242287828579ULL;
+static const uint64_t PRIME5 = 2870177450012600261ULL;
+
+static uint64_t rotl(const uint64_t value, const int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t hash_round(uint64_t acc, const uint64_t input) {
+    acc += input * PRIME2;
+    return rotl(acc, 31) * PRIME1;
+}
+
+static uint64_t hash_merge(uint64_t acc, const uint64_t lane) {
+    acc ^= hash_round(0, lane);
+    return acc * PRIME1 + PRIME4;
+}
+
+uint64_t build_cache_hash(const void *data, const size_t size, const uint64_t seed) {
+    const unsigned char *p = data;
+    const unsigned char *end = p + size;
+    uint64_t hash;
+
+    // Four independent lanes over 32-byte stripes
+    if (size >= 32) {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        do {
+            v1 = hash_round(v1, read64(p));
+            v2 = hash_round(v2, read64(p + 8));
+            v3 = hash_round(v3, read64(p + 16));
+            v4 = hash_round(v4, read64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = hash_merge(hash, v1);
+        hash = hash_merge(hash, v2);
+        hash = hash_merge(hash, v3);
+        hash = hash_merge(hash, v4);
+    } else {
+        hash = seed + PRIME5;
+    }
+    hash += (uint64_t)size;
+
+    for (; end - p >= 8; p += 8) {
+        hash ^= hash_round(0, read64(p));
+        hash = rotl(hash, 27) * PRIME1 + PRIME4;
+    }
+    if (end - p >= 4) {
+        hash ^= (uint64_t)read32(p) * PRIME1;
+        hash = rotl(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= *p * PRIME5;
+        hash = rotl(hash, 11) * PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+BuildCache *build_cache_open(const char *dir, const uint64_t max_size) {
+    if (!dir || strlen(dir) >= PATH_MAX - NAME_MAX - 2) return NULL;
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return NULL;
+    struct stat info;
+    if (stat(dir, &info) != 0 || !S_ISDIR(info.st_mode) || access(dir, W_OK) != 0) return NULL;
+
+    BuildCache *cache = calloc(1, sizeof(BuildCache));
+    if (!cache) return NULL;
+    strcpy(cache->dir, dir);
+    cache->max_size = max_size ? max_size : BUILD_CACHE_DEFAULT_SIZE;
+    atomic_init(&cache->stored, false);
+    return cache;
+}
+
+static int compare_by_use(const void *a, const void *b) {
+    const CacheEntry *left = a;
+    const CacheEntry *right = b;
+    if (left->used.tv_sec != right->used.tv_sec) return left->used.tv_sec < right->used.tv_sec ? -1 : 1;
+    if (left->used.tv_nsec != right->used.tv_nsec) return left->used.tv_nsec < right->used.tv_nsec ? -1 : 1;
+    return strcmp(left->name, right->name);
+}
+
+static bool is_entry_name(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return dot && (size_t)(dot - name) == BUILD_CACHE_KEY_LENGTH && (strcmp(dot, ".hack") == 0 || strcmp(dot, ".bin") == 0);
+}
+
+// Removes least recently used entries until the cache fits its limit
+static void trim(const BuildCache *cache) {
+    DIR *dir = opendir(cache->dir);
+    if (!dir) return;
+
+    CacheEntry *entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    uint64_t total = 0;
+    const struct dirent *dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        struct stat info;
+        if (!is_entry_name(dirent->d_name) || fstatat(dirfd(dir), dirent->d_name, &info, 0) != 0) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            CacheEntry *grown = realloc(entries, capacity * sizeof(CacheEntry));
+            if (!grown) break;
+            entries = grown;
+        }
+        CacheEntry *entry = &entries[count++];
+        strcpy(entry->name, dirent->d_name);
+        entry->size = (uint64_t)info.st_size;
+        entry->used = info.st_mtim;
+        total += entry->size;
+    }
+
+    if (total > cache->max_size) {
+        qsort(entries, count, sizeof(CacheEntry), compare_by_use);
+        for (size_t i = 0; i < count && total > cache->max_size; i++) {
+            if (unlinkat(dirfd(dir), entries[i].name, 0) == 0) total -= entries[i].size;
+        }
+    }
+    free(entries);
+    closedir(dir);
+}
+
+void build_cache_close(BuildCache *cache) {
+    if (!cache) return;
+    if (atomic_load(&cache->stored)) trim(cache);
+    free(cache);
+}
+
+bool build_cache_key(const char *source_path, const OutputFormat format, char *key) {
+    if (!source_path || !key) return false;
+    FILE *file = fopen(source_path, "r");
+    if (!file) return false;
+    SourceBuffer *source = source_buffer_create(file);
+    fclose(file);
+    if (!source) return false;
+
+    // Outputs of another assembler version or format must never match
+    const char *version = "hackasm " ASSEMBLER_VERSION;
+    const uint64_t seed = build_cache_hash(version, strlen(version), (uint64_t)format);
+    const uint64_t hash = build_cache_hash(source->data, source->size, seed);
+    snprintf(key, BUILD_CACHE_KEY_LENGTH + 1, "%016" PRIx64 "%016" PRIx64, hash, (uint64_t)source->size);
+    source_buffer_free(source);
+    return true;
+}
+
+static bool entry_path(const BuildCache *cache, const char *key, const OutputFormat format, char *path) {
+    const int length = snprintf(path, PATH_MAX, "%s/%.*s%s", cache->dir, BUILD_CACHE_KEY_LENGTH, key,
+                                format == OUTPUT_FORMAT_BIN ? ".bin" : ".hack");
+    return length > 0 && length < PATH_MAX;
+}
+
+// Copies the contents of one open descriptor into another
+static bool copy_descriptor(const int from, const int to) {
+    char buffer[COPY_CHUNK_SIZE];
+    for (;;) {
+        const ssize_t n = read(from, buffer, sizeof(buffer));
+        if (n == 0) return true;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        for (ssize_t written = 0; written < n;) {
+            const ssize_t w = write(to, buffer + written, (size_t)(n - written));
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            written += w;
+        }
+    }
+}
+
+bool build_cache_fetch(BuildCache *cache, const char *key, const OutputFormat format, const char *target_path) {
+    char path[PATH_MAX];
+    if (!cache || !key || !target_path || !entry_path(cache, key, format, path)) return false;
+
+    // Refreshing the mtime is what marks the entry as recently used
+    if (utimensat(AT_FDCWD, path, NULL, 0) != 0) return false;
+
+    if (unlink(target_path) != 0 && errno != ENOENT) return false;
+    if (link(path, target_path) == 0) return true;
+
+    const int from = open(path, O_RDONLY | O_CLOEXEC);
+    if (from < 0) return false;
+    const int to = open(target_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    bool copied = to >= 0 && copy_descriptor(from, to);
+    if (to >= 0 && close(to) != 0) copied = false;
+    close(from);
+    if (!copied) unlink(target_path);
+    return copied;
+}
+
+bool build_cache_store(BuildCache *cache, const char *key, const OutputFormat format, const char *target_path) {
+    char path[PATH_MAX];
+    char temp[PATH_MAX];
+    if (!cache || !key || !target_path || !entry_path(cache, key, format, path)) return false;
+    if (access(path, F_OK) == 0) return true;  // Stored meanwhile by another process
+    if (snprintf(temp, sizeof(temp), "%s/tmp.XXXXXX", cache->dir) >= (int)sizeof(temp)) return false;
+
+    const int from = open(target_path, O_RDONLY | O_CLOEXEC);
+    if (from < 0) return false;
+    const int to = mkstemp(temp);
+    bool stored = to >= 0 && copy_descriptor(from, to);
+    close(from);
+    if (to < 0) return false;
+
+    // mkstemp creates the file private; entries are linked into place, so they get the usual output mode
+    if (fchmod(to, 0644) != 0) stored = false;
+    if (close(to) != 0) stored = false;
+    if (stored && rename(temp, path) == 0) {
+        atomic_store(&cache->stored, true);
+        return true;
+    }
+    unlink(temp);
+    return false;
+}
+
+void build_cache_detach(const char *path) {
+    struct stat info;
+    if (path && lstat(path, &info) == 0 && S_ISREG(info.st_mode) && info.st_nlink > 1) unlink(path);
+}
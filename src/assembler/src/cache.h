@@ -0,0 +1,82 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <assembler.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BUILD_CACHE_DEFAULT_SIZE ((uint64_t)256 << 20)  // Bytes kept when no limit is given
+#define BUILD_CACHE_KEY_LENGTH 32                        // Hex digits of a key (without terminator)
+
+/**
+ * On-disk cache of assembler outputs keyed by source content.
+ *
+ * A key is a 64-bit xxHash of the source bytes (seeded with ASSEMBLER_VERSION and the
+ * output format) plus the source size. Entries are flat files '<key>.hack' or '<key>.bin'
+ * in the cache directory, written to a temporary name and renamed into place, so several
+ * processes or threads can share one directory. An entry's mtime is refreshed on every hit,
+ * and build_cache_close() removes the least recently used entries beyond the size limit.
+ */
+typedef struct BuildCache BuildCache;
+
+/**
+ * @brief Opens (creating if needed) a cache directory.
+ *
+ * @param dir Cache directory (its parent must exist).
+ * @param max_size Size limit in bytes enforced on close (0 = BUILD_CACHE_DEFAULT_SIZE).
+ * @return Pointer to BuildCache (close with build_cache_close), or NULL if the directory is unusable.
+ */
+BuildCache *build_cache_open(const char *dir, uint64_t max_size);
+
+/**
+ * @brief Enforces the size limit if anything was stored, then frees the cache handle.
+ *
+ * @param cache Cache handle (may be NULL).
+ */
+void build_cache_close(BuildCache *cache);
+
+/**
+ * @brief 64-bit xxHash (XXH64) of a byte range.
+ */
+uint64_t build_cache_hash(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief Computes the cache key of a source file.
+ *
+ * @param source_path Source file to hash.
+ * @param format Output format (part of the key).
+ * @param key Receives BUILD_CACHE_KEY_LENGTH hex digits and a terminator.
+ * @return true on success, false if the file could not be read.
+ */
+bool build_cache_key(const char *source_path, OutputFormat format, char *key);
+
+/**
+ * @brief Puts the cached output for 'key' at 'target_path', if there is one.
+ *
+ * The entry is hard-linked into place (copied if linking fails, e.g. across file systems);
+ * an existing target is replaced.
+ *
+ * @return true on a hit (target written), false on a miss or error (target untouched).
+ */
+bool build_cache_fetch(BuildCache *cache, const char *key, OutputFormat format, const char *target_path);
+
+/**
+ * @brief Stores a freshly written output under 'key'.
+ *
+ * @return true if the entry was stored.
+ */
+bool build_cache_store(BuildCache *cache, const char *key, OutputFormat format, const char *target_path);
+
+/**
+ * @brief Makes sure writing 'path' cannot modify another link to the same file.
+ *
+ * Outputs fetched from the cache share their inode with the cache entry; rewriting one in
+ * place would corrupt the entry. If 'path' has several links it is removed, so the next
+ * open for writing creates a new file.
+ *
+ * @param path Output path about to be written.
+ */
+void build_cache_detach(const char *path);
+
+#endif // CACHE_H
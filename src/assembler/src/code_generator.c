@@ -1,89 +1,119 @@
 #include "code_generator.h"
-#include <stdio.h>
 #include <string.h>
 #include "token.h"
 
-const char* encode_comp(int comp);
-const char* encode_dest(int dest);
-const char* encode_jump(int jump);
+#define C_INSTRUCTION_PREFIX 0xE000u    // 111xxxxxxxxxxxxx
+#define A_VALUE_MASK 0x7FFFu
 
-// Function to generate binary code for an instruction
-void generate_binary(const Instruction *instruction, char *binary_output) {
+// Number of TokenType values (NEWLINE is the last enumerator)
+#define TOKEN_TYPE_COUNT (NEWLINE + 1)
+
+// a + c1..c6, d1..d3 and j1..j3 bits for each mnemonic (unlisted tokens, and the null dest and jump,
+// encode as 0)
+static const uint16_t comp_bits[TOKEN_TYPE_COUNT] = {
+#define COMP(token, bits, ...) [token] = bits,
+#include "mnemonics.def"
+};
+static const uint16_t dest_bits[TOKEN_TYPE_COUNT] = {
+#define DEST(token, bits, ...) [token] = bits,
+#include "mnemonics.def"
+};
+static const uint16_t jump_bits[TOKEN_TYPE_COUNT] = {
+#define JUMP(token, bits, ...) [token] = bits,
+#include "mnemonics.def"
+};
+
+// Mnemonic for every bit pattern (the inverse of the tables above; unused comp patterns map to 0)
+static const uint8_t comp_tokens[128] = {
+#define COMP(token, bits, ...) [bits] = token,
+#include "mnemonics.def"
+};
+static const uint8_t dest_tokens[8] = {
+    [0] = TOKEN_DEST_NULL,
+#define DEST(token, bits, ...) [bits] = token,
+#include "mnemonics.def"
+};
+static const uint8_t jump_tokens[8] = {
+    [0] = TOKEN_JUMP_NULL,
+#define JUMP(token, bits, ...) [bits] = token,
+#include "mnemonics.def"
+};
+
+// ASCII digits for every byte value, built at compile time
+#define BITS8(b) { \
+    '0' + (((b) >> 7) & 1), '0' + (((b) >> 6) & 1), '0' + (((b) >> 5) & 1), '0' + (((b) >> 4) & 1), \
+    '0' + (((b) >> 3) & 1), '0' + (((b) >> 2) & 1), '0' + (((b) >> 1) & 1), '0' + ((b) & 1) }
+#define BITS8_X4(b) BITS8(b), BITS8((b) + 1), BITS8((b) + 2), BITS8((b) + 3)
+#define BITS8_X16(b) BITS8_X4(b), BITS8_X4((b) + 4), BITS8_X4((b) + 8), BITS8_X4((b) + 12)
+#define BITS8_X64(b) BITS8_X16(b), BITS8_X16((b) + 16), BITS8_X16((b) + 32), BITS8_X16((b) + 48)
+
+static const char byte_ascii[256][8] = {
+    BITS8_X64(0), BITS8_X64(64), BITS8_X64(128), BITS8_X64(192)
+};
+
+static inline uint16_t field_bits(const uint16_t *table, const int type) {
+    return (type >= 0 && type < TOKEN_TYPE_COUNT) ? table[type] : 0;
+}
+
+uint16_t encode_instruction(const Instruction *instruction) {
     if (instruction->type == A_INSTRUCTION_VALUE) {
         // A-instruction: 0 + 15-bit address
-        for (int i = 15; i >= 0; i--) {
-            binary_output[15 - i] = (instruction->value & (1 << i)) ? '1' : '0';
-        }
-    } else if (instruction->type == C_INSTRUCTION) {
+        return (uint16_t)(instruction->value & A_VALUE_MASK);
+    }
+    if (instruction->type == C_INSTRUCTION) {
         // C-instruction: 111 + comp + dest + jump
-        snprintf(binary_output, 17, "111%s%s%s",
-                 encode_comp(instruction->comp),
-                 encode_dest(instruction->dest),
-                 encode_jump(instruction->jump));
-    } else {
-        // Invalid instruction
-        strcpy(binary_output, "0000000000000000");
+        return (uint16_t)(C_INSTRUCTION_PREFIX |
+                          field_bits(comp_bits, instruction->comp) << 6 |
+                          field_bits(dest_bits, instruction->dest) << 3 |
+                          field_bits(jump_bits, instruction->jump));
     }
+    // Invalid instruction
+    return 0;
 }
 
-const char* encode_comp(const int comp) {
-    switch (comp) {
-        case TOKEN_COMP_0: return "0101010";
-        case TOKEN_COMP_1: return "0111111";
-        case TOKEN_COMP_NEG1: return "0111010";
-        case TOKEN_COMP_D: return "0001100";
-        case TOKEN_COMP_A: return "0110000";
-        case TOKEN_COMP_NOT_D: return "0001101";
-        case TOKEN_COMP_NOT_A: return "0110001";
-        case TOKEN_COMP_NEG_D: return "0001111";
-        case TOKEN_COMP_NEG_A: return "0110011";
-        case TOKEN_COMP_DPLUS1: return "0011111";
-        case TOKEN_COMP_APLUS1: return "0110111";
-        case TOKEN_COMP_DMINUS1: return "0001110";
-        case TOKEN_COMP_AMINUS1: return "0110010";
-        case TOKEN_COMP_DPLUSA: return "0000010";
-        case TOKEN_COMP_DMINUSA: return "0010011";
-        case TOKEN_COMP_AMINUSD: return "0000111";
-        case TOKEN_COMP_DANDA: return "0000000";
-        case TOKEN_COMP_DORA: return "0010101";
-        case TOKEN_COMP_M: return "1110000";
-        case TOKEN_COMP_NOT_M: return "1110001";
-        case TOKEN_COMP_NEG_M: return "1110011";
-        case TOKEN_COMP_MPLUS1: return "1110111";
-        case TOKEN_COMP_MMINUS1: return "1110010";
-        case TOKEN_COMP_DPLUSM: return "1000010";
-        case TOKEN_COMP_DMINUSM: return "1010011";
-        case TOKEN_COMP_MMINUSD: return "1000111";
-        case TOKEN_COMP_DANDM: return "1000000";
-        case TOKEN_COMP_DORM: return "1010101";
-        default: return "0000000";  // Invalid case
-    }
+uint16_t encode_address(const int address) {
+    return (uint16_t)(address & A_VALUE_MASK);
 }
 
-const char* encode_dest(const int dest) {
-    switch (dest) {
-        case TOKEN_DEST_NULL: return "000";
-        case TOKEN_DEST_M: return "001";
-        case TOKEN_DEST_D: return "010";
-        case TOKEN_DEST_MD: return "011";
-        case TOKEN_DEST_A: return "100";
-        case TOKEN_DEST_AM: return "101";
-        case TOKEN_DEST_AD: return "110";
-        case TOKEN_DEST_AMD: return "111";
-        default: return "000";  // Invalid case
+bool pack_instruction(const Instruction *instruction, PackedInstruction *packed) {
+    switch (instruction->type) {
+        case A_INSTRUCTION_VALUE:
+        case C_INSTRUCTION:
+            *packed = PACKED_MAKE(PACKED_WORD, encode_instruction(instruction));
+            return true;
+        case A_INSTRUCTION_SYMBOL:
+        case L_INSTRUCTION:
+            if (instruction->symbol > PACKED_ID_MAX) return false;
+            *packed = PACKED_MAKE(instruction->type == L_INSTRUCTION ? PACKED_LABEL : PACKED_SYMBOL,
+                                  instruction->symbol);
+            return true;
+        default:
+            return false;
     }
 }
 
-const char* encode_jump(const int jump) {
-    switch (jump) {
-        case TOKEN_JUMP_NULL: return "000";
-        case TOKEN_JUMP_JGT: return "001";
-        case TOKEN_JUMP_JEQ: return "010";
-        case TOKEN_JUMP_JGE: return "011";
-        case TOKEN_JUMP_JLT: return "100";
-        case TOKEN_JUMP_JNE: return "101";
-        case TOKEN_JUMP_JLE: return "110";
-        case TOKEN_JUMP_JMP: return "111";
-        default: return "000";  // Invalid case
+void unpack_instruction(const PackedInstruction packed, Instruction *instruction) {
+    const uint16_t word = PACKED_WORD_VALUE(packed);
+    if (PACKED_KIND(packed) == PACKED_LABEL || PACKED_KIND(packed) == PACKED_SYMBOL) {
+        *instruction = (Instruction){
+            .type = PACKED_KIND(packed) == PACKED_LABEL ? L_INSTRUCTION : A_INSTRUCTION_SYMBOL,
+            .symbol = PACKED_PAYLOAD(packed)};
+    } else if (!(word & ~A_VALUE_MASK)) {
+        *instruction = (Instruction){.type = A_INSTRUCTION_VALUE, .value = word};
+    } else {
+        *instruction = (Instruction){.type = C_INSTRUCTION, .symbol = STRING_ID_NONE,
+                                     .dest = dest_tokens[(word >> 3) & 7], .comp = comp_tokens[(word >> 6) & 0x7F],
+                                     .jump = jump_tokens[word & 7]};
     }
 }
+
+void word_to_ascii(const uint16_t word, char *ascii_output) {
+    memcpy(ascii_output, byte_ascii[word >> 8], 8);
+    memcpy(ascii_output + 8, byte_ascii[word & 0xFF], 8);
+}
+
+// Function to generate binary code for an instruction
+void generate_binary(const Instruction *instruction, char *binary_output) {
+    word_to_ascii(encode_instruction(instruction), binary_output);
+    binary_output[16] = '\0';
+}
@@ -5,6 +5,58 @@
 #define CODE_GENERATOR_H
 
 #include "instruction.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bytes per instruction in a .hack file: 16 binary digits plus '\n'
+#define HACK_LINE_LENGTH 17
+
+/**
+ * @brief Encodes an instruction as a 16-bit Hack machine word.
+ *
+ * A-instructions encode their 15-bit value; C-instructions combine precomputed
+ * comp/dest/jump bit patterns. Any other instruction type encodes as 0.
+ *
+ * @param instruction Pointer to the parsed instruction structure.
+ * @return The encoded machine word.
+ */
+uint16_t encode_instruction(const Instruction *instruction);
+
+/**
+ * @brief Encodes an A-instruction loading a resolved address (its low 15 bits).
+ */
+uint16_t encode_address(int address);
+
+/**
+ * @brief Packs a parsed instruction into its 32-bit IR record (see PackedInstruction).
+ *
+ * Numeric A-instructions and C-instructions become PACKED_WORD records holding their
+ * encoded word; symbolic A-instructions and labels keep their StringId.
+ *
+ * @param instruction Pointer to the parsed instruction.
+ * @param packed Output: the record.
+ * @return false for an INVALID_INSTRUCTION or a StringId above PACKED_ID_MAX.
+ */
+bool pack_instruction(const Instruction *instruction, PackedInstruction *packed);
+
+/**
+ * @brief Recovers the instruction a record was packed from (used to dump the token stream).
+ *
+ * @param packed A record made by pack_instruction().
+ * @param instruction Output: the instruction, with the original dest/comp/jump mnemonics.
+ */
+void unpack_instruction(PackedInstruction packed, Instruction *instruction);
+
+/**
+ * @brief Writes a machine word as 16 ASCII binary digits (most significant bit first).
+ *
+ * Uses a byte-wide lookup table, so a word costs two 8-byte copies. The output
+ * is not null-terminated.
+ *
+ * @param word The machine word.
+ * @param ascii_output Buffer of at least 16 characters.
+ */
+void word_to_ascii(uint16_t word, char *ascii_output);
 
 /**
  * @brief Generates a binary representation of the given instruction.
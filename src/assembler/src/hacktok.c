@@ -0,0 +1,44 @@
+/**
+ * @brief Token dump viewer (`hacktok`).
+ *
+ * @details
+ * Renders a binary token dump written by `hackasm -t` (see token_dump.h) as text, one token
+ * per line, in the format the assembler used to write directly.
+ *
+ * **Usage:**
+ *   hacktok                  // Renders tokens.tok
+ *   hacktok dump.tok         // Renders dump.tok
+ *   hackasm - -t < a.asm > /dev/null && hacktok tokens.tok | grep SYMBOL
+ *   cat dump.tok | hacktok - // Reads the dump from standard input
+ */
+
+#include "token_dump.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_DUMP "tokens.tok"
+#define USAGE "Usage: %s [dump.tok|-]\n"
+
+int main(const int argc, char *argv[]) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] != '\0')) {
+        fprintf(stderr, USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *path = argc == 2 ? argv[1] : DEFAULT_DUMP;
+
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!in) {
+        fprintf(stderr, "Failed to open token dump '%s': %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    const bool ok = token_dump_render(in, stdout);
+    if (in != stdin) fclose(in);
+    if (fflush(stdout) != 0 || !ok) {
+        fprintf(stderr, "Error: '%s' is not a complete token dump.\n", path);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,9 @@
 #ifndef INSTRUCTION_H
 #define INSTRUCTION_H
 
+#include "token.h"
+#include <stdint.h>
+
 // Enum for instruction types
 typedef enum {
     A_INSTRUCTION_SYMBOL,  // @LABEL
@@ -14,7 +17,7 @@ typedef enum {
 typedef struct {
     InstructionType type;
     union {
-        char *symbol;       // For L-instructions and symbolic A-instructions
+        StringId symbol;    // For L-instructions and symbolic A-instructions (interned id)
         int value;          // For numeric A-instructions (@40, @100)
     };
     int dest;               // TOKEN_DEST_*
@@ -22,4 +25,32 @@ typedef struct {
     int jump;               // TOKEN_JUMP_*
 } Instruction;
 
+/*
+ * Packed instruction: the IR between the assembler's passes, one 32-bit record per line.
+ *
+ *   bits 31-30  kind
+ *   bits 29-0   payload
+ *
+ *   PACKED_WORD    final machine word in bits 15-0: a numeric A-instruction, or a C-instruction
+ *                  with its comp/dest/jump bits already encoded
+ *   PACKED_SYMBOL  StringId of a symbolic A-instruction, resolved to an address in pass 2
+ *   PACKED_LABEL   StringId of a label definition (produces no word)
+ *
+ * Pass 2 only has to resolve PACKED_SYMBOL records; everything else is final after pass 1.
+ * See pack_instruction() and unpack_instruction() in code_generator.h.
+ */
+typedef uint32_t PackedInstruction;
+
+#define PACKED_WORD 0u
+#define PACKED_SYMBOL 1u
+#define PACKED_LABEL 2u
+
+#define PACKED_KIND_SHIFT 30
+#define PACKED_ID_MAX ((1u << PACKED_KIND_SHIFT) - 1)  // Largest StringId a record can hold
+
+#define PACKED_MAKE(kind, payload) ((PackedInstruction)((kind) << PACKED_KIND_SHIFT | (payload)))
+#define PACKED_KIND(packed) ((packed) >> PACKED_KIND_SHIFT)
+#define PACKED_PAYLOAD(packed) ((packed) & PACKED_ID_MAX)
+#define PACKED_WORD_VALUE(packed) ((uint16_t)((packed) & 0xFFFFu))
+
 #endif // INSTRUCTION_H
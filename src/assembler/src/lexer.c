@@ -3,486 +3,452 @@
 //
 
 #include "lexer.h"
+#include "code_generator.h"
 #include "token.h"
 #include <logger.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
-
-ProcessStatus preprocess_line(char *line, char **processed_line, ssize_t read);
-ProcessStatus lex_label(char *line, TokenTable *token_table, SymbolTable *symbol_table, const int *rom_address);
-ProcessStatus lex_symbol(char **line, char **symbol);
-ProcessStatus lex_a_instruction(char *line, TokenTable *token_table);
-ProcessStatus lex_integer_literal(char **line, int *integer_literal);
-ProcessStatus lex_c_instruction(char *line, TokenTable *token_table);
-ProcessStatus lex_dest(char **line, TokenTable *token_table);
-ProcessStatus lex_comp(char **line, TokenTable *token_table);
-ProcessStatus lex_jump(char **line, TokenTable *token_table);
-bool is_keyword(const char *symbol);
-
-
-ProcessStatus lex_line(char *line, const ssize_t read, TokenTable *token_table, SymbolTable *symbol_table, int *rom_address) {
-    if (!line || read <= 0 || !token_table || !symbol_table || !rom_address) return PROCESS_ERROR;
-
-    // Preprocess line - removes whitespace
-    char *processed_line = NULL;
-    ProcessStatus status = preprocess_line(line, &processed_line, read);
-    if (status != PROCESS_SUCCESS) return status;
 
-    // Check for empty line (Safe to ignore empty/comment line)
-    if (!processed_line) return PROCESS_SUCCESS;
+// Cursor over the content of one line, lexed in place inside the source buffer
+typedef struct {
+    const char *source;   // Start of the whole source buffer
+    size_t pos;           // Current offset into 'source'
+    size_t end;           // End of the line content (comment and trailing whitespace removed)
+    bool spaced;          // Whether the content contains whitespace (else fields are contiguous)
+} LineCursor;
+
+ProcessStatus lex_label(LineCursor *cursor, StringPool *string_pool, SymbolTable *symbol_table,
+                        const int *rom_address, Instruction *instruction);
+ProcessStatus lex_symbol(LineCursor *cursor, const char **symbol, size_t *length);
+ProcessStatus lex_a_instruction(LineCursor *cursor, StringPool *string_pool, Instruction *instruction);
+ProcessStatus lex_integer_literal(LineCursor *cursor, int *integer_literal);
+ProcessStatus lex_c_instruction(LineCursor *cursor, Instruction *instruction);
+ProcessStatus lex_dest(LineCursor *cursor, int *dest);
+ProcessStatus lex_comp(LineCursor *cursor, int *comp);
+ProcessStatus lex_jump(LineCursor *cursor, int *jump);
+bool is_keyword(const char *symbol, size_t length);
+
+// ASCII-only classification (the source is not locale dependent)
+static inline bool is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
 
-    // Lex L-instruction (Labels)
-    if (*processed_line == '(') {
-        status = lex_label(processed_line, token_table, symbol_table, rom_address);
-        free(processed_line);
-        return status;
-    }
+static inline bool is_digit(const char c) {
+    return c >= '0' && c <= '9';
+}
 
-    // Lex A-instruction (@value)
-    if (*processed_line == '@') {
-        status = lex_a_instruction(processed_line, token_table);
-        (*rom_address)++;
-        free(processed_line);
-        return status;
-    }
+static inline bool is_symbol_char(const char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || is_digit(c) ||
+           c == '_' || c == '.' || c == '$' || c == ':';
+}
 
-    // Lex C-instruction
-    status = lex_c_instruction(processed_line, token_table);
-    (*rom_address)++;
-    free(processed_line);
-    return status;
+static inline void skip_spaces(LineCursor *cursor) {
+    while (cursor->pos < cursor->end && is_space(cursor->source[cursor->pos])) cursor->pos++;
 }
 
-ProcessStatus preprocess_line(char *line, char **processed_line, const ssize_t read) {
-    if (!line || read <= 0) return PROCESS_ERROR;
+// Mnemonic lookup keys: the characters packed low byte first, tagged with the length in the top byte
+#define MNEMONIC_MAX_LENGTH 6
+#define MNEMONIC_TAG(chars, length) ((chars) | (uint64_t)(length) << 56)
+#define MNEMONIC_KEY(...) MNEMONIC_TAG(MNEMONIC_CHARS(__VA_ARGS__, 0, 0, 0, 0, 0, 0), \
+                                       MNEMONIC_COUNT(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0))
+#define MNEMONIC_CHARS(c0, c1, c2, c3, c4, c5, ...) \
+    ((uint64_t)(c0) | (uint64_t)(c1) << 8 | (uint64_t)(c2) << 16 | (uint64_t)(c3) << 24 | \
+     (uint64_t)(c4) << 32 | (uint64_t)(c5) << 40)
+#define MNEMONIC_COUNT(c0, c1, c2, c3, c4, c5, count, ...) count
+
+// Slot of a key in a table of 2^bits entries (multiply-shift hashing). The multipliers were searched
+// for so that every mnemonics.def name gets a slot of its own; a collision after editing that file
+// initializes a slot twice, which -Woverride-init (in -Wextra) turns into a build error.
+#define MNEMONIC_SLOT(key, multiplier, bits) ((size_t)(((key) * (multiplier)) >> (64 - (bits))))
+
+#define COMP_HASH_MULTIPLIER UINT64_C(0x10b99ac9f178d77f)
+#define COMP_HASH_BITS 6
+#define DEST_HASH_MULTIPLIER UINT64_C(0x1818e811892f902b)
+#define DEST_HASH_BITS 3
+#define JUMP_HASH_MULTIPLIER UINT64_C(0x6513270e269e0d37)
+#define JUMP_HASH_BITS 3
+#define KEYWORD_HASH_MULTIPLIER UINT64_C(0x48d48ad6fb84830b)
+#define KEYWORD_HASH_BITS 6
+
+typedef struct {
+    uint64_t key;         // 0 for an empty slot (no real key is 0, as lengths start at 1)
+    uint8_t token;
+} MnemonicSlot;
+
+#define MNEMONIC_ENTRY(table, token, ...) \
+    [MNEMONIC_SLOT(MNEMONIC_KEY(__VA_ARGS__), table##_HASH_MULTIPLIER, table##_HASH_BITS)] = \
+        {MNEMONIC_KEY(__VA_ARGS__), token},
+
+static const MnemonicSlot comp_slots[1 << COMP_HASH_BITS] = {
+#define COMP(token, bits, ...) MNEMONIC_ENTRY(COMP, token, __VA_ARGS__)
+#include "mnemonics.def"
+};
+static const MnemonicSlot dest_slots[1 << DEST_HASH_BITS] = {
+#define DEST(token, bits, ...) MNEMONIC_ENTRY(DEST, token, __VA_ARGS__)
+#include "mnemonics.def"
+};
+static const MnemonicSlot jump_slots[1 << JUMP_HASH_BITS] = {
+#define JUMP(token, bits, ...) MNEMONIC_ENTRY(JUMP, token, __VA_ARGS__)
+#include "mnemonics.def"
+};
+static const MnemonicSlot keyword_slots[1 << KEYWORD_HASH_BITS] = {
+#define DEST(token, bits, ...) MNEMONIC_ENTRY(KEYWORD, token, __VA_ARGS__)
+#define JUMP(token, bits, ...) MNEMONIC_ENTRY(KEYWORD, token, __VA_ARGS__)
+#define KEYWORD(...) MNEMONIC_ENTRY(KEYWORD, TOKEN_SYMBOL, __VA_ARGS__)
+#include "mnemonics.def"
+};
+
+// Packs the non-whitespace characters of [from, to) into a mnemonic key.
+// Returns false if the field is empty or longer than 'max' characters.
+static bool collect_key(const LineCursor *cursor, size_t from, const size_t to, const size_t max,
+                        uint64_t *key) {
+    const char *source = cursor->source;
+    uint64_t chars = 0;
+    size_t n = 0;
+    for (; from < to; from++) {
+        if (cursor->spaced && is_space(source[from])) continue;
+        if (n == max) return false;
+        chars |= (uint64_t)(unsigned char)source[from] << (8 * n++);
+    }
+    *key = MNEMONIC_TAG(chars, n);
+    return n > 0;
+}
 
-    // Allocate a buffer with at most 'read' size (worst case: no spaces removed)
-    char *buffer = calloc(read + 2, sizeof(char)); // +1 for null terminator
-    if (!buffer) return PROCESS_ERROR;
+ProcessStatus lex_line(const char *source, const size_t line_start, const size_t line_length, TokenTable *token_table,
+                       StringPool *string_pool, SymbolTable *symbol_table, int *rom_address) {
+    if (!source) return PROCESS_ERROR;
 
-    // Find comment position
-    const char *comment_start = strstr(line, "//");
+    LineScanner scanner;
+    ScannedLine line;
+    line_scanner_init(&scanner, source, line_start, line_start + line_length);
+    if (!line_scanner_next(&scanner, &line)) return PROCESS_SUCCESS;  // Empty line
+    return lex_scanned_line(source, &line, token_table, string_pool, symbol_table, rom_address);
+}
 
-    // Copy only non-whitespace characters up to comment start
-    size_t j = 0;
-    for (size_t i = 0; i < (size_t)read; i++) {
-        if (comment_start && line + i >= comment_start) {
-            break; // Stop copying at start of comment
-        }
-        if (!isspace(line[i])) {
-            buffer[j++] = line[i];
+ProcessStatus lex_source(const char *source, const size_t start, const size_t end, TokenTable *token_table,
+                         StringPool *string_pool, SymbolTable *symbol_table, int *rom_address,
+                         int *line_count, ScannedLine *error_line) {
+    if (!source || !line_count || !error_line) return PROCESS_ERROR;
+
+    LineScanner scanner;
+    ScannedLine line;
+    int lines = 0;
+    line_scanner_init(&scanner, source, start, end);
+    while (line_scanner_next(&scanner, &line)) {
+        lines++;
+        if (line.type == LINE_BLANK) continue;
+        const ProcessStatus status = lex_scanned_line(source, &line, token_table, string_pool, symbol_table,
+                                                      rom_address);
+        if (status != PROCESS_SUCCESS) {
+            *line_count = lines;
+            *error_line = line;
+            return status;
         }
     }
+    *line_count = lines;
+    return PROCESS_SUCCESS;
+}
 
-    // If the processed line is empty, free buffer and return
-    if (j == 0) {
-        free(buffer);
-        *processed_line = NULL;
-        return PROCESS_SUCCESS;
+ProcessStatus lex_source_instructions(const char *source, const size_t start, const size_t end,
+                                      TokenTable *instructions, StringPool *string_pool, SymbolTable *symbol_table,
+                                      int *rom_address, int *line_count, ScannedLine *error_line) {
+    if (!source || !instructions || !line_count || !error_line) return PROCESS_ERROR;
+
+    LineScanner scanner;
+    ScannedLine line;
+    Instruction instruction;
+    PackedInstruction packed;
+    int lines = 0;
+    line_scanner_init(&scanner, source, start, end);
+    while (line_scanner_next(&scanner, &line)) {
+        lines++;
+        if (line.type == LINE_BLANK) continue;
+        ProcessStatus status = lex_scanned_instruction(source, &line, string_pool, symbol_table, rom_address,
+                                                       &instruction);
+        if (status == PROCESS_SUCCESS &&
+            (!pack_instruction(&instruction, &packed) || !token_table_add(instructions, &packed))) {
+            status = PROCESS_ERROR;
+        }
+        if (status != PROCESS_SUCCESS) {
+            *line_count = lines;
+            *error_line = line;
+            return status;
+        }
     }
+    *line_count = lines;
+    return PROCESS_SUCCESS;
+}
 
-    // Ensure last character is '\n' before null terminator
-    if (buffer[j - 1] != '\n') {
-        buffer[j++] = '\n';
-    }
+ProcessStatus lex_scanned_line(const char *source, const ScannedLine *line, TokenTable *token_table,
+                               StringPool *string_pool, SymbolTable *symbol_table, int *rom_address) {
+    if (!token_table) return PROCESS_ERROR;
 
-    buffer[j] = '\0'; // Null-terminate
-    *processed_line = buffer;
+    Instruction instruction;
+    const ProcessStatus status = lex_scanned_instruction(source, line, string_pool, symbol_table, rom_address,
+                                                         &instruction);
+    if (status != PROCESS_SUCCESS || instruction.type == INVALID_INSTRUCTION) return status;
+
+    Token tokens[INSTRUCTION_MAX_TOKENS];
+    const size_t count = instruction_to_tokens(&instruction, tokens);
+    for (size_t i = 0; i < count; i++) {
+        if (!token_table_add(token_table, &tokens[i])) return PROCESS_ERROR;
+    }
     return PROCESS_SUCCESS;
 }
 
-ProcessStatus lex_label(char *line, TokenTable *token_table, SymbolTable *symbol_table, const int *rom_address) {
-    if (!line || !token_table || !symbol_table || !rom_address) return PROCESS_ERROR;
+ProcessStatus lex_scanned_instruction(const char *source, const ScannedLine *line, StringPool *string_pool,
+                                      SymbolTable *symbol_table, int *rom_address, Instruction *instruction) {
+    if (!source || !line || !string_pool || !symbol_table || !rom_address || !instruction) return PROCESS_ERROR;
 
-    // Tokenize '('
-    if (*line != '(') return PROCESS_INVALID;
-    Token *l_paren = create_token(TOKEN_LPAREN);
-    if (!l_paren) return PROCESS_ERROR;
-    if (!token_table_add(token_table, l_paren)) {
-        free_token(l_paren);
-        return PROCESS_ERROR;
+    // The scanner already stripped the comment and surrounding whitespace
+    LineCursor cursor = {.source = source, .pos = line->start, .end = line->end, .spaced = line->spaced};
+
+    switch (line->type) {
+        case LINE_BLANK:
+            *instruction = (Instruction){.type = INVALID_INSTRUCTION};  // Safe to ignore empty/comment line
+            return PROCESS_SUCCESS;
+        case LINE_LABEL:
+            return lex_label(&cursor, string_pool, symbol_table, rom_address, instruction);
+        case LINE_A_INSTRUCTION:
+            (*rom_address)++;
+            return lex_a_instruction(&cursor, string_pool, instruction);
+        case LINE_C_INSTRUCTION:
+        default:
+            (*rom_address)++;
+            return lex_c_instruction(&cursor, instruction);
+    }
+}
+
+size_t instruction_to_tokens(const Instruction *instruction, Token tokens[INSTRUCTION_MAX_TOKENS]) {
+    switch (instruction->type) {
+        case L_INSTRUCTION:
+            tokens[0] = (Token){.type = TOKEN_LPAREN, .value.symbol = STRING_ID_NONE};
+            tokens[1] = (Token){.type = TOKEN_SYMBOL, .value.symbol = instruction->symbol};
+            tokens[2] = (Token){.type = TOKEN_RPAREN, .value.symbol = STRING_ID_NONE};
+            tokens[3] = (Token){.type = NEWLINE, .value.symbol = STRING_ID_NONE};
+            return 4;
+        case A_INSTRUCTION_SYMBOL:
+        case A_INSTRUCTION_VALUE:
+            tokens[0] = (Token){.type = TOKEN_AT, .value.symbol = STRING_ID_NONE};
+            tokens[1] = instruction->type == A_INSTRUCTION_SYMBOL
+                            ? (Token){.type = TOKEN_SYMBOL, .value.symbol = instruction->symbol}
+                            : (Token){.type = TOKEN_INTEGER, .value.integer = instruction->value};
+            tokens[2] = (Token){.type = NEWLINE, .value.symbol = STRING_ID_NONE};
+            return 3;
+        case C_INSTRUCTION:
+            tokens[0] = (Token){.type = (TokenType)instruction->dest, .value.symbol = STRING_ID_NONE};
+            tokens[1] = (Token){.type = (TokenType)instruction->comp, .value.symbol = STRING_ID_NONE};
+            tokens[2] = (Token){.type = (TokenType)instruction->jump, .value.symbol = STRING_ID_NONE};
+            tokens[3] = (Token){.type = NEWLINE, .value.symbol = STRING_ID_NONE};
+            return 4;
+        default:
+            return 0;
     }
-    line++;  // Move past '('
+}
+
+ProcessStatus lex_label(LineCursor *cursor, StringPool *string_pool, SymbolTable *symbol_table,
+                        const int *rom_address, Instruction *instruction) {
+    if (!cursor || !string_pool || !symbol_table || !rom_address || !instruction) return PROCESS_ERROR;
+
+    // Match '('
+    if (cursor->source[cursor->pos] != '(') return PROCESS_INVALID;
+    cursor->pos++;  // Move past '('
+    skip_spaces(cursor);
 
     // Extract symbol
-    char *symbol = NULL;
-    const ProcessStatus status = lex_symbol(&line, &symbol);
+    const char *symbol = NULL;
+    size_t length = 0;
+    const ProcessStatus status = lex_symbol(cursor, &symbol, &length);
     if (status != PROCESS_SUCCESS) return status;
 
     // If it's a reserved keyword -> invalid
-    if (is_keyword(symbol)) {
-        GLOG(LOG_ERROR, "Invalid Symbol: '%s' is a reserved hack keyword", symbol);
-        free(symbol);
+    if (is_keyword(symbol, length)) {
+        GLOG(LOG_ERROR, "Invalid Symbol: '%.*s' is a reserved hack keyword", (int)length, symbol);
         return PROCESS_INVALID;
     }
 
-    // Tokenize symbol
-    Token *symbol_token = create_token(TOKEN_SYMBOL, symbol);
-    if (!symbol_token) {
-        free(symbol);
-        return PROCESS_ERROR;
-    }
-    if (!token_table_add(token_table, symbol_token)) {
-        free_token(symbol_token);
-        free(symbol);
+    // Intern and add symbol to table (first definition wins)
+    const StringId id = string_pool_intern(string_pool, symbol, length);
+    if (id == STRING_ID_NONE) return PROCESS_ERROR;
+    if (symbol_table_lookup_or_insert_id(symbol_table, id, *rom_address, NULL) < 0) {
         return PROCESS_ERROR;
     }
 
-    // Add symbol to table
-    if (!symbol_table_contains(symbol_table, symbol)
-        && !symbol_table_add(symbol_table, symbol, *rom_address)) {
-        free(symbol);
-        return PROCESS_ERROR;
-    }
-    free(symbol);
-
-    // Tokenize ')'
-    if (*line != ')') return PROCESS_INVALID;
-    Token *r_paren = create_token(TOKEN_RPAREN);
-    if (!r_paren) return PROCESS_ERROR;
-    if (!token_table_add(token_table, r_paren)) {
-        free_token(r_paren);
-        return PROCESS_ERROR;
-    }
-    line++;
-
-    // Tokenize newline
-    if (*line != '\n') return PROCESS_INVALID;
-    Token *newline = create_token(NEWLINE);
-    if (!newline) return PROCESS_ERROR;
-    if (!token_table_add(token_table, newline)) {
-        free_token(newline);
-        return PROCESS_ERROR;
-    }
+    // Match ')', which must end the line
+    skip_spaces(cursor);
+    if (cursor->pos == cursor->end || cursor->source[cursor->pos] != ')') return PROCESS_INVALID;
+    cursor->pos++;
+    skip_spaces(cursor);
+    if (cursor->pos != cursor->end) return PROCESS_INVALID;
 
+    *instruction = (Instruction){.type = L_INSTRUCTION, .symbol = id};
     return PROCESS_SUCCESS;
 }
 
-ProcessStatus lex_symbol(char **line, char **symbol) {
-    if (!line || !*line || !symbol) return PROCESS_ERROR;
+ProcessStatus lex_symbol(LineCursor *cursor, const char **symbol, size_t *length) {
+    if (!cursor || !symbol || !length) return PROCESS_ERROR;
 
-    const char *start = *line;
-    const char *end = strpbrk(*line, ")\n");
-
-    if (!start || !end || end < start) {
-        return PROCESS_INVALID; // No valid symbol found
-    }
+    const size_t start = cursor->pos;
+    size_t end = start;
+    while (end < cursor->end && is_symbol_char(cursor->source[end])) end++;
 
-    const size_t len = end - start;
-    if (len == 0) {
+    if (end == start) {
         return PROCESS_INVALID; // Empty symbol is invalid
     }
 
     // Ensure symbol does not start with a digit
-    if (isdigit(start[0])) {
+    if (is_digit(cursor->source[start])) {
         return PROCESS_INVALID;
     }
 
-    // Allocate memory for the symbol
-    char *label = malloc(len + 1);
-    if (!label) return PROCESS_ERROR;
+    *symbol = cursor->source + start;
+    *length = end - start;
 
-    // Validate and copy character by character
-    int i = 0;
-    for (const char *ptr = start; ptr < end; ptr++) {
-        const char c = *ptr;
-
-        // Check if character is valid
-        if (!(isalnum(c) || c == '_' || c == '.' || c == '$' || c == ':')) {
-            free(label);
-            return PROCESS_INVALID; // Invalid character in symbol
-        }
-
-        label[i++] = c;
-    }
-
-    label[i] = '\0';        // Null-terminate
-    *symbol = label;        // Set output parameter
-
-    *line = (char*)end;     // Move the caller's line pointer upto ')' or '\n'
+    cursor->pos = end;     // Move the cursor past the symbol
     return PROCESS_SUCCESS;
 }
 
-ProcessStatus lex_a_instruction(char *line, TokenTable *token_table) {
-    if (!line || !token_table) return PROCESS_ERROR;
+ProcessStatus lex_a_instruction(LineCursor *cursor, StringPool *string_pool, Instruction *instruction) {
+    if (!cursor || !string_pool || !instruction) return PROCESS_ERROR;
 
-    // Create '@' operator token
-    if (*line != '@') return PROCESS_ERROR;
-    Token *at_token = create_token(TOKEN_AT);
-    if (!at_token) return PROCESS_ERROR;
-    if (!token_table_add(token_table, at_token)) {
-        free_token(at_token);
-        return PROCESS_ERROR;
-    }
-    line++;  // Move past '@'
+    // Match '@'
+    if (cursor->source[cursor->pos] != '@') return PROCESS_ERROR;
+    cursor->pos++;  // Move past '@'
+    skip_spaces(cursor);
+    if (cursor->pos == cursor->end) return PROCESS_INVALID;
 
     // Lex @value:
-    if (isdigit(*line)) {
+    if (is_digit(cursor->source[cursor->pos])) {
         //Extract integer literal
         int integer_literal = 0;
-        const ProcessStatus status = lex_integer_literal(&line, &integer_literal);
+        const ProcessStatus status = lex_integer_literal(cursor, &integer_literal);
         if (status != PROCESS_SUCCESS) return status;
 
-        // Tokenise integer literal
-        Token *int_token = create_token(TOKEN_INTEGER, integer_literal);
-        if (!int_token) return PROCESS_ERROR;
-        if (!token_table_add(token_table, int_token)) {
-            free_token(int_token);
-            return PROCESS_ERROR;
-        }
+        *instruction = (Instruction){.type = A_INSTRUCTION_VALUE, .value = integer_literal};
     } else {
         // Extract symbol
-        char *symbol = NULL;
-        const ProcessStatus status = lex_symbol(&line, &symbol);
+        const char *symbol = NULL;
+        size_t length = 0;
+        const ProcessStatus status = lex_symbol(cursor, &symbol, &length);
         if (status != PROCESS_SUCCESS) return status;
 
-        // Tokenize symbol
-        Token *symbol_token = create_token(TOKEN_SYMBOL, symbol);
-        if (!symbol_token) {
-            free(symbol);
-            return PROCESS_ERROR;
-        }
-        free(symbol);
-        if (!token_table_add(token_table, symbol_token)) {
-            free_token(symbol_token);
-            return PROCESS_ERROR;
-        }
-    }
-
-    // Tokenize newline
-    if (*line != '\n') return PROCESS_INVALID;
-    Token *newline = create_token(NEWLINE);
-    if (!newline) return PROCESS_ERROR;
-    if (!token_table_add(token_table, newline)) {
-        free_token(newline);
-        return PROCESS_ERROR;
+        // Intern the symbol, so repeated references share one id
+        const StringId id = string_pool_intern(string_pool, symbol, length);
+        if (id == STRING_ID_NONE) return PROCESS_ERROR;
+        *instruction = (Instruction){.type = A_INSTRUCTION_SYMBOL, .symbol = id};
     }
 
-    return PROCESS_SUCCESS;
+    // Nothing may follow the value
+    return cursor->pos == cursor->end ? PROCESS_SUCCESS : PROCESS_INVALID;
 }
 
-ProcessStatus lex_integer_literal(char **line, int *integer_literal) {
-    if (!line || !*line || !integer_literal) return PROCESS_ERROR;
+ProcessStatus lex_integer_literal(LineCursor *cursor, int *integer_literal) {
+    if (!cursor || !integer_literal) return PROCESS_ERROR;
 
-    if (!isdigit(**line)) return PROCESS_INVALID;
+    if (cursor->pos == cursor->end || !is_digit(cursor->source[cursor->pos])) return PROCESS_INVALID;
 
-    char number[6] = {0};  // Max "32767" + null terminator
-    int i = 0;
-    while (isdigit(**line) && i < 5) {
-        number[i++] = **line;
-        (*line)++;
+    // Max "32767" -> at most 5 digits
+    long num = 0;
+    int digits = 0;
+    while (cursor->pos < cursor->end && is_digit(cursor->source[cursor->pos])) {
+        if (++digits > 5) return PROCESS_INVALID;
+        num = num * 10 + (cursor->source[cursor->pos] - '0');
+        cursor->pos++;
     }
-    number[i] = '\0';
 
-    // Convert to int
-    char *end_ptr;
-    const long num = strtol(number, &end_ptr, 10);
-    if (*end_ptr != '\0' || num < 0 || num >= 32768) return PROCESS_INVALID;
+    if (num >= 32768) return PROCESS_INVALID;
     *integer_literal = (int) num;
 
     return PROCESS_SUCCESS;
 }
 
-ProcessStatus lex_c_instruction(char *line, TokenTable *token_table) {
-    if (!line || !token_table) return PROCESS_ERROR;
+ProcessStatus lex_c_instruction(LineCursor *cursor, Instruction *instruction) {
+    if (!cursor || !instruction) return PROCESS_ERROR;
+    *instruction = (Instruction){.type = C_INSTRUCTION, .symbol = STRING_ID_NONE};
 
     // Process dest
-    ProcessStatus status = lex_dest(&line, token_table);
+    ProcessStatus status = lex_dest(cursor, &instruction->dest);
     if (status != PROCESS_SUCCESS) return status;
 
     // Process comp
-    status = lex_comp(&line, token_table);
+    status = lex_comp(cursor, &instruction->comp);
     if (status != PROCESS_SUCCESS) return status;
 
     // Process jump
-    status = lex_jump(&line, token_table);
+    status = lex_jump(cursor, &instruction->jump);
     if (status != PROCESS_SUCCESS) return status;
 
-    // Tokenize newline
-    if (*line != '\n') return PROCESS_INVALID;
-    Token *newline = create_token(NEWLINE);
-    if (!newline) return PROCESS_ERROR;
-    if (!token_table_add(token_table, newline)) {
-        free_token(newline);
-        return PROCESS_ERROR;
-    }
-
-    return PROCESS_SUCCESS;
+    // Nothing may follow the jump
+    return cursor->pos == cursor->end ? PROCESS_SUCCESS : PROCESS_INVALID;
 }
 
-ProcessStatus lex_dest(char **line, TokenTable *token_table) {
-    if (!line || !*line || !token_table) return PROCESS_ERROR;
+ProcessStatus lex_dest(LineCursor *cursor, int *dest_type) {
+    if (!cursor || !dest_type) return PROCESS_ERROR;
 
-    char *eq_pos = strchr(*line, '=');
-    if (!eq_pos) {
-        Token *null_token = create_token(TOKEN_DEST_NULL);
-        if (!null_token) return PROCESS_ERROR;
-        if (!token_table_add(token_table, null_token)) {
-            free(null_token);
-            return PROCESS_ERROR;
-        }
+    const char *eq = memchr(cursor->source + cursor->pos, '=', cursor->end - cursor->pos);
+    if (!eq) {
+        *dest_type = TOKEN_DEST_NULL;
         return PROCESS_SUCCESS;
     }
+    const size_t eq_pos = eq - cursor->source;
 
-    // Extract potential destination (everything before `=`)
-    const size_t dest_len = eq_pos - *line;
-    if (dest_len == 0 || dest_len > 3) return PROCESS_INVALID; // Empty or too long
-
-    char dest[4] = {0}; // Max valid dest length is 3 ("AMD"), +1 for null terminator
-    strncpy(dest, *line, dest_len);
-    dest[dest_len] = '\0';
-
-    // List of valid destinations
-    const struct {
-        const char *name;
-        TokenType type;
-    } valid_dests[] = {
-        {"M",   TOKEN_DEST_M},
-        {"D",   TOKEN_DEST_D},
-        {"MD",  TOKEN_DEST_MD},
-        {"A",   TOKEN_DEST_A},
-        {"AM",  TOKEN_DEST_AM},
-        {"AD",  TOKEN_DEST_AD},
-        {"AMD", TOKEN_DEST_AMD}
-    };
-
-    // Validate and create token
-    for (size_t i = 0; i < sizeof(valid_dests) / sizeof(valid_dests[0]); i++) {
-        if (strcmp(dest, valid_dests[i].name) == 0) {
-            Token *token = create_token(valid_dests[i].type);
-            if (!token) return PROCESS_ERROR;
-            if (!token_table_add(token_table, token)) {
-                free(token);
-                return PROCESS_ERROR;
-            }
-            *line = eq_pos + 1; // Move to '='
-            return PROCESS_SUCCESS;
-        }
-    }
+    // Look up the destination (everything before `=`; at most 3 chars, "AMD")
+    uint64_t key;
+    if (!collect_key(cursor, cursor->pos, eq_pos, 3, &key)) return PROCESS_INVALID;
+    const MnemonicSlot *slot = &dest_slots[MNEMONIC_SLOT(key, DEST_HASH_MULTIPLIER, DEST_HASH_BITS)];
+    if (slot->key != key) return PROCESS_INVALID;  // Invalid destination
 
-    return PROCESS_INVALID; // Invalid destination
+    *dest_type = slot->token;
+    cursor->pos = eq_pos + 1; // Move past '='
+    return PROCESS_SUCCESS;
 }
 
-ProcessStatus lex_comp(char **line, TokenTable *token_table) {
-    if (!line || !*line || !token_table) return PROCESS_ERROR;
-
-    char *end = strpbrk(*line, ";\n");  // Find `;` or newline
-    const size_t comp_len = end ? (size_t)(end - *line) : strlen(*line);
-
-    if (comp_len == 0) return PROCESS_INVALID;  // Empty comp is invalid
-
-    char comp[5] = {0};  // Max length of comp mnemonics is 4 ("D|M"), +1 for null
-    if (comp_len > 4) return PROCESS_INVALID;  // Too long for a valid comp
-
-    strncpy(comp, *line, comp_len);
-    comp[comp_len] = '\0';
-
-    // List of valid comp mnemonics
-    const struct {
-        const char *name;
-        TokenType type;
-    } valid_comps[] = {
-        {"0",    TOKEN_COMP_0},   {"1",    TOKEN_COMP_1},
-        {"-1",   TOKEN_COMP_NEG1},{"D",    TOKEN_COMP_D},
-        {"A",    TOKEN_COMP_A},   {"M",    TOKEN_COMP_M},
-        {"!D",   TOKEN_COMP_NOT_D},{"!A",   TOKEN_COMP_NOT_A},
-        {"!M",   TOKEN_COMP_NOT_M},{"-D",   TOKEN_COMP_NEG_D},
-        {"-A",   TOKEN_COMP_NEG_A},{"-M",   TOKEN_COMP_NEG_M},
-        {"D+1",  TOKEN_COMP_DPLUS1},{"A+1", TOKEN_COMP_APLUS1},
-        {"M+1", TOKEN_COMP_MPLUS1},{"D-1",  TOKEN_COMP_DMINUS1},
-        {"A-1",TOKEN_COMP_AMINUS1},{"M-1", TOKEN_COMP_MMINUS1},
-        {"D+A",  TOKEN_COMP_DPLUSA},{"D+M", TOKEN_COMP_DPLUSM},
-        {"D-A", TOKEN_COMP_DMINUSA},{"D-M",  TOKEN_COMP_DMINUSM},
-        {"A-D",TOKEN_COMP_AMINUSD},{"M-D", TOKEN_COMP_MMINUSD},
-        {"D&A",  TOKEN_COMP_DANDA},{"D&M", TOKEN_COMP_DANDM},
-        {"D|A", TOKEN_COMP_DORA},{"D|M",  TOKEN_COMP_DORM}
-    };
-
-    // Validate and create token
-    for (size_t i = 0; i < sizeof(valid_comps) / sizeof(valid_comps[0]); i++) {
-        if (strcmp(comp, valid_comps[i].name) == 0) {
-            Token *token = create_token(valid_comps[i].type);
-            if (!token) return PROCESS_ERROR;
-            if (!token_table_add(token_table, token)) {
-                free(token);
-                return PROCESS_ERROR;
-            }
-            *line = end ? end : *line + comp_len;  // Move past comp
-            return PROCESS_SUCCESS;
-        }
-    }
+ProcessStatus lex_comp(LineCursor *cursor, int *comp_type) {
+    if (!cursor || !comp_type) return PROCESS_ERROR;
+
+    // Comp runs up to ';' if there is a jump, else to the end of the line
+    const char *semicolon = memchr(cursor->source + cursor->pos, ';', cursor->end - cursor->pos);
+    const size_t comp_end = semicolon ? (size_t)(semicolon - cursor->source) : cursor->end;
 
-    return PROCESS_INVALID; // Invalid comp
+    // Look up the mnemonic (at most 3 chars, e.g. "D|M")
+    uint64_t key;
+    if (!collect_key(cursor, cursor->pos, comp_end, 3, &key)) return PROCESS_INVALID;
+    const MnemonicSlot *slot = &comp_slots[MNEMONIC_SLOT(key, COMP_HASH_MULTIPLIER, COMP_HASH_BITS)];
+    if (slot->key != key) return PROCESS_INVALID;  // Invalid comp
+
+    *comp_type = slot->token;
+    cursor->pos = comp_end;  // Move past comp
+    return PROCESS_SUCCESS;
 }
 
-ProcessStatus lex_jump(char **line, TokenTable *token_table) {
-    if (!line || !*line || !token_table) return PROCESS_ERROR;
+ProcessStatus lex_jump(LineCursor *cursor, int *jump_type) {
+    if (!cursor || !jump_type) return PROCESS_ERROR;
 
     // If no jump set TOKEN_JUMP_NULL
-    if (**line != ';') {
-        Token *null_token = create_token(TOKEN_JUMP_NULL);
-        if (!null_token) return PROCESS_ERROR;
-        if (!token_table_add(token_table, null_token)) {
-            free(null_token);
-            return PROCESS_ERROR;
-        }
+    if (cursor->pos == cursor->end || cursor->source[cursor->pos] != ';') {
+        *jump_type = TOKEN_JUMP_NULL;
         return PROCESS_SUCCESS;
     }
-    (*line)++; // Move past ';'
-
-    // Valid jump length is 3 ("JMP"), +1 for null terminator
-    if (strlen(*line) - 1 != 3) return PROCESS_INVALID;
-    char jump[4] = {0};
-    strncpy(jump, *line, 3);
-    jump[3] = '\0';
-
-    // List of valid destinations
-    const struct {
-        const char *name;
-        TokenType type;
-    } valid_jumps[] = {
-        {"JGT",   TOKEN_JUMP_JGT},
-        {"JEQ",   TOKEN_JUMP_JEQ},
-        {"JGE",  TOKEN_JUMP_JGE},
-        {"JLT",   TOKEN_JUMP_JLT},
-        {"JNE",  TOKEN_JUMP_JNE},
-        {"JLE",  TOKEN_JUMP_JLE},
-        {"JMP", TOKEN_JUMP_JMP}
-    };
-
-    // Validate and create token
-    for (size_t i = 0; i < sizeof(valid_jumps) / sizeof(valid_jumps[0]); i++) {
-        if (strcmp(jump, valid_jumps[i].name) == 0) {
-            Token *token = create_token(valid_jumps[i].type);
-            if (!token) return PROCESS_ERROR;
-            if (!token_table_add(token_table, token)) {
-                free(token);
-                return PROCESS_ERROR;
-            }
-            *line = *line + 3; // Move past ';'
-            return PROCESS_SUCCESS;
-        }
-    }
+    cursor->pos++; // Move past ';'
 
-    return PROCESS_INVALID;
-}
+    // Look up the mnemonic (always 3 chars, e.g. "JMP")
+    uint64_t key;
+    if (!collect_key(cursor, cursor->pos, cursor->end, 3, &key)) return PROCESS_INVALID;
+    const MnemonicSlot *slot = &jump_slots[MNEMONIC_SLOT(key, JUMP_HASH_MULTIPLIER, JUMP_HASH_BITS)];
+    if (slot->key != key) return PROCESS_INVALID;
 
-bool is_keyword(const char *symbol) {
-    static const char *keywords[] = {
-        "A", "M", "D", "AMD", "AD", "MD", "AM", "JMP", "JEQ", "JGT", "JGE",
-        "JLT", "JLE", "JNE", "NULL", "THIS", "THAT", "R0", "R1", "R2", "R3",
-        "R4", "R5", "R6", "R7", "R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15",
-        "SCREEN", "KBD", "SP", "LCL", "ARG", "TEMP"
-    };
+    *jump_type = slot->token;
+    cursor->pos = cursor->end; // Move past jump
+    return PROCESS_SUCCESS;
+}
 
-    const size_t num_keywords = sizeof(keywords) / sizeof(keywords[0]);
+bool is_keyword(const char *symbol, const size_t length) {
+    if (length == 0 || length > MNEMONIC_MAX_LENGTH) return false;
 
-    for (size_t i = 0; i < num_keywords; i++) {
-        if (strcmp(symbol, keywords[i]) == 0) {
-            return true;
-        }
-    }
-    return false;
+    uint64_t chars = 0;
+    for (size_t i = 0; i < length; i++) chars |= (uint64_t)(unsigned char)symbol[i] << (8 * i);
+    const uint64_t key = MNEMONIC_TAG(chars, length);
+    return keyword_slots[MNEMONIC_SLOT(key, KEYWORD_HASH_MULTIPLIER, KEYWORD_HASH_BITS)].key == key;
 }
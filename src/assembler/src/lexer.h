@@ -6,8 +6,15 @@
 #define LEXER_H
 
 
+#include "instruction.h"
+#include "line_scanner.h"
 #include "symbol_table.h"
 #include <token_table.h>
+#include <stddef.h>
+#include <string_pool.h>
+
+// Most tokens one instruction expands to (see instruction_to_tokens)
+#define INSTRUCTION_MAX_TOKENS 4
 
 typedef enum {
     PROCESS_SUCCESS,   // Successfully processed a valid line
@@ -24,9 +31,17 @@ typedef enum {
  * If the line represents an instruction, the ROM address is updated. Additionally, it validates syntax and
  * assigns meaning via the extracted tokens.
  *
- * @param line         The assembly source line (read-only).
- * @param read         Length of the line (used for memory allocation).
+ * The line is located with a LineScanner and then handed to lex_scanned_line(). The assembler
+ * itself lexes into packed instruction records (lex_source_instructions()); the token form
+ * serves tools and tests.
+ * The line is lexed in place: no copy is made. Symbols are interned in 'string_pool' and
+ * symbol tokens carry the interned id, so repeated references share one stored string.
+ *
+ * @param source       Start of the source buffer containing the line (read-only).
+ * @param line_start   Offset of the first character of the line within 'source'.
+ * @param line_length  Length of the line in bytes (a trailing newline is optional).
  * @param token_table  A pointer to the TokenTable where tokens will be stored.
+ * @param string_pool  A pointer to the StringPool used to intern symbols.
  * @param symbol_table A pointer to the SymbolTable for tracking symbols and labels.
  * @param rom_address  A pointer to the ROM address counter, updated for instruction lines.
  *
@@ -35,7 +50,98 @@ typedef enum {
  *         - PROCESS_INVALID: Syntax error detected.
  *         - PROCESS_ERROR:   Critical failure (e.g., memory allocation failure).
  */
-ProcessStatus lex_line(char *line, ssize_t read, TokenTable *token_table, SymbolTable *symbol_table, int *rom_address);
+ProcessStatus lex_line(const char *source, size_t line_start, size_t line_length, TokenTable *token_table,
+                       StringPool *string_pool, SymbolTable *symbol_table, int *rom_address);
+
+/**
+ * @brief Tokenizes a line already located and classified by a LineScanner.
+ *
+ * Dispatches on the line type without re-examining the raw text. Lines the scanner marked as
+ * free of inner whitespace take a fast path that matches fields directly in the source buffer.
+ *
+ * @param source       The buffer the line was scanned from (read-only).
+ * @param line         The scanned line.
+ * @param token_table  A pointer to the TokenTable where tokens will be stored.
+ * @param string_pool  A pointer to the StringPool used to intern symbols.
+ * @param symbol_table A pointer to the SymbolTable for tracking symbols and labels.
+ * @param rom_address  A pointer to the ROM address counter, updated for instruction lines.
+ *
+ * @return The same ProcessStatus values as lex_line().
+ */
+ProcessStatus lex_scanned_line(const char *source, const ScannedLine *line, TokenTable *token_table,
+                               StringPool *string_pool, SymbolTable *symbol_table, int *rom_address);
+
+/**
+ * @brief Lexes and parses one scanned line in a single pass, straight into an Instruction.
+ *
+ * This is the fused front end: the line's fields are matched in the source buffer and stored in
+ * 'instruction' without producing tokens. Labels are added to the symbol table and symbols are
+ * interned exactly as by lex_scanned_line(). A blank line yields an INVALID_INSTRUCTION record.
+ *
+ * @param source       The buffer the line was scanned from (read-only).
+ * @param line         The scanned line.
+ * @param string_pool  A pointer to the StringPool used to intern symbols.
+ * @param symbol_table A pointer to the SymbolTable for tracking symbols and labels.
+ * @param rom_address  A pointer to the ROM address counter, updated for instruction lines.
+ * @param instruction  Output: the parsed instruction (only complete on success).
+ *
+ * @return The same ProcessStatus values as lex_line().
+ */
+ProcessStatus lex_scanned_instruction(const char *source, const ScannedLine *line, StringPool *string_pool,
+                                      SymbolTable *symbol_table, int *rom_address, Instruction *instruction);
 
+/**
+ * @brief Expands an instruction into the tokens lex_scanned_line() produces for it.
+ *
+ * L: '(' symbol ')' NEWLINE; A: '@' symbol-or-integer NEWLINE; C: dest comp jump NEWLINE.
+ *
+ * @param instruction A parsed instruction.
+ * @param tokens      Output: room for INSTRUCTION_MAX_TOKENS tokens.
+ * @return Number of tokens written (0 for INVALID_INSTRUCTION).
+ */
+size_t instruction_to_tokens(const Instruction *instruction, Token tokens[INSTRUCTION_MAX_TOKENS]);
+
+/**
+ * @brief Lexes and parses every line of source[start, end) into packed instruction records.
+ *
+ * The fused counterpart of lex_source(): one PackedInstruction (see instruction.h) per label or
+ * instruction line, in source order, appended to 'instructions' (a TokenTable of
+ * sizeof(PackedInstruction) records). Only symbolic A-instructions are left for pass 2 to resolve.
+ *
+ * @param source       Source buffer (read-only).
+ * @param start        Offset of the first line.
+ * @param end          Offset one past the last byte.
+ * @param instructions Table receiving the packed records.
+ * @param string_pool  A pointer to the StringPool used to intern symbols.
+ * @param symbol_table A pointer to the SymbolTable receiving labels.
+ * @param rom_address  A pointer to the ROM address counter, updated for instruction lines.
+ * @param line_count   Output: as for lex_source().
+ * @param error_line   Output: the failing line (only written on failure).
+ *
+ * @return PROCESS_SUCCESS, or the status of the first line that failed.
+ */
+ProcessStatus lex_source_instructions(const char *source, size_t start, size_t end, TokenTable *instructions,
+                                      StringPool *string_pool, SymbolTable *symbol_table, int *rom_address,
+                                      int *line_count, ScannedLine *error_line);
+
+/**
+ * @brief Tokenizes every line of source[start, end), stopping at the first error.
+ *
+ * @param source       Source buffer (read-only).
+ * @param start        Offset of the first line.
+ * @param end          Offset one past the last byte.
+ * @param token_table  A pointer to the TokenTable where tokens will be stored.
+ * @param string_pool  A pointer to the StringPool used to intern symbols.
+ * @param symbol_table A pointer to the SymbolTable receiving labels.
+ * @param rom_address  A pointer to the ROM address counter, updated for instruction lines.
+ * @param line_count   Output: number of lines lexed or, on failure, the 1-based number of the failing
+ *                     line counted from 'start'.
+ * @param error_line   Output: the failing line (only written on failure).
+ *
+ * @return PROCESS_SUCCESS, or the status of the first line that failed.
+ */
+ProcessStatus lex_source(const char *source, size_t start, size_t end, TokenTable *token_table,
+                         StringPool *string_pool, SymbolTable *symbol_table, int *rom_address,
+                         int *line_count, ScannedLine *error_line);
 
 #endif //LEXER_H
@@ -0,0 +1,183 @@
+#include "line_scanner.h"
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define WINDOW_SIZE 64
+
+// ASCII-only classification, matching the lexer
+static inline bool is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Classifies 'length' (<= 64) bytes one at a time
+static void classify_scalar(const char *data, const size_t length, LineScanner *scanner) {
+    uint64_t newline = 0, space = 0, slash = 0;
+    for (size_t i = 0; i < length; i++) {
+        const char c = data[i];
+        newline |= (uint64_t)(c == '\n') << i;
+        space |= (uint64_t)is_space(c) << i;
+        slash |= (uint64_t)(c == '/') << i;
+    }
+    scanner->newline = newline;
+    scanner->space = space;
+    scanner->slash = slash;
+}
+
+#if defined(__AVX2__)
+
+static inline uint32_t space_mask(const __m256i v) {
+    // ' ' or any of '\t' '\n' '\v' '\f' '\r' (0x09..0x0D)
+    const __m256i offset = _mm256_sub_epi8(v, _mm256_set1_epi8(0x09));
+    const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(4)), offset);
+    const __m256i blank = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(control, blank));
+}
+
+static void classify_window(const char *data, LineScanner *scanner) {
+    const __m256i lo = _mm256_loadu_si256((const __m256i *)data);
+    const __m256i hi = _mm256_loadu_si256((const __m256i *)(data + 32));
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i sl = _mm256_set1_epi8('/');
+
+    scanner->newline = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, nl)) |
+                       (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, nl)) << 32;
+    scanner->slash = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, sl)) |
+                     (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, sl)) << 32;
+    scanner->space = space_mask(lo) | (uint64_t)space_mask(hi) << 32;
+}
+
+#elif defined(__SSE2__)
+
+static inline uint16_t space_mask(const __m128i v) {
+    // ' ' or any of '\t' '\n' '\v' '\f' '\r' (0x09..0x0D)
+    const __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(0x09));
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(4)), offset);
+    const __m128i blank = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    return (uint16_t)_mm_movemask_epi8(_mm_or_si128(control, blank));
+}
+
+static void classify_window(const char *data, LineScanner *scanner) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i sl = _mm_set1_epi8('/');
+    uint64_t newline = 0, space = 0, slash = 0;
+    for (int i = 0; i < 4; i++) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)(data + 16 * i));
+        newline |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)) << (16 * i);
+        slash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, sl)) << (16 * i);
+        space |= (uint64_t)space_mask(v) << (16 * i);
+    }
+    scanner->newline = newline;
+    scanner->space = space;
+    scanner->slash = slash;
+}
+
+#else
+
+static void classify_window(const char *data, LineScanner *scanner) {
+    classify_scalar(data, WINDOW_SIZE, scanner);
+}
+
+#endif
+
+// Classifies the 64 bytes starting at 'offset'; bytes at or past the end read as newlines
+static void load_window(LineScanner *scanner, const size_t offset) {
+    const size_t available = scanner->end - offset;
+    if (available >= WINDOW_SIZE) {
+        classify_window(scanner->source + offset, scanner);
+    } else {
+        classify_scalar(scanner->source + offset, available, scanner);
+        scanner->newline |= ~0ULL << available;
+    }
+    scanner->window = offset;
+    scanner->loaded = true;
+}
+
+static LineType line_type(const char first) {
+    if (first == '(') return LINE_LABEL;
+    if (first == '@') return LINE_A_INSTRUCTION;
+    return LINE_C_INSTRUCTION;
+}
+
+// Fallback for a line that does not fit in one window
+static void scan_long_line(LineScanner *scanner, ScannedLine *line) {
+    const char *source = scanner->source;
+    const size_t pos = scanner->pos;
+    const char *newline = memchr(source + pos, '\n', scanner->end - pos);
+    const size_t line_end = newline ? (size_t)(newline - source) : scanner->end;
+
+    const char *comment = memmem(source + pos, line_end - pos, "//", 2);
+    size_t end = comment ? (size_t)(comment - source) : line_end;
+    size_t start = pos;
+    while (start < end && is_space(source[start])) start++;
+    while (end > start && is_space(source[end - 1])) end--;
+
+    line->start = start;
+    line->end = end;
+    line->next = line_end + 1;
+    line->type = start < end ? line_type(source[start]) : LINE_BLANK;
+    line->spaced = false;
+    for (size_t i = start; i < end; i++) {
+        if (is_space(source[i])) {
+            line->spaced = true;
+            break;
+        }
+    }
+    scanner->pos = line->next;
+}
+
+void line_scanner_init(LineScanner *scanner, const char *source, const size_t start, const size_t end) {
+    scanner->source = source;
+    scanner->pos = start;
+    scanner->end = end;
+    scanner->window = start;
+    scanner->loaded = false;
+    scanner->newline = scanner->space = scanner->slash = 0;
+}
+
+bool line_scanner_next(LineScanner *scanner, ScannedLine *line) {
+    const size_t pos = scanner->pos;
+    if (pos >= scanner->end) return false;
+
+    // Find the end of the line in the cached window, re-anchoring the window at this line if needed
+    if (!scanner->loaded || pos - scanner->window >= WINDOW_SIZE) load_window(scanner, pos);
+    size_t offset = pos - scanner->window;
+    uint64_t newline = scanner->newline >> offset;
+    if (!newline && offset > 0) {
+        load_window(scanner, pos);
+        offset = 0;
+        newline = scanner->newline;
+    }
+    if (!newline) {
+        scan_long_line(scanner, line);
+        return true;
+    }
+
+    // All bitmaps are now relative to 'pos'; the line spans bits [0, length)
+    const unsigned length = (unsigned)__builtin_ctzll(newline);
+    const uint64_t line_mask = (1ULL << length) - 1;
+    const uint64_t slash = scanner->slash >> offset;
+    const uint64_t comment = slash & (slash >> 1) & line_mask;
+    const unsigned content_length = comment ? (unsigned)__builtin_ctzll(comment) : length;
+    const uint64_t space = scanner->space >> offset;
+    const uint64_t content = ~space & ((1ULL << content_length) - 1);
+
+    line->next = pos + length + 1;
+    scanner->pos = line->next;
+    if (!content) {
+        line->start = line->end = pos;
+        line->type = LINE_BLANK;
+        line->spaced = false;
+        return true;
+    }
+
+    const unsigned first = (unsigned)__builtin_ctzll(content);
+    const unsigned last = 63u - (unsigned)__builtin_clzll(content);
+    line->start = pos + first;
+    line->end = pos + last + 1;
+    line->type = line_type(scanner->source[line->start]);
+    line->spaced = (space & ((1ULL << (last + 1)) - 1) & ~((1ULL << first) - 1)) != 0;
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef LINE_SCANNER_H
+#define LINE_SCANNER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Kind of a source line, decided from its first significant character
+typedef enum {
+    LINE_BLANK,          // Empty, whitespace-only or comment-only line
+    LINE_LABEL,          // Starts with '('
+    LINE_A_INSTRUCTION,  // Starts with '@'
+    LINE_C_INSTRUCTION   // Anything else
+} LineType;
+
+// One line located by the scanner. Offsets are into the scanned source buffer.
+typedef struct {
+    size_t start;   // First significant character (leading whitespace skipped)
+    size_t end;     // One past the last significant character (comment and trailing whitespace removed)
+    size_t next;    // Offset just past the line's '\n' (may exceed the buffer for the final line)
+    LineType type;
+    bool spaced;    // True if whitespace occurs between start and end
+} ScannedLine;
+
+/**
+ * @brief Splits a source buffer into classified lines.
+ *
+ * The scanner classifies the buffer 64 bytes at a time into newline, '/' and whitespace
+ * bitmaps (AVX2 or SSE2 when available, scalar otherwise). Each line is then located,
+ * stripped and classified with a handful of bit operations on the cached bitmaps, so
+ * the per-byte work is branch-free. Lines longer than one window fall back to a scalar scan.
+ *
+ * Whitespace is ASCII only: ' ', '\t', '\r', '\v' and '\f'. Lines are split on '\n'.
+ */
+typedef struct {
+    const char *source;
+    size_t pos;        // Start of the next line
+    size_t end;        // End of the scanned region
+    size_t window;     // Offset of the classified 64-byte window
+    bool loaded;       // Whether the bitmaps below describe 'window'
+    uint64_t newline;  // Bit i set if source[window + i] is '\n' (or lies at/after 'end')
+    uint64_t space;    // Bit i set if source[window + i] is whitespace
+    uint64_t slash;    // Bit i set if source[window + i] is '/'
+} LineScanner;
+
+/**
+ * @brief Prepares a scanner over source[start, end).
+ * @param scanner Scanner to initialise.
+ * @param source Source buffer (read-only, must stay valid while scanning).
+ * @param start Offset of the first line.
+ * @param end Offset one past the last byte to scan.
+ */
+void line_scanner_init(LineScanner *scanner, const char *source, size_t start, size_t end);
+
+/**
+ * @brief Locates, strips and classifies the next line.
+ * @param scanner Scanner.
+ * @param line Output: the scanned line.
+ * @return true if a line was produced, false once the region is exhausted.
+ */
+bool line_scanner_next(LineScanner *scanner, ScannedLine *line);
+
+#endif // LINE_SCANNER_H
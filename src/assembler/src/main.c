@@ -7,55 +7,205 @@
  * @details
  * The assembler translates Hack Assembly (`.asm`) files into Hack Machine Code (`.hack`).
  * It processes command-line arguments to specify the source file, an optional target file,
- * and an optional flag to print tokens during processing.
+ * and an optional flag to write a token dump.
  *
  * **Usage:**
  *   hackasm source.asm                   // Reads source.asm, writes to source.hack
  *   hackasm source.asm -o target.hack    // Writes to target.hack, reads source.asm
- *   hackasm source.asm -t                // Prints tokens during processing
- *   hackasm -o output.hack -t source.asm // Prints tokens and writes to output.hack
+ *   hackasm source.asm -t                // Also writes the token dump tokens.tok (see hacktok)
+ *   hackasm -o output.hack -t source.asm // Writes tokens.tok and output.hack
+ *   hackasm --format=bin source.asm      // Writes a packed ROM image to source.bin
+ *   hackasm -j 4 big.asm                 // Lexes a large source on up to 4 threads
+ *   hackasm a.asm b.asm progs/           // Batch mode: assembles every file, next to its source
+ *   hackasm -o out/ progs/               // Batch mode: writes every output into out/
+ *   hackasm --serve /tmp/hackasm.sock    // Server mode: keeps warm assemblers, serves requests
+ *   hackasm --connect /tmp/hackasm.sock add.asm  // Client mode: the server assembles add.asm
+ *   hackasm --cache-dir .hackcache add.asm       // Reuses the output if add.asm is unchanged
+ *   gen | hackasm - | load               // Streaming mode: stdin to stdout in bounded memory
+ *   hackasm --stats big.asm              // Reports time per phase, throughput and peak memory
+ *   hackasm --stats=json big.asm         // The same report as one JSON object
  *
  * **Command-line arguments:**
- *   - `source.asm` (required): The Hack assembly source file.
+ *   - `source.asm` (required): The Hack assembly source file. Several files, or a directory
+ *     (scanned for `.asm` files, non-recursively), select batch mode. `-` reads the source from
+ *     standard input in streaming mode (see stream.h); the output then goes to standard output
+ *     unless `-o` names a file (`-o -` also means standard output).
  *   - `-o target` or `--output target` (optional): Specify the target output filename.
  *     If omitted, `.hack` is added to the source filename.
- *   - `-t` or `--tokens` (optional): Enable printing of tokens during processing.
+ *   - `-t` or `--tokens` (optional): Write the token stream to `tokens.tok`, a compact binary
+ *     dump (see token_dump.h); `hacktok` renders it as text.
+ *   - `--format=hack|bin` (optional): Output encoding. `hack` (default) writes one ASCII
+ *     binary word per line; `bin` writes a packed little-endian ROM image (see assembler.h).
+ *     The default target extension follows the format (`.hack` or `.bin`).
+ *   - `-j N` or `--jobs N` (optional): Worker threads for large sources. `0` (default) uses one
+ *     per CPU, `1` forces the sequential path. Output is identical either way.
+ *     In batch mode it is the number of files assembled concurrently.
+ *   - `--serve socket`: Run as a server on a Unix domain socket (no sources and no cache; see server.h).
+ *     `-j N` sizes the worker pool, i.e. the number of requests served concurrently.
+ *   - `--connect socket` (optional): Send a single-file request to a server instead of
+ *     assembling locally. Without it, the `HACKASM_SERVER` environment variable names a
+ *     server to try first; if none is listening there, the file is assembled locally.
+ *   - `--cache-dir dir` (optional): Keep outputs in a content-hash cache (see cache.h). An
+ *     unchanged source is not assembled again: the cached output is linked or copied into place.
+ *     Not used with `-t`, which needs a real run.
+ *   - `--cache-size MiB` (optional): Size limit of the cache (default 256); least recently used
+ *     entries beyond it are removed.
+ *   - `--stats[=json]` (optional): After assembling, print wall and CPU time per phase (read,
+ *     lex, parse, codegen, write), line, byte and token rates, symbol and variable counts and
+ *     peak RSS to stderr, as a table or as one JSON object. The run is always local (no cache
+ *     or server). Builds configured with `-DENABLE_STATS=OFF` report only the totals.
  *   - `--`: Stop argument parsing; all following arguments are positional.
  *
  * **Behavior:**
  *   - Generates the output file from the source file with proper extensions.
  *   - Reports errors for invalid filenames, missing source files, or incorrect usage.
- *   - Optionally prints tokens if the `-t` or `--tokens` flag is provided.
+ *   - Optionally writes the binary token dump `tokens.tok` if `-t` or `--tokens` is provided.
+ *   - In batch mode, `-o` names an existing output directory (default: each source's directory),
+ *     `-t` is not available, and one result line per file is printed in sorted path order.
  *
  * **Examples:**
  *   hackasm add.asm                          → Generates `add.hack`
  *   hackasm -o my_output.hack add.asm        → Generates `my_output.hack`
- *   hackasm loop.asm -o custom.bin -t        → Generates `custom.bin` and prints tokens
- *   hackasm -t -o result.hack program.asm    → Generates `result.hack` and prints tokens
+ *   hackasm loop.asm -o custom.bin -t        → Generates `custom.bin` and `tokens.tok`
+ *   hackasm -t -o result.hack program.asm    → Generates `result.hack` and `tokens.tok`
+ *   hackasm --format=bin add.asm             → Generates `add.bin`
  */
 
+#include "batch.h"
+#include "cache.h"
+#include "server.h"
 #include <assembler.h>
+#include <file_list.h>
 #include <file_utils.h>
 #include <logger.h>
+#include <stats.h>
+#include <thread_pool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <limits.h>
 #include <string.h>
 #include <sys/errno.h>
+#include <sys/stat.h>
 
-#define EXT_ASM ".asm"
 #define EXT_HACK ".hack"
+#define EXT_BIN ".bin"
+#define USAGE "Usage: %s [-o output.hack|dir] [-t|--tokens] [--format=hack|bin] [-j jobs] [--connect socket] " \
+              "[--cache-dir dir [--cache-size MiB]] [--stats[=json]] source.asm|dir...\n       %s [-j jobs] --serve socket\n"
 
-void parse_arguments(int argc, char *argv[], char **source_file, char **target_file, bool *print_tokens);
+// What --stats prints
+typedef enum {
+    STATS_OUTPUT_NONE,
+    STATS_OUTPUT_TEXT,
+    STATS_OUTPUT_JSON
+} StatsOutput;
+
+void parse_arguments(int argc, char *argv[], char **sources, int *source_count, char **target_file,
+                     bool *print_tokens, OutputFormat *format, unsigned *jobs, char **serve_socket,
+                     char **connect_socket, char **cache_dir, uint64_t *cache_size, StatsOutput *stats);
+int run_local(const char *source_file, const char *target_file, bool print_tokens, OutputFormat format,
+              unsigned jobs);
+int run_client(const char *socket_path, bool required, const char *source_file, const char *target_file,
+               OutputFormat format);
+int run_batch(char **sources, int source_count, const char *output_dir, bool print_tokens, OutputFormat format,
+              unsigned jobs, BuildCache *cache);
+
+// Runs at exit so every return path from main() stops the workers
+static void free_thread_pool(void) {
+    ThreadPool *pool = thread_pool_get_global();
+    thread_pool_set_global(NULL);
+    thread_pool_free(pool);
+}
+
+// Starts the shared worker pool for the parallel stages, once the run is known to do work in this
+// process (cache hits and server clients never need it); -j 1 (or no pool) keeps everything here
+static void start_thread_pool(const unsigned jobs) {
+    if (jobs == 1 || thread_pool_get_global()) return;
+    thread_pool_set_global(thread_pool_create(jobs, false));
+    atexit(free_thread_pool);
+}
+
+static bool is_directory(const char *path) {
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+// Assembles locally with a global Stats installed, then reports it to stderr
+static int run_measured(const char *source_file, const char *target_file, const bool print_tokens,
+                        const OutputFormat format, const unsigned jobs, const StatsOutput output) {
+#ifndef STATS_ENABLED
+    fprintf(stderr, "Warning: Built without ENABLE_STATS; only total time and memory are reported.\n");
+#endif
+    Stats *stats = stats_create();
+    if (!stats) {
+        fprintf(stderr, "Failed to initialize stats\n");
+        return EXIT_FAILURE;
+    }
+    stats_set_global(stats);
+    const int status = run_local(source_file, target_file, print_tokens, format, jobs);
+    stats_set_global(NULL);
+    stats_report(stats, stderr, output == STATS_OUTPUT_JSON);
+    stats_free(stats);
+    return status;
+}
+
+// An unusable cache only costs speed, so it is reported and skipped
+static BuildCache *open_cache(const char *cache_dir, const uint64_t cache_size) {
+    if (!cache_dir) return NULL;
+    BuildCache *cache = build_cache_open(cache_dir, cache_size);
+    if (!cache) fprintf(stderr, "Warning: Cache directory '%s' is not usable; building without it.\n", cache_dir);
+    return cache;
+}
 
 int main(const int argc, char *argv[]) {
 
     // Parse arguments
-    char *source_file = NULL;
+    char *sources[argc];
+    int source_count = 0;
     char *target_file = NULL;
     bool print_tokens = false;
-    parse_arguments(argc, argv, &source_file, &target_file, &print_tokens);
+    OutputFormat format = OUTPUT_FORMAT_HACK;
+    unsigned jobs = 0;
+    char *serve_socket = NULL;
+    char *connect_socket = NULL;
+    char *cache_dir = NULL;
+    uint64_t cache_size = 0;
+    StatsOutput stats = STATS_OUTPUT_NONE;
+    parse_arguments(argc, argv, sources, &source_count, &target_file, &print_tokens, &format, &jobs, &serve_socket,
+                    &connect_socket, &cache_dir, &cache_size, &stats);
+
+    if (serve_socket) {
+        start_thread_pool(jobs);
+        return server_run(serve_socket, 0);
+    }
+
+    // Several inputs or a directory: assemble them all in one process
+    if (source_count > 1 || is_directory(sources[0])) {
+        if (stats != STATS_OUTPUT_NONE) {
+            fprintf(stderr, "Error: --stats measures a single source; it is not available in batch mode.\n");
+            return EXIT_FAILURE;
+        }
+        BuildCache *cache = print_tokens ? NULL : open_cache(cache_dir, cache_size);
+        start_thread_pool(jobs);
+        const int status = run_batch(sources, source_count, target_file, print_tokens, format, jobs, cache);
+        build_cache_close(cache);
+        return status;
+    }
+    char *source_file = sources[0];
+
+    // Standard input is assembled as a stream, into standard output unless -o names a file
+    if (strcmp(source_file, "-") == 0) {
+        if (!target_file) target_file = "-";
+        if (strcmp(target_file, "-") != 0) {
+            if (!is_valid_filepath(target_file)) {
+                fprintf(stderr, "Error: Invalid output filename.\n");
+                return EXIT_FAILURE;
+            }
+            build_cache_detach(target_file);
+        }
+        if (stats != STATS_OUTPUT_NONE) return run_measured(source_file, target_file, print_tokens, format, jobs, stats);
+        return run_local(source_file, target_file, print_tokens, format, jobs);
+    }
 
     // Validate source file extension
     if (!has_extension(source_file, EXT_ASM)) {
@@ -76,12 +226,13 @@ int main(const int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
     } else {
-        // Generate default target filename (name.asm -> name.hack)
+        // Generate default target filename (name.asm -> name.hack or name.bin)
         static char default_target[PATH_MAX];
         const char *slash = strrchr(source_file, '/');
         const char *filename = (slash) ? slash + 1 : source_file;
         strncpy(default_target, filename, PATH_MAX);
-        if (!change_file_extension(default_target, PATH_MAX, EXT_HACK)) {
+        if (!change_file_extension(default_target, PATH_MAX,
+                                   format == OUTPUT_FORMAT_BIN ? EXT_BIN : EXT_HACK)) {
             fprintf(stderr, "Error: Unable to generate target filename from.\n");
             return EXIT_FAILURE;
         }
@@ -94,30 +245,81 @@ int main(const int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
+    // A measured run always assembles here
+    if (stats != STATS_OUTPUT_NONE) {
+        build_cache_detach(target_file);
+        return run_measured(source_file, target_file, print_tokens, format, jobs, stats);
+    }
+
+    // An unchanged source is served from the cache without lexing (tokens need a real run)
+    BuildCache *cache = print_tokens ? NULL : open_cache(cache_dir, cache_size);
+    char cache_key[BUILD_CACHE_KEY_LENGTH + 1];
+    if (cache && !build_cache_key(source_file, format, cache_key)) {
+        build_cache_close(cache);
+        cache = NULL;
+    }
+    if (cache && build_cache_fetch(cache, cache_key, format, target_file)) {
+        build_cache_close(cache);
+        return EXIT_SUCCESS;
+    }
+    build_cache_detach(target_file);
+
+    // Hand the file to a running server if one was named (the token dump is only written locally)
+    int status = -1;
+    const char *server_socket = connect_socket ? connect_socket : getenv("HACKASM_SERVER");
+    if (server_socket && *server_socket && !print_tokens) {
+        status = run_client(server_socket, connect_socket != NULL, source_file, target_file, format);
+    }
+    if (status < 0) status = run_local(source_file, target_file, print_tokens, format, jobs);
+
+    if (cache && status == EXIT_SUCCESS) build_cache_store(cache, cache_key, format, target_file);
+    build_cache_close(cache);
+    return status;
+}
+
+/**
+ * @brief Assembles one file in this process.
+ *
+ * A source of "-" is read from standard input with the streaming assembler, and a target of
+ * "-" is standard output.
+ *
+ * @param source_file  Source file path, or "-".
+ * @param target_file  Target file path, or "-".
+ * @param print_tokens Whether to write the token dump to tokens.tok (render it with hacktok).
+ * @param format       Output encoding.
+ * @param jobs         Worker threads for large sources.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+int run_local(const char *source_file, const char *target_file, const bool print_tokens, const OutputFormat format,
+              const unsigned jobs) {
+    start_thread_pool(jobs);
+
     // Open source file for reading
-    FILE *source_file_ptr = fopen(source_file, "r");
+    const bool from_stdin = strcmp(source_file, "-") == 0;
+    const bool to_stdout = strcmp(target_file, "-") == 0;
+    FILE *source_file_ptr = from_stdin ? stdin : fopen(source_file, "r");
     if (!source_file_ptr) {
         fprintf(stderr, "Failed to open source file '%s': %s", source_file, strerror(errno));
         return EXIT_FAILURE;
     }
 
     // Open target file for writing (creates a new file if it doesn't exist)
-    FILE *target_file_ptr = fopen(target_file, "w");
+    FILE *target_file_ptr = to_stdout ? stdout : fopen(target_file, format == OUTPUT_FORMAT_BIN ? "wb" : "w");
     if (!target_file_ptr) {
         fprintf(stderr, "Failed to open target file '%s': %s", target_file, strerror(errno));
-        fclose(source_file_ptr);
+        if (!from_stdin) fclose(source_file_ptr);
         return EXIT_FAILURE;
     }
 
-    // Open token.lex file output if required
+    // Open the binary token dump (tokens.tok, rendered by hacktok) if required
     FILE *token_output_ptr = NULL;
     if (print_tokens) {
-        const char *token_filename = "tokens.lex";
-        token_output_ptr = fopen(token_filename, "w");
+        const char *token_filename = "tokens.tok";
+        token_output_ptr = fopen(token_filename, "wb");
         if (!token_output_ptr) {
             fprintf(stderr, "Failed to open token output file '%s': %s", token_filename, strerror(errno));
-            fclose(source_file_ptr);
-            fclose(target_file_ptr);
+            if (!from_stdin) fclose(source_file_ptr);
+            if (!to_stdout) fclose(target_file_ptr);
             return EXIT_FAILURE;
         }
     }
@@ -126,17 +328,20 @@ int main(const int argc, char *argv[]) {
     const AssemblerConfig config = {
         .source_asm = source_file_ptr,
         .target_hack = target_file_ptr,
-        .source_filepath = source_file,
-        .target_filepath = target_file,
+        .source_filepath = from_stdin ? "<stdin>" : source_file,
+        .target_filepath = to_stdout ? "<stdout>" : target_file,
         .token_output = token_output_ptr,
+        .format = format,
+        .jobs = jobs,
+        .streaming = from_stdin,
     };
 
     // Create assembler
     Assembler *assembler = assembler_create(&config);
     if (!assembler) {
         GLOG(LOG_ERROR, "Failed to initialise assembler.");
-        fclose(source_file_ptr);
-        fclose(target_file_ptr);
+        if (!from_stdin) fclose(source_file_ptr);
+        if (!to_stdout) fclose(target_file_ptr);
         return EXIT_FAILURE;
     }
 
@@ -159,22 +364,160 @@ int main(const int argc, char *argv[]) {
     // Clean up
     logger_free(logger);
     assembler_free(assembler);
-    fclose(token_output_ptr);
-    fclose(source_file_ptr);
-    fclose(target_file_ptr);
+    if (token_output_ptr) fclose(token_output_ptr);
+    if (!from_stdin) fclose(source_file_ptr);
+    if (!to_stdout) fclose(target_file_ptr);
 
     return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+/**
+ * @brief Runs batch mode over files and directories.
+ *
+ * Collects every `.asm` file named directly or found in a named directory, sorts the list by
+ * path (dropping repeats) and assembles it with assemble_batch().
+ *
+ * @param sources      Files and directories from the command line.
+ * @param source_count Number of entries in 'sources'.
+ * @param output_dir   Directory for the outputs (from -o), or NULL.
+ * @param print_tokens Whether -t was given (not supported in batch mode).
+ * @param format       Output encoding.
+ * @param jobs         Number of files assembled concurrently (0 = one per CPU).
+ * @param cache        Build cache to use, or NULL.
+ * @return EXIT_SUCCESS if every file assembled, EXIT_FAILURE otherwise.
+ */
+int run_batch(char **sources, const int source_count, const char *output_dir, const bool print_tokens,
+              const OutputFormat format, const unsigned jobs, BuildCache *cache) {
+    if (print_tokens) {
+        fprintf(stderr, "Error: -t cannot be used with several sources.\n");
+        return EXIT_FAILURE;
+    }
+    if (output_dir && !is_directory(output_dir)) {
+        fprintf(stderr, "Error: Output '%s' must be an existing directory in batch mode.\n", output_dir);
+        return EXIT_FAILURE;
+    }
+
+    FileList *list = file_list_new();
+    if (!list) {
+        fprintf(stderr, "Failed to allocate file list\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < source_count; i++) {
+        if (strcmp(sources[i], "-") == 0) {
+            fprintf(stderr, "Error: Standard input ('-') cannot be combined with other sources.\n");
+            file_list_free(list);
+            return EXIT_FAILURE;
+        }
+        if (!is_directory(sources[i]) && !has_extension(sources[i], EXT_ASM)) {
+            fprintf(stderr, "Error: Source file '%s' must have '.asm' extension.\n", sources[i]);
+            file_list_free(list);
+            return EXIT_FAILURE;
+        }
+        if (!file_list_add(list, sources[i], EXT_ASM)) {
+            fprintf(stderr, "Error: Unable to read '%s': %s\n", sources[i], strerror(errno));
+            file_list_free(list);
+            return EXIT_FAILURE;
+        }
+    }
+    if (list->count == 0) {
+        fprintf(stderr, "Error: No '.asm' files found.\n");
+        file_list_free(list);
+        return EXIT_FAILURE;
+    }
+    file_list_sort(list);
+    file_list_remove_duplicates(list);
+
+    const BatchOptions options = {
+        .output_dir = output_dir,
+        .format = format,
+        .jobs = jobs,
+        .use_colors = true,
+        .cache = cache,
+    };
+    size_t clash[2];
+    const int clashed = batch_find_target_clash(list, &options, clash);
+    if (clashed != 0) {
+        if (clashed > 0) {
+            fprintf(stderr, "Error: '%s' and '%s' would both be written to the same output file.\n",
+                    list->files[clash[0]].full_path, list->files[clash[1]].full_path);
+        } else {
+            fprintf(stderr, "Error: Unable to resolve output paths.\n");
+        }
+        file_list_free(list);
+        return EXIT_FAILURE;
+    }
+    const size_t failed = assemble_batch(list, &options);
+    file_list_free(list);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Makes 'path' absolute against the current directory, since the server resolves paths itself
+static bool absolute_path(const char *path, char *out, const size_t size) {
+    if (path[0] == '/') return (size_t)snprintf(out, size, "%s", path) < size;
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) return false;
+    return (size_t)snprintf(out, size, "%s/%s", cwd, path) < size;
+}
+
+/**
+ * @brief Assembles one file through a running server.
+ *
+ * @param socket_path  Server socket.
+ * @param required     If true (--connect), failing to reach the server is an error; otherwise
+ *                     the caller falls back to assembling locally.
+ * @param source_file  Source file path.
+ * @param target_file  Target file path.
+ * @param format       Output encoding.
+ * @return EXIT_SUCCESS or EXIT_FAILURE once the server answered (or was required), -1 to assemble locally.
+ */
+int run_client(const char *socket_path, const bool required, const char *source_file, const char *target_file,
+               const OutputFormat format) {
+    char source_path[PATH_MAX];
+    char target_path[PATH_MAX];
+    if (!absolute_path(source_file, source_path, sizeof(source_path)) ||
+        !absolute_path(target_file, target_path, sizeof(target_path))) {
+        fprintf(stderr, "Error: Unable to resolve file paths.\n");
+        return EXIT_FAILURE;
+    }
+
+    const int fd = server_connect(socket_path);
+    if (fd < 0) {
+        if (!required) return -1;
+        fprintf(stderr, "Error: No server listening on '%s'.\n", socket_path);
+        return EXIT_FAILURE;
+    }
+    ServerReply reply;
+    const bool answered = server_assemble_paths(fd, source_path, target_path, format,
+                                                isatty(STDERR_FILENO), &reply);
+    close(fd);
+    if (!answered) {
+        fprintf(stderr, "Error: Lost connection to server '%s'.\n", socket_path);
+        return EXIT_FAILURE;
+    }
+
+    // Same reporting as a local run: the log is only shown on failure
+    if (reply.status != 0) fwrite(reply.log, 1, reply.log_size, stderr);
+    const int status = reply.status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    server_reply_free(&reply);
+    return status;
+}
+
 /**
  * @brief Parses command-line arguments for the hackasm assembler.
  *
  * This function processes the command-line arguments to determine the source
- * assembly file, optional output file, and optional flags such as token printing.
+ * assembly files, optional output file, and optional flags such as the token dump.
  *
  * Supported options:
- *   -o / --output <output_file>    Specify the output file name.
- *   -t / --tokens                  Enable printing of tokens during processing.
+ *   -o / --output <output_file>    Specify the output file name (output directory in batch mode).
+ *   -t / --tokens                  Write the binary token dump tokens.tok (render it with hacktok).
+ *   --format=hack|bin              Select the output encoding (default: hack).
+ *   -j / --jobs <n>                Worker threads for large sources (default: one per CPU).
+ *   --serve <socket>               Run as an assembler server on a Unix domain socket.
+ *   --connect <socket>             Assemble through the server listening on a socket.
+ *   --cache-dir <dir>              Reuse outputs of unchanged sources from a build cache.
+ *   --cache-size <MiB>             Size limit of the build cache.
+ *   --stats[=json]                 Report time per phase, rates and peak memory to stderr (table or JSON).
  *   --                             Stop option parsing; remaining arguments are treated as positional.
  *
  * At minimum, a source file must be specified. The function will exit with
@@ -183,11 +526,21 @@ int main(const int argc, char *argv[]) {
  *
  * @param argc          The argument count.
  * @param argv          The argument vector (array of strings).
- * @param source_file   Pointer to a char* where the source file name will be stored.
+ * @param sources       Array of at least argc pointers receiving the positional arguments.
+ * @param source_count  Pointer to the number of positional arguments stored in 'sources'.
  * @param target_file   Pointer to a char* where the target file name (if any) will be stored.
- * @param print_tokens  Pointer to a bool that will be set true if token printing is enabled.
+ * @param print_tokens  Pointer to a bool set true if -t asks for the tokens.tok dump.
+ * @param format        Pointer to the output format, updated if --format is given.
+ * @param jobs          Pointer to the worker thread count, updated if -j is given.
+ * @param serve_socket  Pointer to a char* receiving the --serve socket path (if any).
+ * @param connect_socket Pointer to a char* receiving the --connect socket path (if any).
+ * @param cache_dir     Pointer to a char* receiving the --cache-dir directory (if any).
+ * @param cache_size    Pointer to the cache size limit in bytes, updated if --cache-size is given.
+ * @param stats         Pointer to the run statistics output, updated if --stats or --stats=json is given.
  */
-void parse_arguments(const int argc, char *argv[], char **source_file, char **target_file, bool *print_tokens) {
+void parse_arguments(const int argc, char *argv[], char **sources, int *source_count, char **target_file,
+                     bool *print_tokens, OutputFormat *format, unsigned *jobs, char **serve_socket,
+                     char **connect_socket, char **cache_dir, uint64_t *cache_size, StatsOutput *stats) {
     int i = 1;
     bool end_of_options = false;
 
@@ -204,32 +557,100 @@ void parse_arguments(const int argc, char *argv[], char **source_file, char **ta
             if (i + 1 < argc) {
                 if (*target_file != NULL) {
                     fprintf(stderr, "Error: Multiple -o options are not allowed.\n");
-                    fprintf(stderr, "Usage: %s [-o output.hack] [-t|--tokens] source.asm\n", argv[0]);
+                    fprintf(stderr, USAGE, argv[0], argv[0]);
                     exit(EXIT_FAILURE);
                 }
                 *target_file = argv[++i];
             } else {
                 fprintf(stderr, "Error: -o requires a target file.\n");
-                fprintf(stderr, "Usage: %s [-o output.hack] [-t|--tokens] source.asm\n", argv[0]);
+                fprintf(stderr, USAGE, argv[0], argv[0]);
                 exit(EXIT_FAILURE);
             }
         } else if (!end_of_options && (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--tokens") == 0)) {
-            // Toggle printing of tokens
+            // Write the token dump (tokens.tok)
             *print_tokens = true;
-        } else if (*source_file == NULL) {
-            // Positional argument: <source_file>
-            *source_file = argv[i];
+        } else if (!end_of_options && (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0)) {
+            // Optional Argument: -j <jobs>
+            char *end = NULL;
+            const long value = (i + 1 < argc) ? strtol(argv[i + 1], &end, 10) : -1;
+            if (i + 1 >= argc || *argv[i + 1] == '\0' || *end != '\0' || value < 0 || value > 1024) {
+                fprintf(stderr, "Error: -j requires a thread count between 0 and 1024.\n");
+                fprintf(stderr, USAGE, argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            *jobs = (unsigned)value;
+            i++;
+        } else if (!end_of_options && (strcmp(argv[i], "--serve") == 0 || strcmp(argv[i], "--connect") == 0)) {
+            // Optional Argument: --serve <socket> or --connect <socket>
+            char **socket_path = argv[i][2] == 's' ? serve_socket : connect_socket;
+            if (i + 1 >= argc || *socket_path != NULL) {
+                fprintf(stderr, "Error: %s requires a single socket path.\n", argv[i]);
+                fprintf(stderr, USAGE, argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            *socket_path = argv[++i];
+        } else if (!end_of_options && strcmp(argv[i], "--cache-dir") == 0) {
+            // Optional Argument: --cache-dir <dir>
+            if (i + 1 >= argc || *cache_dir != NULL) {
+                fprintf(stderr, "Error: --cache-dir requires a single directory.\n");
+                fprintf(stderr, USAGE, argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            *cache_dir = argv[++i];
+        } else if (!end_of_options && strcmp(argv[i], "--cache-size") == 0) {
+            // Optional Argument: --cache-size <MiB>
+            char *end = NULL;
+            const long value = (i + 1 < argc) ? strtol(argv[i + 1], &end, 10) : -1;
+            if (i + 1 >= argc || *argv[i + 1] == '\0' || *end != '\0' || value < 1 || value > 1048576) {
+                fprintf(stderr, "Error: --cache-size requires a size in MiB between 1 and 1048576.\n");
+                fprintf(stderr, USAGE, argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            *cache_size = (uint64_t)value << 20;
+            i++;
+        } else if (!end_of_options && strncmp(argv[i], "--format=", 9) == 0) {
+            // Select output encoding
+            const char *name = argv[i] + 9;
+            if (strcmp(name, "hack") == 0) {
+                *format = OUTPUT_FORMAT_HACK;
+            } else if (strcmp(name, "bin") == 0) {
+                *format = OUTPUT_FORMAT_BIN;
+            } else {
+                fprintf(stderr, "Error: Unknown output format '%s' (expected 'hack' or 'bin').\n", name);
+                fprintf(stderr, USAGE, argv[0], argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (!end_of_options && (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0)) {
+            // Report run statistics as a table
+            *stats = STATS_OUTPUT_TEXT;
+        } else if (!end_of_options && strcmp(argv[i], "--stats=json") == 0) {
+            // Report run statistics as JSON
+            *stats = STATS_OUTPUT_JSON;
+        } else if (end_of_options || argv[i][0] != '-' || argv[i][1] == '\0') {
+            // Positional argument: <source_file> (several select batch mode)
+            sources[(*source_count)++] = argv[i];
         } else {
             fprintf(stderr, "Error: Unrecognized argument '%s'.\n", argv[i]);
-            fprintf(stderr, "Usage: %s [-o output.hack] [-t|--tokens] source.asm\n", argv[0]);
+            fprintf(stderr, USAGE, argv[0], argv[0]);
             exit(EXIT_FAILURE);
         }
         i++;
     }
 
-    if (*source_file == NULL) {
+    if (*serve_socket) {
+        // The server never consults a build cache, so cache options would silently do nothing
+        if (*source_count > 0 || *target_file || *print_tokens || *connect_socket || *stats != STATS_OUTPUT_NONE ||
+            *cache_dir || *cache_size != 0) {
+            fprintf(stderr, "Error: --serve takes no sources and no -o, -t, --connect, --stats, --cache-dir or "
+                            "--cache-size.\n");
+            fprintf(stderr, USAGE, argv[0], argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        return;
+    }
+    if (*source_count == 0) {
         fprintf(stderr, "Error: Source file is required.\n");
-        fprintf(stderr, "Usage: %s [-o output.hack] [-t|--tokens] source.asm\n", argv[0]);
+        fprintf(stderr, USAGE, argv[0], argv[0]);
         exit(EXIT_FAILURE);
     }
 }
@@ -0,0 +1,300 @@
+#include "parallel.h"
+#include "code_generator.h"
+#include <alloc_stats.h>
+#include <stats.h>
+#include <thread_pool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Per-thread state of the first pass over one slice of the source
+typedef struct {
+    const char *source;
+    size_t start;
+    size_t end;
+    StringPool *string_pool;    // Chunk-local interned symbols
+    TokenTable *instructions;   // Chunk-local packed records (symbol ids are local until remapped)
+    SymbolTable *symbol_table;  // Chunk-local labels with chunk-relative addresses
+    StringId *remap;            // Local id -> global id
+    int rom_count;
+    int line_count;
+    ProcessStatus status;
+    ScannedLine error_line;
+} LexChunk;
+
+// Per-thread state of the second pass over one range of records
+typedef struct {
+    const TokenTable *instructions;
+    size_t first_record;
+    size_t end_record;
+    size_t first_instruction;   // Index of the range's first instruction in the output
+    size_t instruction_count;   // Instructions the range must produce
+    char *output;
+    size_t stride;
+    WordWriter write_word;
+    size_t encoded;
+    ProcessStatus status;
+} EncodeRange;
+
+// Context for rebasing one chunk's labels into the global table
+typedef struct {
+    SymbolTable *symbol_table;
+    const StringId *remap;
+    int rom_base;
+} LabelMerge;
+
+unsigned parallel_default_jobs(void) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (unsigned)cpus : 1;
+}
+
+static void lex_chunk(void *arg) {
+    LexChunk *chunk = arg;
+    chunk->status = lex_source_instructions(chunk->source, chunk->start, chunk->end, chunk->instructions,
+                                            chunk->string_pool, chunk->symbol_table, &chunk->rom_count,
+                                            &chunk->line_count, &chunk->error_line);
+}
+
+static void remap_chunk(void *arg) {
+    const LexChunk *chunk = arg;
+    size_t run = 0;
+    for (size_t i = 0; i < token_table_size(chunk->instructions); i += run) {
+        PackedInstruction *records = token_table_span(chunk->instructions, i, &run);
+        for (size_t j = 0; j < run; j++) {
+            const uint32_t kind = PACKED_KIND(records[j]);
+            if (kind == PACKED_SYMBOL || kind == PACKED_LABEL) {
+                records[j] = PACKED_MAKE(kind, chunk->remap[PACKED_PAYLOAD(records[j])]);
+            }
+        }
+    }
+}
+
+// Runs 'work' on 'count' tasks of 'task_size' bytes on the global pool; the calling thread helps while waiting
+static void run_tasks(const TaskFunc work, void *tasks, const size_t task_size, const size_t count) {
+    char *task = tasks;
+    ThreadPool *pool = thread_pool_get_global();
+    TaskGroup *group = pool && count > 1 ? task_group_create(pool) : NULL;
+    for (size_t i = 0; i < count; i++) {
+        // Without a pool (or when a task cannot be queued) the work runs on the calling thread
+        if (!group || !task_group_submit(group, work, task + i * task_size)) work(task + i * task_size);
+    }
+    task_group_join(group);
+}
+
+static bool merge_label(const StringId id, const int address, void *context) {
+    const LabelMerge *merge = context;
+    return symbol_table_lookup_or_insert_id(merge->symbol_table, merge->remap[id],
+                                            merge->rom_base + address, NULL) >= 0;
+}
+
+// Re-interns a chunk's strings in local id order (= order of first appearance) and builds its remap table
+static bool build_remap(LexChunk *chunk, StringPool *string_pool) {
+    const size_t count = string_pool_count(chunk->string_pool);
+    chunk->remap = TRACKED_MALLOC(ALLOC_TAG_LEXER, (count ? count : 1) * sizeof(StringId));
+    if (!chunk->remap) return false;
+    for (size_t id = 0; id < count; id++) {
+        chunk->remap[id] = string_pool_intern(string_pool, string_pool_get(chunk->string_pool, (StringId)id),
+                                              string_pool_length(chunk->string_pool, (StringId)id));
+        if (chunk->remap[id] == STRING_ID_NONE) return false;
+    }
+    return true;
+}
+
+static void free_chunks(LexChunk *chunks, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        symbol_table_free(chunks[i].symbol_table);
+        token_table_free(chunks[i].instructions);
+        string_pool_free(chunks[i].string_pool);
+        TRACKED_FREE(ALLOC_TAG_LEXER, chunks[i].remap);
+    }
+    TRACKED_FREE(ALLOC_TAG_LEXER, chunks);
+}
+
+ProcessStatus parallel_lex_source(const char *source, const size_t size, unsigned jobs, TokenTable *instructions,
+                                  StringPool *string_pool, SymbolTable *symbol_table, int *rom_address,
+                                  int *line_count, ScannedLine *error_line) {
+    if (!source || !instructions || !string_pool || !symbol_table || !rom_address || !line_count || !error_line) {
+        return PROCESS_ERROR;
+    }
+
+    if (jobs == 0) jobs = parallel_default_jobs();
+    size_t count = size / PARALLEL_MIN_CHUNK_SIZE;
+    if (count > jobs) count = jobs;
+    if (count <= 1) {
+        return lex_source_instructions(source, 0, size, instructions, string_pool, symbol_table, rom_address,
+                                       line_count, error_line);
+    }
+
+    LexChunk *chunks = TRACKED_CALLOC(ALLOC_TAG_LEXER, count, sizeof(LexChunk));
+    if (!chunks) return PROCESS_ERROR;
+
+    // Cut at line boundaries so every chunk starts at the beginning of a line
+    size_t start = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t end = size;
+        if (i + 1 < count) {
+            end = size / count * (i + 1);
+            if (end < start) end = start;
+            const char *newline = memchr(source + end, '\n', size - end);
+            end = newline ? (size_t)(newline - source) + 1 : size;
+        }
+        chunks[i].source = source;
+        chunks[i].start = start;
+        chunks[i].end = end;
+        chunks[i].string_pool = string_pool_create();
+        chunks[i].instructions = token_table_create(sizeof(PackedInstruction), NULL, NULL);
+        chunks[i].symbol_table = symbol_table_create(chunks[i].string_pool);
+        if (!chunks[i].string_pool || !chunks[i].instructions || !chunks[i].symbol_table) {
+            free_chunks(chunks, count);
+            return PROCESS_ERROR;
+        }
+        start = end;
+    }
+
+    run_tasks(lex_chunk, chunks, sizeof(LexChunk), count);
+
+    // Merge in source order up to and including the first failing chunk, exactly as a
+    // sequential pass would have left the tables when it stopped
+    size_t merged = 0;
+    int lines = 0;
+    ProcessStatus status = PROCESS_SUCCESS;
+    while (merged < count && status == PROCESS_SUCCESS) {
+        LexChunk *chunk = &chunks[merged++];
+        if (!build_remap(chunk, string_pool)) {
+            status = PROCESS_ERROR;
+            break;
+        }
+        LabelMerge merge = {.symbol_table = symbol_table, .remap = chunk->remap, .rom_base = *rom_address};
+        if (!symbol_table_for_each(chunk->symbol_table, merge_label, &merge)) {
+            status = PROCESS_ERROR;
+            break;
+        }
+        *rom_address += chunk->rom_count;
+        if (chunk->status != PROCESS_SUCCESS) {
+            status = chunk->status;
+            *error_line = chunk->error_line;
+        }
+        lines += chunk->line_count;
+    }
+    *line_count = lines;
+
+    // Rewrite local symbol ids in parallel, then append the records in order
+    if (status != PROCESS_ERROR) {
+        run_tasks(remap_chunk, chunks, sizeof(LexChunk), merged);
+        for (size_t i = 0; i < merged; i++) {
+            if (!token_table_splice(instructions, chunks[i].instructions)) {
+                status = PROCESS_ERROR;
+                break;
+            }
+        }
+    }
+
+    free_chunks(chunks, count);
+    return status;
+}
+
+static void encode_range(void *arg) {
+    EncodeRange *range = arg;
+    char *destination = range->output + range->first_instruction * range->stride;
+    size_t run = 0;
+    for (size_t i = range->first_record; i < range->end_record; i += run) {
+        const PackedInstruction *records = token_table_span(range->instructions, i, &run);
+        if (run > range->end_record - i) run = range->end_record - i;
+
+        // Every symbol was resolved by the sequential scan: only final words and labels remain
+        for (size_t j = 0; j < run; j++) {
+            const PackedInstruction record = records[j];
+            if (PACKED_KIND(record) == PACKED_LABEL) continue;
+            if (PACKED_KIND(record) != PACKED_WORD || range->encoded == range->instruction_count) {
+                range->status = PROCESS_INVALID;  // Disagrees with the scan; never write past the range
+                return;
+            }
+            range->write_word(PACKED_WORD_VALUE(record), destination);
+            destination += range->stride;
+            range->encoded++;
+        }
+    }
+    range->status = PROCESS_SUCCESS;
+}
+
+ProcessStatus parallel_encode(TokenTable *instructions, SymbolTable *symbol_table, unsigned jobs,
+                              int *ram_address, char *output, const size_t stride, const size_t capacity,
+                              const WordWriter write_word, size_t *count) {
+    if (!instructions || !symbol_table || !ram_address || !output || !write_word || !count) return PROCESS_ERROR;
+    *count = 0;
+
+    if (jobs == 0) jobs = parallel_default_jobs();
+    const size_t records = token_table_size(instructions);
+    size_t workers = records / PARALLEL_MIN_ENCODE_RECORDS;
+    if (workers > jobs) workers = jobs;
+    if (workers == 0) workers = 1;
+
+    EncodeRange *ranges = calloc(workers, sizeof(EncodeRange));
+    if (!ranges) return PROCESS_ERROR;
+
+    // Sequential scan: allocate variables in first-use order, turning each symbol record into its
+    // final word, and cut the records into ranges
+    STATS_BEGIN(resolve_mark);
+    size_t used = 1;
+    size_t instruction_count = 0;
+    size_t next_cut = records / workers;
+    size_t run = 0;
+    ProcessStatus status = PROCESS_SUCCESS;
+    for (size_t i = 0; i < records && status == PROCESS_SUCCESS; i += run) {
+        PackedInstruction *span = token_table_span(instructions, i, &run);
+        for (size_t j = 0; j < run; j++) {
+            if (used < workers && i + j >= next_cut) {
+                ranges[used - 1].end_record = i + j;
+                ranges[used].first_record = i + j;
+                ranges[used].first_instruction = instruction_count;
+                used++;
+                next_cut = records / workers * used;
+            }
+            const uint32_t kind = PACKED_KIND(span[j]);
+            if (kind == PACKED_LABEL) continue;
+            if (kind == PACKED_SYMBOL) {
+                bool inserted = false;
+                const int address = symbol_table_lookup_or_insert_id(symbol_table, PACKED_PAYLOAD(span[j]),
+                                                                     *ram_address, &inserted);
+                if (address < 0) {
+                    status = PROCESS_ERROR;
+                    break;
+                }
+                if (inserted) (*ram_address)++;
+                span[j] = PACKED_MAKE(PACKED_WORD, encode_address(address));
+            }
+            instruction_count++;
+        }
+    }
+    ranges[used - 1].end_record = records;
+    if (status == PROCESS_SUCCESS && instruction_count > capacity) status = PROCESS_ERROR;
+    STATS_END("parse", resolve_mark);
+
+    for (size_t i = 0; status == PROCESS_SUCCESS && i < used; i++) {
+        EncodeRange *range = &ranges[i];
+        range->instructions = instructions;
+        range->instruction_count = (i + 1 < used ? ranges[i + 1].first_instruction : instruction_count) -
+                                   range->first_instruction;
+        range->output = output;
+        range->stride = stride;
+        range->write_word = write_word;
+    }
+
+    if (status == PROCESS_SUCCESS) {
+        STATS_BEGIN(encode_mark);
+        run_tasks(encode_range, ranges, sizeof(EncodeRange), used);
+        STATS_END("codegen", encode_mark);
+
+        // Output is valid up to the first range that stopped early
+        for (size_t i = 0; i < used; i++) {
+            *count += ranges[i].encoded;
+            if (ranges[i].status != PROCESS_SUCCESS || ranges[i].encoded != ranges[i].instruction_count) {
+                status = ranges[i].status != PROCESS_SUCCESS ? ranges[i].status : PROCESS_INVALID;
+                break;
+            }
+        }
+    }
+
+    free(ranges);
+    return status;
+}
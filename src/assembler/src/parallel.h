@@ -0,0 +1,78 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "lexer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Smallest slice of source worth handing to its own worker thread
+#define PARALLEL_MIN_CHUNK_SIZE ((size_t)256 * 1024)
+
+// Smallest number of instruction records worth encoding on its own worker thread
+#define PARALLEL_MIN_ENCODE_RECORDS ((size_t)16 * 1024)
+
+// Writes one encoded machine word at 'destination' (a fixed-size slot in the output image)
+typedef void (*WordWriter)(uint16_t word, char *destination);
+
+/**
+ * @brief Returns the number of worker threads to use when none is requested (one per online CPU).
+ */
+unsigned parallel_default_jobs(void);
+
+/**
+ * @brief First pass over a whole source buffer, split across worker threads.
+ *
+ * The source is cut at line boundaries into up to 'jobs' chunks of at least
+ * PARALLEL_MIN_CHUNK_SIZE bytes. Each chunk is lexed on its own thread into a private
+ * StringPool, packed instruction table and label SymbolTable with chunk-relative ROM addresses, and
+ * records its instruction and line counts. A prefix sum over those counts then rebases
+ * the labels into 'symbol_table' (first definition wins, in source order), local string ids
+ * are re-interned into 'string_pool' in source order, and the records are rewritten and
+ * appended to 'instructions'. The result is identical to lex_source_instructions().
+ *
+ * Small inputs, or jobs <= 1, are lexed sequentially with lex_source_instructions().
+ *
+ * @param source       Source buffer (read-only).
+ * @param size         Size of the source in bytes.
+ * @param jobs         Maximum number of threads (0 selects parallel_default_jobs()).
+ * @param instructions Table receiving all packed records (PackedInstruction) in source order.
+ * @param string_pool  StringPool receiving all symbols.
+ * @param symbol_table SymbolTable receiving all labels.
+ * @param rom_address  ROM address counter, advanced by the number of instructions.
+ * @param line_count   Output: as for lex_source(), counted from the start of the source.
+ * @param error_line   Output: the first failing line in source order (only written on failure).
+ *
+ * @return PROCESS_SUCCESS, or the status of the first failing line in source order.
+ */
+ProcessStatus parallel_lex_source(const char *source, size_t size, unsigned jobs, TokenTable *instructions,
+                                  StringPool *string_pool, SymbolTable *symbol_table, int *rom_address,
+                                  int *line_count, ScannedLine *error_line);
+
+/**
+ * @brief Second pass: resolves variables, then encodes every instruction into a fixed-stride image.
+ *
+ * A sequential scan over the records allocates RAM addresses to new variables in first-use
+ * order (exactly as a one-pass code generator would), rewrites every PACKED_SYMBOL record in
+ * place as the final word, and cuts the records into up to 'jobs' ranges, recording each range's
+ * first instruction index. Worker threads then sweep their ranges independently, copying words
+ * out (labels produce no output), instruction i being written by 'write_word'
+ * at output + i * stride, so the image needs no assembly afterwards.
+ *
+ * @param instructions Packed records produced by the first pass (symbol records are resolved in place).
+ * @param symbol_table Symbol table holding the labels; variables are added to it.
+ * @param jobs         Maximum number of threads (0 selects parallel_default_jobs()).
+ * @param ram_address  Next free RAM address for variables, advanced for each new variable.
+ * @param output       Image with room for 'capacity' slots of 'stride' bytes.
+ * @param stride       Bytes per instruction slot.
+ * @param capacity     Number of slots in 'output'.
+ * @param write_word   Encoder for one slot.
+ * @param count        Output: number of leading slots written (all of them on success).
+ *
+ * @return PROCESS_SUCCESS; PROCESS_INVALID if a record is malformed; PROCESS_ERROR on
+ *         allocation failure or if the program needs more than 'capacity' slots.
+ */
+ProcessStatus parallel_encode(TokenTable *instructions, SymbolTable *symbol_table, unsigned jobs,
+                              int *ram_address, char *output, size_t stride, size_t capacity, WordWriter write_word,
+                              size_t *count);
+
+#endif // PARALLEL_H
@@ -1,6 +1,7 @@
 
 #include "parser.h"
 #include "token.h"
+#include <stdint.h>
 #include <stdlib.h>
 
 #define MAX_TOKENS_PER_INSTRUCTION 10
@@ -22,11 +23,28 @@ Parser *parser_create(TokenTable *token_table, SymbolTable *symbol_table) {
     parser->token_table = token_table;
     parser->symbol_table = symbol_table;
     parser->instruction = malloc(sizeof(Instruction));
-    if (!parser->instruction) return NULL;
+    if (!parser->instruction) {
+        free(parser);
+        return NULL;
+    }
+    parser_set_range(parser, 0, SIZE_MAX);
 
     return parser;
 }
 
+void parser_set_range(Parser *parser, const size_t first, const size_t end) {
+    if (!parser) return;
+    parser->position = first;
+    parser->end = end;
+}
+
+// Returns the token 'offset' places after the current position, or NULL past the end of the range
+static Token *peek_token(const Parser *parser, const size_t offset) {
+    const size_t index = parser->position + offset;
+    if (index >= parser->end) return NULL;
+    return token_table_get(parser->token_table, index);
+}
+
 void parser_free(Parser *parser) {
     if (!parser) return;
     free(parser->instruction);
@@ -34,7 +52,7 @@ void parser_free(Parser *parser) {
 }
 
 bool parser_has_more_commands(Parser *parser) {
-    if (!parser || !parser->token_table || !token_table_peek(parser->token_table)) {
+    if (!parser || !parser->token_table || !peek_token(parser, 0)) {
         return false;
     }
     return true;
@@ -43,33 +61,27 @@ bool parser_has_more_commands(Parser *parser) {
 bool advance(Parser *parser) {
     if (!parser) return false;
 
-    // Read tokens into buffer until newline token or NULL:
+    // Peek ahead up to the newline token; the records stay in place in the table
     Token *tokens[MAX_TOKENS_PER_INSTRUCTION] = {0};
-    int token_count = 0;
+    size_t token_count = 0;
     do {
         if (token_count == MAX_TOKENS_PER_INSTRUCTION) return false;
 
-        tokens[token_count++] = token_table_next(parser->token_table);
-    } while (!tokens[token_count - 1] || tokens[token_count - 1]->type != NEWLINE);
-
-    // Parse L-instruction:
-    if (parse_l_instruction(parser, tokens)) {
-        //print_l_instruction(parser->instruction);
-        return true;
-    }
-
-    // Parse A-instruction:
-    if (parse_a_instruction(parser, tokens)) {
-        //print_a_instruction(parser->instruction);
-        return true;
+        tokens[token_count] = peek_token(parser, token_count);
+        if (!tokens[token_count]) return false;  // Token stream ended without a newline
+        token_count++;
+    } while (tokens[token_count - 1]->type != NEWLINE);
+    parser->position += token_count;
+
+    // The first token decides the form, so each line is parsed once
+    switch (tokens[0]->type) {
+        case TOKEN_LPAREN:
+            return parse_l_instruction(parser, tokens);
+        case TOKEN_AT:
+            return parse_a_instruction(parser, tokens);
+        default:
+            return parse_c_instruction(parser, tokens);
     }
-
-    if (parse_c_instruction(parser, tokens)) {
-        //print_c_instruction(parser->instruction);
-        return true;
-    }
-
-    return false;
 }
 
 bool parse_l_instruction(Parser *parser, Token *tokens[MAX_TOKENS_PER_INSTRUCTION]) {
@@ -136,14 +148,14 @@ bool parse_c_instruction(Parser *parser, Token *tokens[MAX_TOKENS_PER_INSTRUCTIO
 // Function to print L-instruction
 void print_l_instruction(const Instruction *instruction) {
     if (instruction->type == L_INSTRUCTION) {
-        printf("(L-INST) Symbol: %s\n", instruction->symbol);
+        printf("(L-INST) Symbol: #%u\n", instruction->symbol);
     }
 }
 
 // Function to print A-instruction
 void print_a_instruction(const Instruction *instruction) {
     if (instruction->type == A_INSTRUCTION_SYMBOL) {
-        printf("(A-INST) Symbolic: @%s\n", instruction->symbol);
+        printf("(A-INST) Symbolic: @#%u\n", instruction->symbol);
     }
     else {
         printf("(A-INST) Numeric: @%d\n", instruction->value);
@@ -2,17 +2,27 @@
 #define PARSER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "symbol_table.h"
 #include "instruction.h"
 #include <token_table.h>
 
 /**
  * Parser structure encapsulating the token table, symbol table, and current instruction.
+ *
+ * The parser turns a token stream (see lex_source()) back into instructions, one line at a
+ * time. The assembler itself does not need it: its front end lexes straight into Instruction
+ * records (see lex_source_instructions()).
+ *
+ * The parser keeps its own position in the token table instead of using the table's
+ * iterator, so several parsers can walk disjoint ranges of one table concurrently.
  */
 typedef struct {
     TokenTable *token_table;
     SymbolTable *symbol_table;
     Instruction *instruction;
+    size_t position;  // Index of the next token to parse
+    size_t end;       // One past the last token to parse (clamped to the table size)
 } Parser;
 
 /**
@@ -24,6 +34,18 @@ typedef struct {
  */
 Parser *parser_create(TokenTable *token_table, SymbolTable *symbol_table);
 
+/**
+ * Restricts the parser to the tokens [first, end) of its table.
+ *
+ * 'first' must be the first token of an instruction (i.e. follow a NEWLINE token).
+ * Passing SIZE_MAX as 'end' parses to the end of the table, however large it grows.
+ *
+ * @param parser Pointer to the Parser instance.
+ * @param first Index of the first token to parse.
+ * @param end One past the index of the last token to parse.
+ */
+void parser_set_range(Parser *parser, size_t first, size_t end);
+
 /**
  * Frees the Parser instance and any resources it owns.
  *
@@ -34,7 +56,7 @@ void parser_free(Parser *parser);
 /**
  * Checks if there are more commands (instructions) to process in the token stream.
  *
- * Internally peeks ahead in the token table to determine if any tokens remain.
+ * Checks whether any tokens remain in the parser's range.
  *
  * @param parser Pointer to the Parser instance.
  * @return true if more commands exist, false otherwise.
@@ -45,7 +67,8 @@ bool parser_has_more_commands(Parser *parser);
  * Advances the parser to the next instruction.
  *
  * Reads tokens into an internal buffer, using newline tokens as instruction delimiters.
- * Parses the buffered tokens to fill the Instruction struct, preparing it for code generation.
+ * The first token selects the instruction form, and the buffered tokens fill the Instruction
+ * struct, preparing it for code generation.
  *
  * @param parser Pointer to the Parser instance.
  * @return true if the next instruction was successfully parsed, false if no more instructions exist.
@@ -0,0 +1,386 @@
+#include "server.h"
+#include <errno.h>
+#include <limits.h>
+#include <logger.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread_pool.h>
+#include <unistd.h>
+
+#define ACCEPT_POLL_MS 100   // How often the accept loop checks for a stop request
+
+// A warm assembler and the memory logger its requests log into
+typedef struct {
+    Assembler *assembler;
+    Logger *logger;
+} Instance;
+
+typedef struct {
+    int listen_fd;
+    atomic_bool stopping;
+    pthread_mutex_t lock;      // Protects the idle stack
+    Instance *idle;
+    size_t idle_count;
+    size_t idle_capacity;
+} Server;
+
+typedef struct {
+    Server *server;
+    int fd;
+} Connection;
+
+static volatile sig_atomic_t stop_signal = 0;
+
+static void on_stop_signal(const int signal_number) {
+    (void)signal_number;
+    stop_signal = 1;
+}
+
+static bool read_all(const int fd, void *data, size_t size) {
+    char *cursor = data;
+    while (size > 0) {
+        const ssize_t n = read(fd, cursor, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        cursor += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool write_all(const int fd, const void *data, size_t size) {
+    const char *cursor = data;
+    while (size > 0) {
+        const ssize_t n = send(fd, cursor, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        cursor += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool fill_address(struct sockaddr_un *address, const char *socket_path) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address->sun_path)) return false;
+    strcpy(address->sun_path, socket_path);
+    return true;
+}
+
+// Pops an idle instance and points it at 'config', or creates a new one; its log is colored as asked
+static Instance acquire_instance(Server *server, const AssemblerConfig *config, const bool use_colors) {
+    Instance instance = {0};
+    pthread_mutex_lock(&server->lock);
+    if (server->idle_count > 0) instance = server->idle[--server->idle_count];
+    pthread_mutex_unlock(&server->lock);
+
+    if (instance.assembler && !assembler_reset(instance.assembler, config)) {
+        assembler_free(instance.assembler);
+        instance.assembler = NULL;
+    }
+    if (!instance.assembler) instance.assembler = assembler_create(config);
+    if (!instance.logger) instance.logger = logger_create(NULL, LOG_INFO, use_colors);
+    if (!instance.assembler || !instance.logger) {
+        assembler_free(instance.assembler);
+        logger_free(instance.logger);
+        return (Instance){0};
+    }
+    logger_clear(instance.logger);
+    instance.logger->use_colors = use_colors;
+    return instance;
+}
+
+// Returns an instance to the idle stack, or frees it if the stack is full
+static void release_instance(Server *server, const Instance instance) {
+    pthread_mutex_lock(&server->lock);
+    const bool kept = server->idle_count < server->idle_capacity;
+    if (kept) server->idle[server->idle_count++] = instance;
+    pthread_mutex_unlock(&server->lock);
+    if (!kept) {
+        assembler_free(instance.assembler);
+        logger_free(instance.logger);
+    }
+}
+
+static bool send_response(const int fd, const uint32_t status, const char *output, const size_t output_size,
+                          const char *log, const size_t log_size) {
+    const ServerResponse response = {
+        .magic = SERVER_MAGIC,
+        .status = status,
+        .output_size = (uint32_t)output_size,
+        .log_size = (uint32_t)log_size,
+    };
+    return write_all(fd, &response, sizeof(response)) && write_all(fd, output, output_size) &&
+           write_all(fd, log, log_size);
+}
+
+// Runs one assemble request on a warm instance and sends the response
+static bool handle_assemble(Server *server, const int fd, const ServerRequest *request, char *first,
+                            char *second) {
+    const bool inline_source = request->kind == SERVER_ASSEMBLE_INLINE;
+    const OutputFormat format = request->format == OUTPUT_FORMAT_BIN ? OUTPUT_FORMAT_BIN : OUTPUT_FORMAT_HACK;
+    char *output = NULL;
+    size_t output_size = 0;
+    FILE *source = inline_source ? fmemopen(second, request->lengths[1], "r") : fopen(first, "r");
+    FILE *target = inline_source ? open_memstream(&output, &output_size)
+                                 : fopen(second, format == OUTPUT_FORMAT_BIN ? "wb" : "w");
+
+    char error[PATH_MAX + 64] = "";
+    uint32_t status = 1;
+    if (!source || !target) {
+        snprintf(error, sizeof(error), "Failed to open %s file '%s': %s\n", source ? "target" : "source",
+                 source ? second : first, strerror(errno));
+    } else {
+        const AssemblerConfig config = {
+            .source_asm = source,
+            .source_filepath = first,
+            .target_hack = target,
+            .target_filepath = inline_source ? "<response>" : second,
+            .format = format,
+        };
+        const Instance instance = acquire_instance(server, &config, request->flags & SERVER_FLAG_COLORS);
+        if (instance.assembler) {
+            logger_set_thread(instance.logger);
+            status = (uint32_t)assembler_assemble(instance.assembler);
+            logger_set_thread(NULL);
+        } else {
+            snprintf(error, sizeof(error), "Failed to initialise assembler.\n");
+        }
+        if (fclose(target) != 0) status = 1;
+        target = NULL;
+
+        bool sent;
+        if (instance.logger) {
+            size_t log_size;
+            const char *log = logger_contents(instance.logger, &log_size, NULL);
+            sent = send_response(fd, status, output, inline_source ? output_size : 0, log, log_size);
+            release_instance(server, instance);
+        } else {
+            sent = send_response(fd, status, NULL, 0, error, strlen(error));
+        }
+        fclose(source);
+        free(output);
+        return sent;
+    }
+
+    if (source) fclose(source);
+    if (target) fclose(target);
+    free(output);
+    return send_response(fd, status, NULL, 0, error, strlen(error));
+}
+
+// Pool task: serves the requests of one connection until it closes, idles out or the server stops
+static void handle_connection(void *arg) {
+    Connection *connection = arg;
+    Server *server = connection->server;
+    const int fd = connection->fd;
+    free(connection);
+
+    ServerRequest request;
+    while (!atomic_load(&server->stopping) && read_all(fd, &request, sizeof(request))) {
+        if (request.magic != SERVER_MAGIC) break;
+        const uint64_t payload = (uint64_t)request.lengths[0] + request.lengths[1];
+        if (payload > SERVER_MAX_PAYLOAD) break;
+
+        if (request.kind == SERVER_SHUTDOWN) {
+            atomic_store(&server->stopping, true);
+            send_response(fd, 0, NULL, 0, NULL, 0);
+            break;
+        }
+        if (request.kind != SERVER_ASSEMBLE_PATHS && request.kind != SERVER_ASSEMBLE_INLINE) break;
+
+        // Both fields are null-terminated in place so they can be used as C strings
+        char *data = malloc(payload + 2);
+        if (!data) break;
+        char *first = data;
+        char *second = data + request.lengths[0] + 1;
+        const bool received = read_all(fd, first, request.lengths[0]) && read_all(fd, second, request.lengths[1]);
+        first[request.lengths[0]] = '\0';
+        second[request.lengths[1]] = '\0';
+        const bool answered = received && handle_assemble(server, fd, &request, first, second);
+        free(data);
+        if (!answered) break;
+    }
+    close(fd);
+}
+
+static int open_listener(const char *socket_path) {
+    struct sockaddr_un address;
+    if (!fill_address(&address, socket_path)) {
+        fprintf(stderr, "Error: Socket path '%s' is too long.\n", socket_path);
+        return -1;
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Unable to create socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    bool bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    if (!bound && errno == EADDRINUSE) {
+        // Replace the socket file only if nothing answers on it
+        const int probe = server_connect(socket_path);
+        struct stat info;
+        if (probe >= 0) {
+            close(probe);
+        } else if (lstat(socket_path, &info) == 0 && S_ISSOCK(info.st_mode) && unlink(socket_path) == 0) {
+            bound = bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+        }
+        if (!bound && probe >= 0) errno = EADDRINUSE;
+    }
+    if (!bound || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error: Unable to listen on '%s': %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int server_run(const char *socket_path, const unsigned instances) {
+    if (!socket_path) return EXIT_FAILURE;
+
+    ThreadPool *pool = thread_pool_get_global();
+    Server server = {
+        .idle_capacity = instances ? instances : (pool ? thread_pool_size(pool) : 1),
+    };
+    atomic_init(&server.stopping, false);
+    server.idle = calloc(server.idle_capacity, sizeof(Instance));
+    if (!server.idle) {
+        fprintf(stderr, "Error: out of memory.\n");
+        return EXIT_FAILURE;
+    }
+    server.listen_fd = open_listener(socket_path);
+    if (server.listen_fd < 0) {
+        free(server.idle);
+        return EXIT_FAILURE;
+    }
+    pthread_mutex_init(&server.lock, NULL);
+
+    // No SA_RESTART: a signal only needs to be noticed by the next poll timeout
+    struct sigaction action = {.sa_handler = on_stop_signal};
+    struct sigaction previous_int, previous_term;
+    sigemptyset(&action.sa_mask);
+    stop_signal = 0;
+    sigaction(SIGINT, &action, &previous_int);
+    sigaction(SIGTERM, &action, &previous_term);
+
+    printf("Serving on %s\n", socket_path);
+    fflush(stdout);
+
+    TaskGroup *group = pool ? task_group_create(pool) : NULL;
+    struct pollfd listener = {.fd = server.listen_fd, .events = POLLIN};
+    while (!stop_signal && !atomic_load(&server.stopping)) {
+        if (poll(&listener, 1, ACCEPT_POLL_MS) <= 0) continue;
+        const int fd = accept4(server.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        const struct timeval timeout = {.tv_sec = SERVER_IDLE_TIMEOUT};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        Connection *connection = malloc(sizeof(Connection));
+        if (!connection) {
+            close(fd);
+            continue;
+        }
+        *connection = (Connection){.server = &server, .fd = fd};
+        if (!group || !task_group_submit(group, handle_connection, connection)) handle_connection(connection);
+    }
+
+    // Let open connections finish their current request before tearing down
+    atomic_store(&server.stopping, true);
+    close(server.listen_fd);
+    unlink(socket_path);
+    task_group_join(group);
+    sigaction(SIGINT, &previous_int, NULL);
+    sigaction(SIGTERM, &previous_term, NULL);
+
+    for (size_t i = 0; i < server.idle_count; i++) {
+        assembler_free(server.idle[i].assembler);
+        logger_free(server.idle[i].logger);
+    }
+    free(server.idle);
+    pthread_mutex_destroy(&server.lock);
+    return EXIT_SUCCESS;
+}
+
+int server_connect(const char *socket_path) {
+    struct sockaddr_un address;
+    if (!socket_path || !fill_address(&address, socket_path)) return -1;
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends one request and reads its response into 'reply'
+static bool exchange(const int fd, const ServerRequestKind kind, const OutputFormat format, const uint32_t flags,
+                     const char *first, const size_t first_size, const char *second, const size_t second_size,
+                     ServerReply *reply) {
+    if (!reply || (uint64_t)first_size + second_size > SERVER_MAX_PAYLOAD) return false;
+    memset(reply, 0, sizeof(*reply));
+
+    const ServerRequest request = {
+        .magic = SERVER_MAGIC,
+        .kind = (uint32_t)kind,
+        .format = (uint32_t)format,
+        .flags = flags,
+        .lengths = {(uint32_t)first_size, (uint32_t)second_size},
+    };
+    ServerResponse response;
+    if (!write_all(fd, &request, sizeof(request)) || !write_all(fd, first, first_size) ||
+        !write_all(fd, second, second_size) || !read_all(fd, &response, sizeof(response)) ||
+        response.magic != SERVER_MAGIC) {
+        return false;
+    }
+
+    reply->status = (int)response.status;
+    reply->output_size = response.output_size;
+    reply->log_size = response.log_size;
+    reply->output = response.output_size ? malloc(response.output_size) : NULL;
+    reply->log = response.log_size ? malloc(response.log_size) : NULL;
+    if ((response.output_size && !reply->output) || (response.log_size && !reply->log) ||
+        !read_all(fd, reply->output, reply->output_size) || !read_all(fd, reply->log, reply->log_size)) {
+        server_reply_free(reply);
+        return false;
+    }
+    return true;
+}
+
+bool server_assemble_paths(const int fd, const char *source_path, const char *target_path, const OutputFormat format,
+                           const bool use_colors, ServerReply *reply) {
+    if (!source_path || !target_path) return false;
+    return exchange(fd, SERVER_ASSEMBLE_PATHS, format, use_colors ? SERVER_FLAG_COLORS : 0, source_path, strlen(source_path), target_path,
+                    strlen(target_path), reply);
+}
+
+bool server_assemble_buffer(const int fd, const char *name, const char *source, const size_t size,
+                            const OutputFormat format, const bool use_colors, ServerReply *reply) {
+    if (!name || (!source && size > 0)) return false;
+    return exchange(fd, SERVER_ASSEMBLE_INLINE, format, use_colors ? SERVER_FLAG_COLORS : 0, name, strlen(name), source, size, reply);
+}
+
+bool server_shutdown(const int fd) {
+    ServerReply reply;
+    const bool acknowledged = exchange(fd, SERVER_SHUTDOWN, OUTPUT_FORMAT_HACK, 0, NULL, 0, NULL, 0, &reply);
+    if (acknowledged) server_reply_free(&reply);
+    return acknowledged;
+}
+
+void server_reply_free(ServerReply *reply) {
+    if (!reply) return;
+    free(reply->output);
+    free(reply->log);
+    reply->output = reply->log = NULL;
+    reply->output_size = reply->log_size = 0;
+}
@@ -0,0 +1,127 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <assembler.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Wire protocol of `hackasm --serve` (Unix domain socket, host byte order).
+ *
+ * A connection carries any number of request/response pairs:
+ *
+ *   request   ServerRequest, then lengths[0] + lengths[1] payload bytes
+ *   response  ServerResponse, then output_size output bytes, then log_size log bytes
+ *
+ * Payloads by request kind:
+ *   SERVER_ASSEMBLE_PATHS   source path, target path  (the server reads and writes the files)
+ *   SERVER_ASSEMBLE_INLINE  source name, source text  (the output image comes back in the response)
+ *   SERVER_SHUTDOWN         none                      (the server stops after answering)
+ *
+ * Paths are resolved by the server, so clients should send absolute paths. The log holds
+ * the messages the assembler logged for the request (normally only errors), with ANSI colors
+ * only if the request sets SERVER_FLAG_COLORS.
+ */
+#define SERVER_MAGIC 0x4D534148u           // "HASM"
+#define SERVER_MAX_PAYLOAD (256u << 20)    // Largest accepted lengths[0] + lengths[1]
+#define SERVER_IDLE_TIMEOUT 5              // Seconds an idle connection is kept open
+
+#define SERVER_FLAG_COLORS 1u              // Color the log (the client shows it on a terminal)
+
+typedef enum {
+    SERVER_ASSEMBLE_PATHS = 1,
+    SERVER_ASSEMBLE_INLINE = 2,
+    SERVER_SHUTDOWN = 3,
+} ServerRequestKind;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t kind;        // ServerRequestKind
+    uint32_t format;      // OutputFormat
+    uint32_t flags;       // SERVER_FLAG_*
+    uint32_t lengths[2];  // Payload field sizes (see above)
+} ServerRequest;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t status;       // 0 on success, as returned by assembler_assemble()
+    uint32_t output_size;  // Output image bytes that follow (inline requests only)
+    uint32_t log_size;     // Log bytes that follow the output
+} ServerResponse;
+
+// Result of one request, as seen by a client
+typedef struct {
+    int status;            // 0 on success
+    char *output;          // Output image (inline requests), or NULL
+    size_t output_size;
+    char *log;             // Log of the request, or NULL if empty
+    size_t log_size;
+} ServerReply;
+
+/**
+ * @brief Serves assemble requests on a Unix domain socket until shut down.
+ *
+ * Connections are handled as tasks on the global thread pool (inline if there is none).
+ * Each request runs on a warm Assembler taken from a pool of idle instances and returned
+ * to it afterwards with assembler_reset(), so tables and predefined symbols are built once.
+ * A stale socket file left by a previous server is replaced. SIGINT, SIGTERM or a
+ * SERVER_SHUTDOWN request stop the server, which then removes the socket file.
+ *
+ * @param socket_path Filesystem path of the socket.
+ * @param instances Maximum number of idle Assembler instances kept warm (0 = pool size).
+ * @return EXIT_SUCCESS after a clean shutdown, EXIT_FAILURE if the socket could not be set up.
+ */
+int server_run(const char *socket_path, unsigned instances);
+
+/**
+ * @brief Connects to a server.
+ *
+ * @param socket_path Filesystem path of the socket.
+ * @return Connected descriptor (close with close()), or -1 if no server is listening.
+ */
+int server_connect(const char *socket_path);
+
+/**
+ * @brief Asks the server to assemble a file into another file.
+ *
+ * @param fd Connected descriptor.
+ * @param source_path Source file path, as seen by the server.
+ * @param target_path Target file path, as seen by the server.
+ * @param format Output encoding.
+ * @param use_colors Color the returned log (e.g. isatty(STDERR_FILENO) where the client prints it).
+ * @param reply Receives the result (free with server_reply_free).
+ * @return true if a reply was received, false on a connection or protocol error.
+ */
+bool server_assemble_paths(int fd, const char *source_path, const char *target_path, OutputFormat format,
+                           bool use_colors, ServerReply *reply);
+
+/**
+ * @brief Asks the server to assemble a source held in memory.
+ *
+ * @param fd Connected descriptor.
+ * @param name Name used for the source in log messages.
+ * @param source Source text.
+ * @param size Source size in bytes.
+ * @param format Output encoding.
+ * @param use_colors Color the returned log.
+ * @param reply Receives the result and the output image (free with server_reply_free).
+ * @return true if a reply was received, false on a connection or protocol error.
+ */
+bool server_assemble_buffer(int fd, const char *name, const char *source, size_t size, OutputFormat format,
+                            bool use_colors, ServerReply *reply);
+
+/**
+ * @brief Asks the server to stop once its open connections are done.
+ *
+ * @param fd Connected descriptor.
+ * @return true if the server acknowledged the request.
+ */
+bool server_shutdown(int fd);
+
+/**
+ * @brief Frees the buffers of a reply.
+ */
+void server_reply_free(ServerReply *reply);
+
+#endif // SERVER_H
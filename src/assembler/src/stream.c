@@ -0,0 +1,431 @@
+#include "stream.h"
+#include "code_generator.h"
+#include "parallel.h"
+#include "token_dump.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <logger.h>
+#include <stats.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PENDING_END UINT32_MAX
+#define COPY_CHUNK_SIZE 65536
+
+// Instructions waiting for their symbol, in output order, chained per symbol
+typedef struct {
+    uint64_t *slots;      // Instruction index of each pending use
+    StringId *ids;        // Symbol of each use (STRING_ID_NONE once resolved)
+    uint32_t *next;       // Next pending use of the same symbol
+    size_t count;
+    size_t capacity;
+    size_t unresolved;
+    uint32_t *heads;      // Most recent pending use per StringId
+    size_t head_count;
+} Pending;
+
+// Where encoded instructions go: a window in memory, then the target or the spool file
+typedef struct {
+    int fd;                 // Target descriptor
+    off_t base;             // Target offset of the first byte written
+    bool seekable;          // Placeholders can be patched in the target itself
+    bool packed;            // OUTPUT_FORMAT_BIN: spooled whole behind a header
+    size_t stride;          // Bytes per instruction
+    WordWriter write_word;
+    char *window;
+    uint64_t window_base;   // Index of the first instruction in the window
+    size_t window_count;
+    FILE *spool;            // Unlinked temporary file (created on first use)
+    bool spooling;          // Output currently goes to the spool instead of the target
+    uint64_t spool_base;    // Index of the first instruction in the spool
+    size_t spool_header;    // Bytes reserved in front of the spooled instructions
+} Sink;
+
+static void write_hack_line(const uint16_t word, char *destination) {
+    word_to_ascii(word, destination);
+    destination[HACK_LINE_LENGTH - 1] = '\n';
+}
+
+static void write_rom_word(const uint16_t word, char *destination) {
+    destination[0] = (char)(word & 0xFF);
+    destination[1] = (char)(word >> 8);
+}
+
+static bool write_all(const int fd, const char *data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool pwrite_all(const int fd, const char *data, size_t size, off_t offset) {
+    while (size > 0) {
+        const ssize_t n = pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool sink_init(Sink *sink, FILE *target, const OutputFormat format) {
+    memset(sink, 0, sizeof(*sink));
+    if (fflush(target) != 0) return false;
+    sink->fd = fileno(target);
+    if (sink->fd < 0) return false;
+
+    // Appending descriptors ignore pwrite offsets, so they count as not seekable
+    struct stat info;
+    const int flags = fcntl(sink->fd, F_GETFL);
+    sink->base = lseek(sink->fd, 0, SEEK_CUR);
+    sink->seekable = fstat(sink->fd, &info) == 0 && S_ISREG(info.st_mode) && flags >= 0 && !(flags & O_APPEND) &&
+                     sink->base >= 0;
+
+    sink->packed = format == OUTPUT_FORMAT_BIN;
+    sink->stride = sink->packed ? sizeof(uint16_t) : HACK_LINE_LENGTH;
+    sink->write_word = sink->packed ? write_rom_word : write_hack_line;
+    sink->window = malloc(STREAM_WINDOW_SLOTS * sink->stride);
+    if (!sink->window) return false;
+
+    // The image header holds a checksum of every word, so a packed image is finished in the spool
+    if (sink->packed) {
+        sink->spool = tmpfile();
+        if (!sink->spool) return false;
+        sink->spooling = true;
+        sink->spool_header = HACK_ROM_HEADER_SIZE;
+        const char zero[HACK_ROM_HEADER_SIZE] = {0};
+        if (!write_all(fileno(sink->spool), zero, sizeof(zero))) return false;
+    }
+    return true;
+}
+
+static void sink_free(Sink *sink) {
+    free(sink->window);
+    if (sink->spool) fclose(sink->spool);
+}
+
+static bool sink_flush(Sink *sink) {
+    const int fd = sink->spooling ? fileno(sink->spool) : sink->fd;
+    if (!write_all(fd, sink->window, sink->window_count * sink->stride)) return false;
+    sink->window_base += sink->window_count;
+    sink->window_count = 0;
+    return true;
+}
+
+static bool sink_emit(Sink *sink, const uint16_t word) {
+    if (sink->window_count == STREAM_WINDOW_SLOTS && !sink_flush(sink)) return false;
+    sink->write_word(word, sink->window + sink->window_count * sink->stride);
+    sink->window_count++;
+    return true;
+}
+
+static bool sink_patch(const Sink *sink, const uint64_t slot, const uint16_t word) {
+    char bytes[HACK_LINE_LENGTH];
+    sink->write_word(word, bytes);
+    if (slot >= sink->window_base) {
+        memcpy(sink->window + (slot - sink->window_base) * sink->stride, bytes, sink->stride);
+        return true;
+    }
+    if (sink->spooling && slot >= sink->spool_base) {
+        const off_t offset = (off_t)(sink->spool_header + (slot - sink->spool_base) * sink->stride);
+        return pwrite_all(fileno(sink->spool), bytes, sink->stride, offset);
+    }
+    if (sink->seekable) {
+        return pwrite_all(sink->fd, bytes, sink->stride, sink->base + (off_t)(slot * sink->stride));
+    }
+    return false;  // Already handed to a pipe; sink_hold() prevents this
+}
+
+// Called before a placeholder is emitted: on a pipe, everything from here on must be held back
+static bool sink_hold(Sink *sink) {
+    if (sink->seekable || sink->spooling) return true;
+    if (!sink_flush(sink)) return false;
+    if (!sink->spool) sink->spool = tmpfile();
+    if (!sink->spool) return false;
+    sink->spooling = true;
+    sink->spool_base = sink->window_base;
+    return true;
+}
+
+// Forwards 'size' bytes of the spool to the target
+static bool copy_spool(const Sink *sink, const off_t size) {
+    char buffer[COPY_CHUNK_SIZE];
+    for (off_t offset = 0; offset < size;) {
+        const size_t want = size - offset < (off_t)sizeof(buffer) ? (size_t)(size - offset) : sizeof(buffer);
+        const ssize_t n = pread(fileno(sink->spool), buffer, want, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || !write_all(sink->fd, buffer, (size_t)n)) return false;
+        offset += n;
+    }
+    return true;
+}
+
+// Called once nothing is pending: the held-back output can go to the pipe
+static bool sink_release(Sink *sink) {
+    if (!sink->spooling || sink->packed) return true;
+    if (!sink_flush(sink)) return false;
+    if (!copy_spool(sink, (off_t)((sink->window_base - sink->spool_base) * sink->stride))) return false;
+    const int spool = fileno(sink->spool);
+    if (ftruncate(spool, 0) != 0 || lseek(spool, 0, SEEK_SET) != 0) return false;
+    sink->spooling = false;
+    return true;
+}
+
+static bool sink_finish(Sink *sink) {
+    if (!sink_flush(sink)) return false;
+    if (!sink->spooling) return true;
+    if (!sink->packed) return sink_release(sink);
+
+    // Fill in the header now that every word is final, then forward the image
+    const size_t size = sink->spool_header + sink->window_base * sink->stride;
+    uint8_t *image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(sink->spool), 0);
+    if (image == MAP_FAILED) return false;
+    assembler_rom_finalize(image, size);
+    munmap(image, size);
+    return copy_spool(sink, (off_t)size);
+}
+
+static bool pending_add(Pending *pending, const uint64_t slot, const StringId id) {
+    if (pending->count == pending->capacity) {
+        const size_t capacity = pending->capacity ? pending->capacity * 2 : 256;
+        uint64_t *slots = realloc(pending->slots, capacity * sizeof(uint64_t));
+        if (slots) pending->slots = slots;
+        StringId *ids = realloc(pending->ids, capacity * sizeof(StringId));
+        if (ids) pending->ids = ids;
+        uint32_t *next = realloc(pending->next, capacity * sizeof(uint32_t));
+        if (next) pending->next = next;
+        if (!slots || !ids || !next || capacity >= PENDING_END) return false;
+        pending->capacity = capacity;
+    }
+    if (id >= pending->head_count) {
+        size_t count = pending->head_count ? pending->head_count : 256;
+        while (count <= id) count *= 2;
+        uint32_t *heads = realloc(pending->heads, count * sizeof(uint32_t));
+        if (!heads) return false;
+        for (size_t i = pending->head_count; i < count; i++) heads[i] = PENDING_END;
+        pending->heads = heads;
+        pending->head_count = count;
+    }
+
+    const size_t index = pending->count++;
+    pending->slots[index] = slot;
+    pending->ids[index] = id;
+    pending->next[index] = pending->heads[id];
+    pending->heads[id] = (uint32_t)index;
+    pending->unresolved++;
+    return true;
+}
+
+// Drops resolved uses once they are the majority, keeping output order
+static void pending_compact(Pending *pending) {
+    if (pending->count < 1024 || pending->unresolved * 2 > pending->count) return;
+    for (size_t i = 0; i < pending->head_count; i++) pending->heads[i] = PENDING_END;
+    size_t kept = 0;
+    for (size_t i = 0; i < pending->count; i++) {
+        const StringId id = pending->ids[i];
+        if (id == STRING_ID_NONE) continue;
+        pending->slots[kept] = pending->slots[i];
+        pending->ids[kept] = id;
+        pending->next[kept] = pending->heads[id];
+        pending->heads[id] = (uint32_t)kept;
+        kept++;
+    }
+    pending->count = kept;
+}
+
+// Patches every pending use of a symbol that just became known
+static bool pending_resolve(Pending *pending, Sink *sink, const StringId id, const int address) {
+    if (id >= pending->head_count || pending->heads[id] == PENDING_END) return true;
+    const uint16_t word = encode_address(address);
+    for (uint32_t i = pending->heads[id]; i != PENDING_END; i = pending->next[i]) {
+        if (!sink_patch(sink, pending->slots[i], word)) return false;
+        pending->ids[i] = STRING_ID_NONE;
+        pending->unresolved--;
+    }
+    pending->heads[id] = PENDING_END;
+    pending_compact(pending);
+    return pending->unresolved > 0 || sink_release(sink);
+}
+
+static void pending_free(Pending *pending) {
+    free(pending->slots);
+    free(pending->ids);
+    free(pending->next);
+    free(pending->heads);
+}
+
+// Encodes the instructions of one piece of source
+static ProcessStatus encode_instructions(const TokenTable *instructions, SymbolTable *symbol_table, Pending *pending,
+                                         Sink *sink, uint64_t *instruction_count) {
+    size_t run = 0;
+    for (size_t i = 0; i < token_table_size(instructions); i += run) {
+        const PackedInstruction *records = token_table_span(instructions, i, &run);
+        for (size_t j = 0; j < run; j++) {
+            const StringId symbol = PACKED_PAYLOAD(records[j]);
+            if (PACKED_KIND(records[j]) == PACKED_LABEL) {
+                const int address = symbol_table_get_address_id(symbol_table, symbol);
+                if (!pending_resolve(pending, sink, symbol, address)) return PROCESS_ERROR;
+                continue;
+            }
+
+            uint16_t word = PACKED_WORD_VALUE(records[j]);
+            if (PACKED_KIND(records[j]) == PACKED_SYMBOL) {
+                const int address = symbol_table_get_address_id(symbol_table, symbol);
+                if (address < 0) {
+                    // Unknown until a label defines it, or until the end of input makes it a variable
+                    if (!sink_hold(sink) || !pending_add(pending, *instruction_count, symbol)) return PROCESS_ERROR;
+                    word = 0;
+                } else {
+                    word = encode_address(address);
+                }
+            }
+            if (!sink_emit(sink, word)) return PROCESS_ERROR;
+            (*instruction_count)++;
+        }
+    }
+    return PROCESS_SUCCESS;
+}
+
+// Reads what is available (at most 'size' bytes); returns 0 at end of input, -1 on error
+static ssize_t read_some(FILE *source, char *buffer, const size_t size) {
+    const int fd = fileno(source);
+    if (fd < 0) {
+        const size_t n = fread(buffer, 1, size, source);
+        return ferror(source) ? -1 : (ssize_t)n;
+    }
+    for (;;) {
+        const ssize_t n = read(fd, buffer, size);
+        if (n >= 0 || errno != EINTR) return n;
+    }
+}
+
+int stream_assemble(const AssemblerConfig *config, TokenTable *instructions, StringPool *string_pool,
+                    SymbolTable *symbol_table) {
+    if (!config || !instructions || !string_pool || !symbol_table) return 1;
+
+    Sink sink = {0};
+    Pending pending = {0};
+    size_t capacity = STREAM_READ_SIZE;
+    char *buffer = malloc(capacity);
+    TokenDump *dump = config->token_output ? token_dump_create(config->token_output) : NULL;
+    if (!buffer || (config->token_output && !dump) ||
+        !sink_init(&sink, config->target_hack, config->format)) {
+        GLOG(LOG_ERROR, "%s: unable to set up streaming output.", config->target_filepath);
+        token_dump_close(dump);
+        sink_free(&sink);
+        free(buffer);
+        return 1;
+    }
+
+    int status = 0;
+    int rom_address = 0;
+    int lines = 0;
+    uint64_t instruction_count = 0;
+    size_t filled = 0;
+    bool end_of_input = false;
+    while (status == 0 && !end_of_input) {
+        // A line longer than the buffer makes it grow; otherwise memory stays constant
+        if (filled == capacity) {
+            char *grown = realloc(buffer, capacity * 2);
+            if (!grown) {
+                GLOG(LOG_ERROR, "%s:%d: line too long.", config->source_filepath, lines + 1);
+                status = 1;
+                break;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+        STATS_BEGIN(read_mark);
+        const ssize_t n = read_some(config->source_asm, buffer + filled, capacity - filled);
+        STATS_END("read", read_mark);
+        if (n < 0) {
+            GLOG(LOG_ERROR, "%s: unable to read source.", config->source_filepath);
+            status = 1;
+            break;
+        }
+        filled += (size_t)n;
+        end_of_input = n == 0;
+
+        // Lex whole lines only; a partial last line waits for more input
+        const char *last_newline = filled ? memrchr(buffer, '\n', filled) : NULL;
+        const size_t end = end_of_input ? filled : last_newline ? (size_t)(last_newline - buffer) + 1 : 0;
+        if (end == 0 && !end_of_input) continue;
+
+        int piece_lines = 0;
+        ScannedLine error_line;
+        STATS_BEGIN(lex_mark);
+        ProcessStatus result = lex_source_instructions(buffer, 0, end, instructions, string_pool, symbol_table,
+                                                       &rom_address, &piece_lines, &error_line);
+        STATS_END("lex", lex_mark);
+        if (result == PROCESS_INVALID) {
+            GLOG(LOG_ERROR, "%s:%d: syntax error: unable to process line - %.*s", config->source_filepath,
+                 lines + piece_lines, (int)(error_line.end - error_line.start), buffer + error_line.start);
+        } else if (result == PROCESS_ERROR) {
+            GLOG(LOG_ERROR, "%s:%d: internal error (memory/system failure) while processing line.",
+                 config->source_filepath, lines + piece_lines);
+        } else {
+            STATS_BEGIN(encode_mark);
+            result = encode_instructions(instructions, symbol_table, &pending, &sink, &instruction_count);
+            STATS_END("codegen", encode_mark);
+            if (result != PROCESS_SUCCESS) {
+                GLOG(LOG_ERROR, "%s: %s during code generation.", config->source_filepath,
+                     result == PROCESS_INVALID ? "malformed instruction" : "internal error (memory/system failure)");
+            }
+        }
+        if (dump && !token_dump_write_instructions(dump, instructions, string_pool)) {
+            GLOG(LOG_ERROR, "%s: failed to write token dump.", config->source_filepath);
+            result = PROCESS_ERROR;
+        }
+        STATS_COUNT("instructions", token_table_size(instructions));
+        token_table_clear(instructions);
+        if (result != PROCESS_SUCCESS) status = 1;
+
+        lines += piece_lines;
+        STATS_COUNT("lines", (uint64_t)piece_lines);
+        STATS_COUNT("bytes", end);
+        memmove(buffer, buffer + end, filled - end);
+        filled -= end;
+
+        // Let a pipeline see each piece's output as soon as it is final
+        STATS_BEGIN(write_mark);
+        if (status == 0 && !sink_flush(&sink)) status = 1;
+        STATS_END("write", write_mark);
+    }
+
+    // Whatever is still pending is a variable, numbered in order of first use
+    STATS_BEGIN(resolve_mark);
+    int ram_address = 16;
+    for (size_t i = 0; status == 0 && i < pending.count; i++) {
+        if (pending.ids[i] == STRING_ID_NONE) continue;
+        bool inserted = false;
+        const int address = symbol_table_lookup_or_insert_id(symbol_table, pending.ids[i], ram_address, &inserted);
+        if (address < 0 || !sink_patch(&sink, pending.slots[i], encode_address(address))) status = 1;
+        if (inserted) ram_address++;
+    }
+    STATS_END("parse", resolve_mark);
+    STATS_COUNT("variables", (uint64_t)(ram_address - 16));
+    STATS_BEGIN(finish_mark);
+    if (status == 0 && !sink_finish(&sink)) {
+        GLOG(LOG_ERROR, "%s: failed to write output file.", config->target_filepath);
+        status = 1;
+    }
+    STATS_END("write", finish_mark);
+
+    if (!token_dump_close(dump) && status == 0) {
+        GLOG(LOG_ERROR, "%s: failed to write token dump.", config->source_filepath);
+        status = 1;
+    }
+    pending_free(&pending);
+    sink_free(&sink);
+    free(buffer);
+    return status;
+}
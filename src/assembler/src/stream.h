@@ -0,0 +1,38 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "lexer.h"
+#include <assembler.h>
+#include <stdint.h>
+
+#define STREAM_READ_SIZE 65536      // Source bytes read (and lexed) at a time
+#define STREAM_WINDOW_SLOTS 4096    // Encoded instructions buffered before they are written
+
+/**
+ * @brief Single-pass assembly from a stream into a stream, in bounded memory.
+ *
+ * The source is read and lexed in STREAM_READ_SIZE pieces; the instructions of each piece are
+ * encoded and dropped right away. An A-instruction whose symbol is not known yet (a forward
+ * label reference, or a variable) is written as a placeholder and remembered; a later label
+ * definition patches every pending use of it, and at end of input the symbols still pending
+ * become variables in first-use order, exactly as in the two-pass assembler.
+ *
+ * Placeholders are patched in place (pwrite) when the target is a seekable file. Otherwise
+ * output from the first pending instruction on is spooled to an unlinked temporary file until
+ * every pending reference is resolved, and then forwarded, so a pipe receives everything up to
+ * the first unresolved reference immediately. Packed images (OUTPUT_FORMAT_BIN) start with a
+ * checksum of all words and are always spooled whole.
+ *
+ * Memory use is bounded by the read size, the output window, the pending references and the
+ * symbol table, whatever the length of the input.
+ *
+ * @param config       Source and target streams, paths (for messages), format and token output.
+ * @param instructions Scratch table of packed instruction records (cleared between pieces).
+ * @param string_pool  Pool for symbol names.
+ * @param symbol_table Symbol table holding the predefined symbols.
+ * @return 0 on success, 1 on failure (errors are logged).
+ */
+int stream_assemble(const AssemblerConfig *config, TokenTable *instructions, StringPool *string_pool,
+                    SymbolTable *symbol_table);
+
+#endif // STREAM_H
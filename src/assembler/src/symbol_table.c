@@ -1,86 +1,241 @@
+
+
 #include "symbol_table.h"
 
+#include <alloc_stats.h>
 #include <logger.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 #define PREDEFINED_COUNT 23
+#define INITIAL_CAPACITY 64     // Must be a power of two
 
-// Internal structure for a symbol entry
-typedef struct {
-    char *symbol;
-    int address;
-} SymbolEntry;
+// A stored hash of 0 marks an empty slot (the pool never produces a 0 hash)
+#define EMPTY_HASH 0u
 
-// Internal structure for the symbol table
+// Internal structure for the symbol table.
+// Open addressing with linear probing, laid out as parallel arrays so that probing
+// only touches the hashes array until a hash match is found. Keys are interned ids,
+// so a hash match is confirmed with a single integer comparison.
 struct SymbolTable {
-    SymbolEntry entries[MAX_NUM_SYMBOLS];
-    size_t count;
+    StringPool *pool;     // Interns symbol text (not owned)
+    uint32_t *hashes;     // Stored hash per slot (EMPTY_HASH if unused)
+    StringId *ids;        // Interned symbol id per slot
+    int *addresses;       // Address per slot
+    size_t capacity;      // Number of slots (power of two)
+    size_t count;         // Number of occupied slots
 };
 
+// Returns the slot holding 'id', or the empty slot where it would be inserted
+static size_t find_slot(const SymbolTable *table, const StringId id, const uint32_t hash) {
+    const size_t mask = table->capacity - 1;
+    size_t slot = hash & mask;
+    while (table->hashes[slot] != EMPTY_HASH) {
+        if (table->ids[slot] == id) return slot;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static bool allocate_slots(SymbolTable *table, const size_t capacity) {
+    table->hashes = TRACKED_CALLOC(ALLOC_TAG_SYMBOLS, capacity, sizeof(uint32_t));
+    table->ids = TRACKED_MALLOC(ALLOC_TAG_SYMBOLS, capacity * sizeof(StringId));
+    table->addresses = TRACKED_MALLOC(ALLOC_TAG_SYMBOLS, capacity * sizeof(int));
+    if (!table->hashes || !table->ids || !table->addresses) {
+        TRACKED_FREE(ALLOC_TAG_SYMBOLS, table->hashes);
+        TRACKED_FREE(ALLOC_TAG_SYMBOLS, table->ids);
+        TRACKED_FREE(ALLOC_TAG_SYMBOLS, table->addresses);
+        return false;
+    }
+    table->capacity = capacity;
+    return true;
+}
+
+// Doubles the capacity and rehashes using the stored hashes
+static bool grow(SymbolTable *table) {
+    SymbolTable old = *table;
+    if (!allocate_slots(table, old.capacity * 2)) {
+        *table = old;
+        GLOG(LOG_ERROR, "Symbol table failed to grow beyond %zu slots", old.capacity);
+        return false;
+    }
+
+    const size_t mask = table->capacity - 1;
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.hashes[i] == EMPTY_HASH) continue;
+        size_t slot = old.hashes[i] & mask;
+        while (table->hashes[slot] != EMPTY_HASH) slot = (slot + 1) & mask;
+        table->hashes[slot] = old.hashes[i];
+        table->ids[slot] = old.ids[i];
+        table->addresses[slot] = old.addresses[i];
+    }
+
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, old.hashes);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, old.ids);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, old.addresses);
+    return true;
+}
+
+// Stores a new entry in an empty slot found by find_slot, growing first if needed
+static bool insert_at(SymbolTable *table, size_t slot, const StringId id, const uint32_t hash, const int address) {
+    // Keep the load factor at or below 1/2 so probe sequences stay short
+    if ((table->count + 1) * 2 > table->capacity) {
+        if (!grow(table)) return false;
+        slot = find_slot(table, id, hash);
+    }
+
+    table->hashes[slot] = hash;
+    table->ids[slot] = id;
+    table->addresses[slot] = address;
+    table->count++;
+    return true;
+}
+
 // Create a new symbol table
-SymbolTable *symbol_table_create(void) {
-    SymbolTable *table = malloc(sizeof(SymbolTable));
+SymbolTable *symbol_table_create(StringPool *pool) {
+    if (!pool) return NULL;
+    SymbolTable *table = TRACKED_CALLOC(ALLOC_TAG_SYMBOLS, 1, sizeof(SymbolTable));
     if (!table) return NULL;
-    table->count = 0;
+    table->pool = pool;
+    if (!allocate_slots(table, INITIAL_CAPACITY)) {
+        TRACKED_FREE(ALLOC_TAG_SYMBOLS, table);
+        return NULL;
+    }
     return table;
 }
 
-// Free the symbol table
+// Free the symbol table (symbol text belongs to the pool)
 void symbol_table_free(SymbolTable *table) {
     if (!table) return;
-
-    // Free each symbol string
-    for (size_t i = 0; i < table->count; i++) {
-        free(table->entries[i].symbol);
-    }
-    free(table);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, table->hashes);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, table->ids);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, table->addresses);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, table);
 }
 
 // Add a new symbol to the table
 bool symbol_table_add(SymbolTable *table, const char *symbol, const int address) {
     if (!table || !symbol) return false;
 
-    if (symbol_table_contains(table, symbol)) return false;
-
-    // Check if the table is full
-    if (table->count >= MAX_NUM_SYMBOLS) {
-        GLOG(LOG_ERROR, "Symbol table capacity exceeded (max %d symbols)", MAX_NUM_SYMBOLS);
-        return false;
-    }
+    const StringId id = string_pool_intern(table->pool, symbol, strlen(symbol));
+    if (id == STRING_ID_NONE) return false;
 
-    // Allocate and copy the symbol name
-    table->entries[table->count].symbol = strdup(symbol);
-    if (!table->entries[table->count].symbol) {
-        return false;
-    }
+    const uint32_t hash = string_pool_hash(table->pool, id);
+    const size_t slot = find_slot(table, id, hash);
+    if (table->hashes[slot] != EMPTY_HASH) return false;  // Already exists
 
-    table->entries[table->count].address = address;
-    table->count++;
-    return true;
+    return insert_at(table, slot, id, hash, address);
 }
 
 // Check if a symbol exists in the table
 bool symbol_table_contains(SymbolTable *table, const char *symbol) {
     if (!table || !symbol) return false;
-    for (size_t i = 0; i < table->count; i++) {
-        if (strcmp(table->entries[i].symbol, symbol) == 0) {
-            return true;
-        }
-    }
-    return false;
+    const StringId id = string_pool_find(table->pool, symbol, strlen(symbol));
+    return id != STRING_ID_NONE && symbol_table_get_address_id(table, id) != -1;
 }
 
 // Get the address associated with a symbol
 int symbol_table_get_address(SymbolTable *table, const char *symbol) {
     if (!table || !symbol) return -1;
-    for (size_t i = 0; i < table->count; i++) {
-        if (strcmp(table->entries[i].symbol, symbol) == 0) {
-            return table->entries[i].address;
+    const StringId id = string_pool_find(table->pool, symbol, strlen(symbol));
+    if (id == STRING_ID_NONE) return -1; // Never interned -> not found
+    return symbol_table_get_address_id(table, id);
+}
+
+// Get the address associated with an interned symbol
+int symbol_table_get_address_id(const SymbolTable *table, const StringId id) {
+    if (!table || id == STRING_ID_NONE) return -1;
+    const size_t slot = find_slot(table, id, string_pool_hash(table->pool, id));
+    if (table->hashes[slot] == EMPTY_HASH) return -1; // Not found
+    return table->addresses[slot];
+}
+
+// Look up a symbol, inserting it with 'address' if absent
+int symbol_table_lookup_or_insert(SymbolTable *table, const char *symbol, const int address, bool *inserted) {
+    if (inserted) *inserted = false;
+    if (!table || !symbol) return -1;
+
+    const StringId id = string_pool_intern(table->pool, symbol, strlen(symbol));
+    if (id == STRING_ID_NONE) return -1;
+    return symbol_table_lookup_or_insert_id(table, id, address, inserted);
+}
+
+// Same as symbol_table_lookup_or_insert, keyed by interned id (no string hashing or comparison)
+int symbol_table_lookup_or_insert_id(SymbolTable *table, const StringId id, const int address, bool *inserted) {
+    if (inserted) *inserted = false;
+    if (!table || id == STRING_ID_NONE) return -1;
+
+    const uint32_t hash = string_pool_hash(table->pool, id);
+    if (hash == EMPTY_HASH) return -1;  // Id not from this table's pool
+
+    const size_t slot = find_slot(table, id, hash);
+    if (table->hashes[slot] != EMPTY_HASH) return table->addresses[slot];
+
+    if (!insert_at(table, slot, id, hash, address)) return -1;
+    if (inserted) *inserted = true;
+    return address;
+}
+
+size_t symbol_table_count(const SymbolTable *table) {
+    return table ? table->count : 0;
+}
+
+bool symbol_table_for_each(const SymbolTable *table, const SymbolVisitor visit, void *context) {
+    if (!table || !visit) return false;
+    for (size_t slot = 0; slot < table->capacity; slot++) {
+        if (table->hashes[slot] == EMPTY_HASH) continue;
+        if (!visit(table->ids[slot], table->addresses[slot], context)) return false;
+    }
+    return true;
+}
+
+bool symbol_table_truncate(SymbolTable *table, const StringId limit) {
+    if (!table) return false;
+
+    // Set the kept entries aside, then clear and reinsert them so probe chains stay intact
+    size_t kept = 0;
+    for (size_t slot = 0; slot < table->capacity; slot++) {
+        if (table->hashes[slot] != EMPTY_HASH && table->ids[slot] < limit) kept++;
+    }
+    if (kept == table->count) return true;
+
+    SymbolTable saved = {.capacity = kept};
+    if (kept > 0) {
+        saved.hashes = TRACKED_MALLOC(ALLOC_TAG_SYMBOLS, kept * sizeof(uint32_t));
+        saved.ids = TRACKED_MALLOC(ALLOC_TAG_SYMBOLS, kept * sizeof(StringId));
+        saved.addresses = TRACKED_MALLOC(ALLOC_TAG_SYMBOLS, kept * sizeof(int));
+        if (!saved.hashes || !saved.ids || !saved.addresses) {
+            TRACKED_FREE(ALLOC_TAG_SYMBOLS, saved.hashes);
+            TRACKED_FREE(ALLOC_TAG_SYMBOLS, saved.ids);
+            TRACKED_FREE(ALLOC_TAG_SYMBOLS, saved.addresses);
+            return false;
         }
     }
-    return -1; // Not found
+    for (size_t slot = 0, i = 0; slot < table->capacity; slot++) {
+        if (table->hashes[slot] == EMPTY_HASH || table->ids[slot] >= limit) continue;
+        saved.hashes[i] = table->hashes[slot];
+        saved.ids[i] = table->ids[slot];
+        saved.addresses[i] = table->addresses[slot];
+        i++;
+    }
+
+    memset(table->hashes, 0, table->capacity * sizeof(uint32_t));
+    const size_t mask = table->capacity - 1;
+    for (size_t i = 0; i < kept; i++) {
+        size_t slot = saved.hashes[i] & mask;
+        while (table->hashes[slot] != EMPTY_HASH) slot = (slot + 1) & mask;
+        table->hashes[slot] = saved.hashes[i];
+        table->ids[slot] = saved.ids[i];
+        table->addresses[slot] = saved.addresses[i];
+    }
+    table->count = kept;
+
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, saved.hashes);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, saved.ids);
+    TRACKED_FREE(ALLOC_TAG_SYMBOLS, saved.addresses);
+    return true;
 }
 
 // Function to load predefined symbols into the symbol table
@@ -5,18 +5,26 @@
 #define SYMBOL_TABLE_H
 
 #include <stdbool.h>
-
-#define MAX_NUM_SYMBOLS 1000
+#include <stddef.h>
+#include <string_pool.h>
 
 // Declare SymbolTable as an opaque type
 typedef struct SymbolTable SymbolTable;
 
+// Callback for symbol_table_for_each; return false to stop the iteration
+typedef bool (*SymbolVisitor)(StringId id, int address, void *context);
+
 /**
  * Creates and initializes a new SymbolTable instance.
  *
- * @return Pointer to the newly created SymbolTable.
+ * The table is an open-addressing hash table keyed by interned StringIds that grows
+ * on demand, so there is no fixed limit on the number of symbols it can hold.
+ * Symbol text lives in the StringPool; lookups by id compare integers only.
+ *
+ * @param pool StringPool used to intern symbols (caller-owned, must outlive the table).
+ * @return Pointer to the newly created SymbolTable, or NULL on failure.
  */
-SymbolTable *symbol_table_create(void);
+SymbolTable *symbol_table_create(StringPool *pool);
 
 /**
  * Frees the SymbolTable and any resources it holds.
@@ -31,7 +39,7 @@ void symbol_table_free(SymbolTable *table);
  * @param table Pointer to the SymbolTable.
  * @param symbol The symbol (string) to add.
  * @param address The associated address of the symbol.
- * @return true if the symbol was successfully added, false if the table is full or symbol already exists.
+ * @return true if the symbol was successfully added, false if the symbol already exists or on allocation failure.
  */
 bool symbol_table_add(SymbolTable *table, const char *symbol, int address);
 
@@ -53,6 +61,70 @@ bool symbol_table_contains(SymbolTable *table, const char *symbol);
  */
 int symbol_table_get_address(SymbolTable *table, const char *symbol);
 
+/**
+ * Looks up a symbol, inserting it with the given address if it is not present.
+ *
+ * The symbol is hashed once and probed once, which makes this the preferred call
+ * for resolving variables in the second pass.
+ *
+ * @param table Pointer to the SymbolTable.
+ * @param symbol The symbol (string) to look up or insert.
+ * @param address The address to assign if the symbol is new.
+ * @param inserted Optional; set to true if the symbol was inserted, false if it already existed.
+ * @return The address of the symbol (existing or newly assigned), or -1 on failure.
+ */
+int symbol_table_lookup_or_insert(SymbolTable *table, const char *symbol, int address, bool *inserted);
+
+/**
+ * Same as symbol_table_lookup_or_insert(), for a symbol already interned in the table's StringPool.
+ *
+ * @param table Pointer to the SymbolTable.
+ * @param id Interned id of the symbol.
+ * @param address The address to assign if the symbol is new.
+ * @param inserted Optional; set to true if the symbol was inserted, false if it already existed.
+ * @return The address of the symbol (existing or newly assigned), or -1 on failure.
+ */
+int symbol_table_lookup_or_insert_id(SymbolTable *table, StringId id, int address, bool *inserted);
+
+/**
+ * Retrieves the address associated with an interned symbol.
+ *
+ * @param table Pointer to the SymbolTable.
+ * @param id Interned id of the symbol.
+ * @return The address of the symbol if found, or -1 if the symbol does not exist.
+ */
+int symbol_table_get_address_id(const SymbolTable *table, StringId id);
+
+/**
+ * Returns the number of symbols currently stored in the SymbolTable.
+ *
+ * @param table Pointer to the SymbolTable.
+ * @return Number of symbols, or 0 if table is NULL.
+ */
+size_t symbol_table_count(const SymbolTable *table);
+
+/**
+ * Calls 'visit' for every symbol in the table (in unspecified order).
+ *
+ * @param table Pointer to the SymbolTable.
+ * @param visit Callback receiving each symbol id and address.
+ * @param context Opaque pointer passed through to 'visit'.
+ * @return true if every symbol was visited, false if 'visit' stopped the iteration.
+ */
+bool symbol_table_for_each(const SymbolTable *table, SymbolVisitor visit, void *context);
+
+/**
+ * Removes every symbol whose id is >= 'limit', keeping the others with their addresses.
+ *
+ * Paired with string_pool_truncate(), this returns a table to the state it had when
+ * the pool held 'limit' strings (e.g. just after load_predefined_symbols()).
+ *
+ * @param table Pointer to the SymbolTable.
+ * @param limit First StringId to remove.
+ * @return true on success, false on allocation failure (the table is then unchanged).
+ */
+bool symbol_table_truncate(SymbolTable *table, StringId limit);
+
 /**
  * Loads predefined symbols into the SymbolTable.
  *
@@ -64,5 +136,3 @@ int symbol_table_get_address(SymbolTable *table, const char *symbol);
 bool load_predefined_symbols(SymbolTable *table);
 
 #endif // SYMBOL_TABLE_H
-
-
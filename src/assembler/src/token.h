@@ -4,6 +4,8 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <string_pool.h>
+
 // Enum representing different token types
 typedef enum {
     // A-instruction tokens
@@ -79,8 +81,8 @@ typedef enum {
 
 // Union to store only necessary values
 typedef union {
-    int integer;    // Stores an integer literal (e.g., @10)
-    char *symbol;   // Stores a symbol (e.g., LOOP, count, var)
+    int integer;        // Stores an integer literal (e.g., @10)
+    StringId symbol;    // Stores an interned symbol id (e.g., LOOP, count, var)
 } TokenValue;
 
 
@@ -94,24 +96,35 @@ typedef struct {
  * Creates a new Token instance with the specified type and optional value.
  *
  * @param type The TokenType representing the type of token to create.
- * @param ...  Optional value(s) depending on token type (e.g., integer for TOKEN_INTEGER or string for TOKEN_SYMBOL).
+ * @param ...  Optional value depending on token type: an int for TOKEN_INTEGER, or a
+ *             StringId for TOKEN_SYMBOL.
  * @return Pointer to the newly created Token. Caller is responsible for freeing it using free_token().
  */
 Token *create_token(TokenType type, ...);
 
 /**
- * Frees the memory associated with a Token instance, including any dynamically allocated value.
+ * Frees the memory associated with a Token instance.
  *
  * @param token Pointer to the Token to free.
  */
 void free_token(Token *token);
 
+/**
+ * Returns the fixed text of a token type, as it starts the token_to_str() output
+ * (e.g. "TOKEN_COMP D+1"; "TOKEN_SYMBOL" and "TOKEN_INTEGER" are followed by the value).
+ *
+ * @param type Token type.
+ * @return Static string, or NULL for an unknown type.
+ */
+const char *token_type_text(TokenType type);
+
 /**
  * Converts a Token into a human-readable string representation.
  *
  * @param token Pointer to the Token to stringify.
+ * @param pool StringPool the token's symbol id was interned in.
  * @return Dynamically allocated string representing the token (caller is responsible for freeing the returned string).
  */
-char *token_to_str(const Token *token);
+char *token_to_str(const Token *token, const StringPool *pool);
 
 #endif //TOKEN_H
@@ -0,0 +1,200 @@
+#include "token_dump.h"
+#include "code_generator.h"
+#include "lexer.h"
+#include "token.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VARINT_MAX_BYTES 10
+
+struct TokenDump {
+    FILE *file;
+    bool failed;
+    uint64_t *named;        // Bit per StringId whose name was already written
+    size_t named_words;
+    size_t used;
+    unsigned char buffer[TOKEN_DUMP_BUFFER_SIZE];
+};
+
+static void flush_buffer(TokenDump *dump) {
+    if (dump->used > 0 && fwrite(dump->buffer, 1, dump->used, dump->file) != dump->used) dump->failed = true;
+    dump->used = 0;
+}
+
+// Makes room for 'size' more bytes in the buffer
+static void reserve(TokenDump *dump, const size_t size) {
+    if (TOKEN_DUMP_BUFFER_SIZE - dump->used < size) flush_buffer(dump);
+}
+
+static void put_varint(TokenDump *dump, uint64_t value) {
+    while (value >= 0x80) {
+        dump->buffer[dump->used++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    dump->buffer[dump->used++] = (unsigned char)value;
+}
+
+// Writes a symbol's name unless an earlier record already did
+static bool name_symbol(TokenDump *dump, const StringId id, const StringPool *pool) {
+    const size_t word = id / 64;
+    if (word >= dump->named_words) {
+        size_t count = dump->named_words ? dump->named_words : 64;
+        while (count <= word) count *= 2;
+        uint64_t *named = realloc(dump->named, count * sizeof(uint64_t));
+        if (!named) return false;
+        memset(named + dump->named_words, 0, (count - dump->named_words) * sizeof(uint64_t));
+        dump->named = named;
+        dump->named_words = count;
+    }
+    const uint64_t bit = (uint64_t)1 << (id % 64);
+    if (dump->named[word] & bit) return true;
+    dump->named[word] |= bit;
+
+    const char *name = string_pool_get(pool, id);
+    const size_t length = name ? string_pool_length(pool, id) : 0;
+    reserve(dump, 1 + 2 * VARINT_MAX_BYTES + length);
+    dump->buffer[dump->used++] = TOKEN_DUMP_STRING;
+    put_varint(dump, id);
+    put_varint(dump, length);
+    if (length > TOKEN_DUMP_BUFFER_SIZE - dump->used) {
+        flush_buffer(dump);
+        if (fwrite(name, 1, length, dump->file) != length) dump->failed = true;
+    } else if (length > 0) {
+        memcpy(dump->buffer + dump->used, name, length);
+        dump->used += length;
+    }
+    return true;
+}
+
+TokenDump *token_dump_create(FILE *file) {
+    if (!file) return NULL;
+    TokenDump *dump = malloc(sizeof(TokenDump));
+    if (!dump) return NULL;
+    dump->file = file;
+    dump->failed = false;
+    dump->named = NULL;
+    dump->named_words = 0;
+    memcpy(dump->buffer, TOKEN_DUMP_MAGIC, 4);
+    dump->buffer[4] = TOKEN_DUMP_VERSION;
+    dump->used = 5;
+    return dump;
+}
+
+static bool put_token(TokenDump *dump, const Token *token, const StringPool *pool) {
+    if (token->type == TOKEN_SYMBOL && !name_symbol(dump, token->value.symbol, pool)) return false;
+
+    reserve(dump, 1 + VARINT_MAX_BYTES);
+    dump->buffer[dump->used++] = (unsigned char)token->type;
+    if (token->type == TOKEN_SYMBOL) {
+        put_varint(dump, token->value.symbol);
+    } else if (token->type == TOKEN_INTEGER) {
+        // Zigzag keeps small negative values short as well
+        const int64_t value = token->value.integer;
+        put_varint(dump, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+    }
+    return true;
+}
+
+bool token_dump_write(TokenDump *dump, const TokenTable *table, const StringPool *pool) {
+    if (!dump || !table) return false;
+    const size_t count = token_table_size(table);
+    for (size_t i = 0; i < count; i++) {
+        if (!put_token(dump, token_table_get(table, i), pool)) return false;
+    }
+    return !dump->failed;
+}
+
+bool token_dump_write_instructions(TokenDump *dump, const TokenTable *instructions, const StringPool *pool) {
+    if (!dump || !instructions) return false;
+    const size_t count = token_table_size(instructions);
+    for (size_t i = 0; i < count; i++) {
+        Instruction instruction;
+        unpack_instruction(*(const PackedInstruction *)token_table_get(instructions, i), &instruction);
+        Token tokens[INSTRUCTION_MAX_TOKENS];
+        const size_t token_count = instruction_to_tokens(&instruction, tokens);
+        for (size_t j = 0; j < token_count; j++) {
+            if (!put_token(dump, &tokens[j], pool)) return false;
+        }
+    }
+    return !dump->failed;
+}
+
+bool token_dump_close(TokenDump *dump) {
+    if (!dump) return true;
+    flush_buffer(dump);
+    const bool ok = !dump->failed;
+    free(dump->named);
+    free(dump);
+    return ok;
+}
+
+static bool read_varint(FILE *in, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int byte = getc(in);
+        if (byte == EOF) return false;
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool token_dump_render(FILE *in, FILE *out) {
+    char header[5];
+    if (!in || !out || fread(header, 1, sizeof(header), in) != sizeof(header) ||
+        memcmp(header, TOKEN_DUMP_MAGIC, 4) != 0 || header[4] != TOKEN_DUMP_VERSION) {
+        return false;
+    }
+
+    char **names = NULL;
+    size_t name_count = 0;
+    bool ok = true;
+    int type;
+    while (ok && (type = getc(in)) != EOF) {
+        uint64_t value;
+        if (type == TOKEN_DUMP_STRING) {
+            uint64_t length;
+            ok = read_varint(in, &value) && read_varint(in, &length) && value < UINT32_MAX && length < SIZE_MAX;
+            if (ok && value >= name_count) {
+                const size_t count = value < 64 ? 128 : (size_t)value * 2;
+                char **grown = realloc(names, count * sizeof(char *));
+                ok = grown != NULL;
+                if (ok) {
+                    memset(grown + name_count, 0, (count - name_count) * sizeof(char *));
+                    names = grown;
+                    name_count = count;
+                }
+            }
+            char *name = ok ? malloc((size_t)length + 1) : NULL;
+            ok = name && fread(name, 1, (size_t)length, in) == length;
+            if (ok) {
+                name[length] = '\0';
+                free(names[value]);
+                names[value] = name;
+            } else {
+                free(name);
+            }
+            continue;
+        }
+
+        const char *text = token_type_text((TokenType)type);
+        if (!text) {
+            ok = false;
+        } else if (type == TOKEN_SYMBOL) {
+            ok = read_varint(in, &value);
+            const char *name = ok && value < name_count ? names[value] : NULL;
+            if (ok) fprintf(out, "%s %s\n", text, name ? name : "<unknown>");
+        } else if (type == TOKEN_INTEGER) {
+            ok = read_varint(in, &value);
+            if (ok) fprintf(out, "%s %d\n", text, (int)(int64_t)((value >> 1) ^ -(value & 1)));
+        } else {
+            fputs(text, out);
+            putc('\n', out);
+        }
+    }
+
+    for (size_t i = 0; i < name_count; i++) free(names[i]);
+    free(names);
+    return ok && !ferror(in) && !ferror(out);
+}
@@ -0,0 +1,77 @@
+#ifndef TOKEN_DUMP_H
+#define TOKEN_DUMP_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string_pool.h>
+#include <token_table.h>
+
+#define TOKEN_DUMP_MAGIC "HTOK"
+#define TOKEN_DUMP_VERSION 1
+#define TOKEN_DUMP_STRING 0xFF          // Record type defining a symbol name
+#define TOKEN_DUMP_BUFFER_SIZE 65536    // Bytes collected before each fwrite
+
+/**
+ * Compact binary dump of the token stream (what `-t` writes; render it with `hacktok`).
+ *
+ * The file starts with the 4-byte magic TOKEN_DUMP_MAGIC and one version byte, followed by
+ * one record per token:
+ *
+ *   type byte (TokenType)
+ *   TOKEN_INTEGER: the value as a zigzag LEB128 varint
+ *   TOKEN_SYMBOL:  the StringId as a LEB128 varint
+ *
+ * A symbol's name is written once, in a TOKEN_DUMP_STRING record (varint id, varint length,
+ * bytes) placed before its first use, so a dump of any length stays close to one byte per
+ * token. Several tables may be appended to one dump (e.g. by the streaming assembler).
+ */
+typedef struct TokenDump TokenDump;
+
+/**
+ * @brief Starts a dump by writing its header.
+ *
+ * @param file Output stream (not closed by the dump).
+ * @return Pointer to TokenDump (finish with token_dump_close), or NULL on failure.
+ */
+TokenDump *token_dump_create(FILE *file);
+
+/**
+ * @brief Appends every token of a table.
+ *
+ * @param dump Dump being written.
+ * @param table Table of Token records.
+ * @param pool Pool the symbol ids were interned in.
+ * @return true on success, false if a write or an allocation failed.
+ */
+bool token_dump_write(TokenDump *dump, const TokenTable *table, const StringPool *pool);
+
+/**
+ * @brief Appends the tokens of a table of PackedInstruction records (see instruction_to_tokens()).
+ *
+ * The dump is the same as that of the token stream lex_source() produces for the same lines.
+ *
+ * @param dump Dump being written.
+ * @param instructions Table of PackedInstruction records.
+ * @param pool Pool the symbol ids were interned in.
+ * @return true on success, false if a write or an allocation failed.
+ */
+bool token_dump_write_instructions(TokenDump *dump, const TokenTable *instructions, const StringPool *pool);
+
+/**
+ * @brief Flushes the remaining bytes and frees the dump.
+ *
+ * @param dump Dump to close (may be NULL).
+ * @return true if every write succeeded.
+ */
+bool token_dump_close(TokenDump *dump);
+
+/**
+ * @brief Renders a dump as text, one token per line in the token_to_str() format.
+ *
+ * @param in Dump to read.
+ * @param out Text output.
+ * @return true on success, false if the dump is malformed or truncated (output stops there).
+ */
+bool token_dump_render(FILE *in, FILE *out);
+
+#endif // TOKEN_DUMP_H
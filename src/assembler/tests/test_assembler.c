@@ -0,0 +1,149 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <assembler.h>
+
+static const char *PROGRAM =
+    "// Adds R0 and R1\n"
+    "@R0\n"
+    "D=M\n"
+    "(LOOP)\n"
+    "@LOOP\n"
+    "0;JMP\n";
+
+/**
+ * @brief Assemble PROGRAM in the given format and return the target image (caller frees).
+ */
+static uint8_t *assemble(const OutputFormat format, size_t *size) {
+    FILE *source = fmemopen((void *)PROGRAM, strlen(PROGRAM), "r");
+    char *image = NULL;
+    FILE *target = open_memstream(&image, size);
+    assert(source && target);
+
+    const AssemblerConfig config = {
+        .source_asm = source,
+        .source_filepath = "test.asm",
+        .target_hack = target,
+        .target_filepath = "test.out",
+        .format = format,
+    };
+    Assembler *assembler = assembler_create(&config);
+    assert(assembler);
+    assert(assembler_assemble(assembler) == 0);
+    assembler_free(assembler);
+    fclose(source);
+    fclose(target);
+    return (uint8_t *)image;
+}
+
+void test_text_format(void) {
+    size_t size = 0;
+    uint8_t *text = assemble(OUTPUT_FORMAT_HACK, &size);
+    const char *expected =
+        "0000000000000000\n"
+        "1111110000010000\n"
+        "0000000000000010\n"
+        "1110101010000111\n";
+    assert(size == strlen(expected));
+    assert(memcmp(text, expected, size) == 0);
+    free(text);
+    printf("\t✅ test_text_format passed!\n");
+}
+
+void test_packed_format(void) {
+    size_t size = 0;
+    uint8_t *image = assemble(OUTPUT_FORMAT_BIN, &size);
+    assert(size == HACK_ROM_HEADER_SIZE + 4 * sizeof(uint16_t));
+
+    HackRomHeader header;
+    assert(assembler_rom_validate(image, size, &header));
+    assert(memcmp(header.magic, HACK_ROM_MAGIC, 4) == 0);
+    assert(header.version == HACK_ROM_VERSION);
+    assert(header.word_count == 4);
+
+    // Words are little-endian
+    const uint8_t *words = image + header.header_size;
+    const uint8_t expected[] = {0x00, 0x00, 0x10, 0xFC, 0x02, 0x00, 0x87, 0xEA};
+    assert(memcmp(words, expected, sizeof(expected)) == 0);
+    assert(header.checksum == assembler_rom_checksum(expected, 4));
+
+    // Corruption and truncation are rejected
+    image[HACK_ROM_HEADER_SIZE + 3] ^= 0x01;
+    assert(!assembler_rom_validate(image, size, &header));
+    image[HACK_ROM_HEADER_SIZE + 3] ^= 0x01;
+    assert(!assembler_rom_validate(image, size - 1, &header));
+    image[0] = 'X';
+    assert(!assembler_rom_validate(image, size, &header));
+
+    free(image);
+    printf("\t✅ test_packed_format passed!\n");
+}
+
+void test_rom_checksum(void) {
+    // Fletcher-32 reference values, and sums that span several deferred-modulo blocks
+    assert(assembler_rom_checksum(NULL, 0) == 0xFFFFFFFF);
+    const uint8_t abcde[] = {'a', 'b', 'c', 'd', 'e', 0};
+    assert(assembler_rom_checksum(abcde, 3) == 0xF04FC729);
+
+    const size_t count = 1000;
+    uint8_t *ones = malloc(count * 2);
+    assert(ones);
+    memset(ones, 0xFF, count * 2);
+    uint32_t sum1 = 0xFFFF, sum2 = 0xFFFF;
+    for (size_t i = 0; i < count; i++) {
+        sum1 = (sum1 + 0xFFFF) % 0xFFFF;
+        sum2 = (sum2 + sum1) % 0xFFFF;
+    }
+    const uint32_t checksum = assembler_rom_checksum(ones, count);
+    assert((checksum & 0xFFFF) % 0xFFFF == sum1 && (checksum >> 16) % 0xFFFF == sum2);
+    free(ones);
+    printf("\t✅ test_rom_checksum passed!\n");
+}
+
+void test_reset(void) {
+    // The second program uses the first one's label name as a variable
+    const char *programs[] = {"(NEXT)\n@NEXT\n0;JMP\n", "@NEXT\nM=1\n"};
+    const char *expected[] = {"0000000000000000\n1110101010000111\n", "0000000000010000\n1110111111001000\n"};
+
+    Assembler *assembler = NULL;
+    for (int i = 0; i < 2; i++) {
+        FILE *source = fmemopen((void *)programs[i], strlen(programs[i]), "r");
+        char *text = NULL;
+        size_t size = 0;
+        FILE *target = open_memstream(&text, &size);
+        const AssemblerConfig config = {
+            .source_asm = source,
+            .source_filepath = "reset.asm",
+            .target_hack = target,
+            .target_filepath = "reset.hack",
+            .jobs = 1,
+        };
+        if (!assembler) {
+            assembler = assembler_create(&config);
+        } else {
+            assert(assembler_reset(assembler, &config));
+        }
+        assert(assembler);
+        assert(assembler_assemble(assembler) == 0);
+        fclose(source);
+        fclose(target);
+        assert(strcmp(text, expected[i]) == 0);
+        free(text);
+    }
+
+    const AssemblerConfig invalid = {0};
+    assert(!assembler_reset(assembler, &invalid));
+    assembler_free(assembler);
+    printf("\t✅ test_reset passed!\n");
+}
+
+int main(void) {
+    test_text_format();
+    test_packed_format();
+    test_rom_checksum();
+    test_reset();
+    return 0;
+}
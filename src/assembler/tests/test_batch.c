@@ -0,0 +1,81 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "batch.h"
+
+static char dir[64];
+
+static void write_file(const char *path, const char *text) {
+    FILE *file = fopen(path, "w");
+    assert(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+static FileList *list_of(const char *first, const char *second) {
+    FileList *list = file_list_new();
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", dir, first);
+    assert(list && file_list_add(list, path, EXT_ASM));
+    snprintf(path, sizeof(path), "%s/%s", dir, second);
+    assert(file_list_add(list, path, EXT_ASM));
+    file_list_sort(list);
+    file_list_remove_duplicates(list);
+    return list;
+}
+
+void test_batch_target_clash(void) {
+    char path[128], out[128];
+    snprintf(path, sizeof(path), "%s/d1", dir);
+    assert(mkdir(path, 0755) == 0);
+    snprintf(path, sizeof(path), "%s/d2", dir);
+    assert(mkdir(path, 0755) == 0);
+    snprintf(out, sizeof(out), "%s/out", dir);
+    assert(mkdir(out, 0755) == 0);
+    snprintf(path, sizeof(path), "%s/d1/Main.asm", dir);
+    write_file(path, "@1\n");
+    snprintf(path, sizeof(path), "%s/d1/Other.asm", dir);
+    write_file(path, "@2\n");
+    snprintf(path, sizeof(path), "%s/d2/Main.asm", dir);
+    write_file(path, "@3\n");
+
+    // Sources with one base name clash in a shared output directory, but not next to their sources
+    BatchOptions options = {.output_dir = out, .format = OUTPUT_FORMAT_HACK};
+    FileList *list = list_of("d1", "d2/Main.asm");
+    assert(list->count == 3);
+    size_t clash[2];
+    assert(batch_find_target_clash(list, &options, clash) == 1);
+    assert(strcmp(list->files[clash[0]].base_name, "Main") == 0 && strstr(list->files[clash[0]].full_path, "d1"));
+    assert(strcmp(list->files[clash[1]].base_name, "Main") == 0 && strstr(list->files[clash[1]].full_path, "d2"));
+    options.output_dir = NULL;
+    assert(batch_find_target_clash(list, &options, clash) == 0);
+    file_list_free(list);
+
+    // Distinct names share an output directory fine
+    options.output_dir = out;
+    list = list_of("d1/Main.asm", "d1/Other.asm");
+    assert(batch_find_target_clash(list, &options, clash) == 0);
+    file_list_free(list);
+
+    // One file spelled two ways still has a single output
+    options.output_dir = NULL;
+    list = list_of("d1/Main.asm", "./d1/Main.asm");
+    assert(list->count == 2 && batch_find_target_clash(list, &options, clash) == 1);
+    file_list_free(list);
+    printf("\t✅ test_batch_target_clash passed!\n");
+}
+
+int main(void) {
+    snprintf(dir, sizeof(dir), "/tmp/test_batch_XXXXXX");
+    assert(mkdtemp(dir));
+    test_batch_target_clash();
+
+    char command[128];
+    snprintf(command, sizeof(command), "rm -rf '%s'", dir);
+    assert(system(command) == 0);
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.h"
+
+static char dir[64];
+
+static void write_file(const char *path, const char *text) {
+    FILE *file = fopen(path, "w");
+    assert(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+static void path_in(char *out, const char *name) {
+    snprintf(out, 128, "%s/%s", dir, name);
+}
+
+void test_cache_hash(void) {
+    // XXH64 reference values
+    assert(build_cache_hash("", 0, 0) == 0xEF46DB3751D8E999ULL);
+    assert(build_cache_hash("a", 1, 0) == 0xD24EC4F1A98C6E5BULL);
+    assert(build_cache_hash("abc", 3, 0) == 0x44BC2CF5AD770999ULL);
+    const char *long_text = "Nobody inspects the spammish repetition";
+    assert(build_cache_hash(long_text, strlen(long_text), 0) == 0xFBCEA83C8A378BF1ULL);
+    printf("\t✅ test_cache_hash passed!\n");
+}
+
+void test_cache_fetch_and_store(void) {
+    char source[128], target[128], cache_dir[128];
+    path_in(source, "prog.asm");
+    path_in(target, "prog.hack");
+    path_in(cache_dir, "cache");
+    write_file(source, "@1\nD=A\n");
+
+    BuildCache *cache = build_cache_open(cache_dir, 0);
+    assert(cache);
+    char key[BUILD_CACHE_KEY_LENGTH + 1], bin_key[BUILD_CACHE_KEY_LENGTH + 1];
+    assert(build_cache_key(source, OUTPUT_FORMAT_HACK, key));
+    assert(build_cache_key(source, OUTPUT_FORMAT_BIN, bin_key));
+    assert(strlen(key) == BUILD_CACHE_KEY_LENGTH && strcmp(key, bin_key) != 0);
+
+    // Miss, then store what a real run wrote
+    assert(!build_cache_fetch(cache, key, OUTPUT_FORMAT_HACK, target));
+    write_file(target, "output\n");
+    assert(build_cache_store(cache, key, OUTPUT_FORMAT_HACK, target));
+    unlink(target);
+
+    // A hit links the entry into place, replacing whatever was there
+    write_file(target, "stale\n");
+    assert(build_cache_fetch(cache, key, OUTPUT_FORMAT_HACK, target));
+    char text[32] = "";
+    FILE *file = fopen(target, "r");
+    assert(file && fgets(text, sizeof(text), file));
+    fclose(file);
+    assert(strcmp(text, "output\n") == 0);
+
+    // Detaching the linked output protects the entry from being rewritten in place
+    struct stat info;
+    assert(stat(target, &info) == 0 && info.st_nlink == 2);
+    build_cache_detach(target);
+    assert(access(target, F_OK) != 0);
+    assert(build_cache_fetch(cache, key, OUTPUT_FORMAT_HACK, target));
+
+    // Changed sources get another key
+    write_file(source, "@2\nD=A\n");
+    char changed[BUILD_CACHE_KEY_LENGTH + 1];
+    assert(build_cache_key(source, OUTPUT_FORMAT_HACK, changed));
+    assert(strcmp(changed, key) != 0);
+    assert(!build_cache_fetch(cache, changed, OUTPUT_FORMAT_HACK, target));
+    build_cache_close(cache);
+
+    unlink(source);
+    unlink(target);
+    printf("\t✅ test_cache_fetch_and_store passed!\n");
+}
+
+void test_cache_eviction(void) {
+    char target[128], cache_dir[128];
+    path_in(target, "big.hack");
+    path_in(cache_dir, "small");
+
+    // Three 600 KiB entries under a 1 MiB limit: only the most recently used one survives
+    char *data = malloc(600 << 10);
+    assert(data);
+    memset(data, 'x', 600 << 10);
+    data[(600 << 10) - 1] = '\0';
+    write_file(target, data);
+    free(data);
+
+    const char *keys[] = {"00000000000000000000000000000001", "00000000000000000000000000000002",
+                          "00000000000000000000000000000003"};
+    BuildCache *cache = build_cache_open(cache_dir, 1 << 20);
+    assert(cache);
+    for (int i = 0; i < 3; i++) {
+        assert(build_cache_store(cache, keys[i], OUTPUT_FORMAT_HACK, target));
+        usleep(20000);  // Distinct mtimes
+    }
+    assert(build_cache_fetch(cache, keys[0], OUTPUT_FORMAT_HACK, target));  // Most recently used now
+    build_cache_close(cache);
+
+    cache = build_cache_open(cache_dir, 1 << 20);
+    assert(build_cache_fetch(cache, keys[0], OUTPUT_FORMAT_HACK, target));
+    assert(!build_cache_fetch(cache, keys[1], OUTPUT_FORMAT_HACK, target));
+    assert(!build_cache_fetch(cache, keys[2], OUTPUT_FORMAT_HACK, target));
+    build_cache_close(cache);
+
+    unlink(target);
+    char entry[256];
+    snprintf(entry, sizeof(entry), "%s/%s.hack", cache_dir, keys[0]);
+    unlink(entry);
+    printf("\t✅ test_cache_eviction passed!\n");
+}
+
+int main(void) {
+    snprintf(dir, sizeof(dir), "/tmp/test_cache_XXXXXX");
+    assert(mkdtemp(dir));
+
+    test_cache_hash();
+    test_cache_fetch_and_store();
+    test_cache_eviction();
+
+    char command[256];
+    snprintf(command, sizeof(command), "rm -rf '%s'", dir);
+    assert(system(command) == 0);
+    return 0;
+}
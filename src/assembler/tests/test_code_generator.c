@@ -44,6 +44,56 @@ int main(void) {
     generate_binary(&invalid_instr, binary_output);
     assert(strcmp(binary_output, "0000000000000000") == 0);
 
+    // Encoded words match the ASCII output
+    c_instr.comp = TOKEN_COMP_DPLUSM;
+    c_instr.dest = TOKEN_DEST_AMD;
+    c_instr.jump = TOKEN_JUMP_JMP;
+    assert(encode_instruction(&c_instr) == 0xF0BF);  // 1111000010111111
+    generate_binary(&c_instr, binary_output);
+    assert(strcmp(binary_output, "1111000010111111") == 0);
+
+    a_instr.value = 32767;
+    assert(encode_instruction(&a_instr) == 0x7FFF);
+    assert(encode_instruction(&invalid_instr) == 0);
+
+    // Byte-table conversion covers both halves of the word
+    char ascii[16];
+    word_to_ascii(0x8001, ascii);
+    assert(memcmp(ascii, "1000000000000001", 16) == 0);
+    word_to_ascii(0x5AA5, ascii);
+    assert(memcmp(ascii, "0101101010100101", 16) == 0);
+
+    // Packed records keep final words, and unpack to the same mnemonics
+    PackedInstruction packed;
+    Instruction unpacked;
+    for (int comp = TOKEN_COMP_0; comp <= TOKEN_COMP_DORM; comp++) {
+        for (int field = 0; field < 8; field++) {
+            c_instr.comp = comp;
+            c_instr.dest = TOKEN_DEST_NULL + field;
+            c_instr.jump = TOKEN_JUMP_NULL + (7 - field);
+            assert(pack_instruction(&c_instr, &packed) && PACKED_KIND(packed) == PACKED_WORD);
+            assert(PACKED_WORD_VALUE(packed) == encode_instruction(&c_instr));
+            unpack_instruction(packed, &unpacked);
+            assert(unpacked.type == C_INSTRUCTION && unpacked.comp == comp && unpacked.dest == c_instr.dest &&
+                   unpacked.jump == c_instr.jump);
+        }
+    }
+    a_instr.value = 0x6000;  // High bits of an address must not read as a C-instruction
+    assert(pack_instruction(&a_instr, &packed) && PACKED_WORD_VALUE(packed) == 0x6000);
+    unpack_instruction(packed, &unpacked);
+    assert(unpacked.type == A_INSTRUCTION_VALUE && unpacked.value == 0x6000);
+
+    const Instruction label = {.type = L_INSTRUCTION, .symbol = 12345};
+    assert(pack_instruction(&label, &packed) && PACKED_KIND(packed) == PACKED_LABEL);
+    unpack_instruction(packed, &unpacked);
+    assert(unpacked.type == L_INSTRUCTION && unpacked.symbol == 12345);
+    const Instruction reference = {.type = A_INSTRUCTION_SYMBOL, .symbol = PACKED_ID_MAX};
+    assert(pack_instruction(&reference, &packed) && PACKED_KIND(packed) == PACKED_SYMBOL);
+    assert(PACKED_PAYLOAD(packed) == PACKED_ID_MAX);
+    const Instruction too_large = {.type = A_INSTRUCTION_SYMBOL, .symbol = PACKED_ID_MAX + 1};
+    assert(!pack_instruction(&too_large, &packed) && !pack_instruction(&invalid_instr, &packed));
+    assert(encode_address(16) == 16 && encode_address(0x8010) == 0x10);
+
     printf("\t✅ test_code_generator passed!\n");
     return 0;
 }
@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "line_scanner.h"
+
+static bool ref_is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Straightforward per-line reference: split on '\n', cut at "//", trim whitespace
+static size_t reference_next(const char *source, const size_t pos, const size_t size, ScannedLine *line) {
+    size_t line_end = pos;
+    while (line_end < size && source[line_end] != '\n') line_end++;
+    size_t end = line_end;
+    for (size_t i = pos; i + 1 < line_end; i++) {
+        if (source[i] == '/' && source[i + 1] == '/') {
+            end = i;
+            break;
+        }
+    }
+    size_t start = pos;
+    while (start < end && ref_is_space(source[start])) start++;
+    while (end > start && ref_is_space(source[end - 1])) end--;
+
+    line->next = line_end + 1;
+    line->spaced = false;
+    if (start == end) {
+        line->start = line->end = pos;
+        line->type = LINE_BLANK;
+        return line->next;
+    }
+    line->start = start;
+    line->end = end;
+    line->type = source[start] == '(' ? LINE_LABEL : source[start] == '@' ? LINE_A_INSTRUCTION : LINE_C_INSTRUCTION;
+    for (size_t i = start; i < end; i++) {
+        if (ref_is_space(source[i])) line->spaced = true;
+    }
+    return line->next;
+}
+
+static void check_against_reference(const char *source, const size_t size) {
+    LineScanner scanner;
+    ScannedLine line, expected;
+    line_scanner_init(&scanner, source, 0, size);
+    size_t pos = 0;
+    while (pos < size) {
+        pos = reference_next(source, pos, size, &expected);
+        assert(line_scanner_next(&scanner, &line));
+        assert(line.type == expected.type);
+        assert(line.next == expected.next);
+        if (expected.type != LINE_BLANK) {
+            assert(line.start == expected.start);
+            assert(line.end == expected.end);
+            assert(line.spaced == expected.spaced);
+        }
+    }
+    assert(!line_scanner_next(&scanner, &line));
+}
+
+void test_classification(void) {
+    const char *source =
+        "@21\n"
+        "  D = M   // comment\r\n"
+        "(LOOP)\n"
+        "\n"
+        "   // only a comment\n"
+        "\t\f\v\r\n"
+        "0;JMP";
+    const size_t size = strlen(source);
+    const LineType expected[] = {LINE_A_INSTRUCTION, LINE_C_INSTRUCTION, LINE_LABEL, LINE_BLANK,
+                                 LINE_BLANK, LINE_BLANK, LINE_C_INSTRUCTION};
+
+    LineScanner scanner;
+    ScannedLine line;
+    line_scanner_init(&scanner, source, 0, size);
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        assert(line_scanner_next(&scanner, &line));
+        assert(line.type == expected[i]);
+        if (i == 1) {
+            assert(line.end - line.start == 5 && memcmp(source + line.start, "D = M", 5) == 0);
+            assert(line.spaced);
+        }
+        if (i == 6) {
+            assert(memcmp(source + line.start, "0;JMP", 5) == 0 && line.end == size);
+            assert(!line.spaced);
+        }
+    }
+    assert(!line_scanner_next(&scanner, &line));
+    check_against_reference(source, size);
+    printf("\t✅ test_classification passed!\n");
+}
+
+void test_random_sources(void) {
+    // Alphabet weighted towards the characters the scanner cares about
+    const char alphabet[] = "\n\n\n//  \t\r\v\f@(AMD=;01-+JGT_x";
+    const size_t size = 20000;
+    char *source = malloc(size);
+    assert(source);
+
+    srand(1234);
+    for (int round = 0; round < 50; round++) {
+        for (size_t i = 0; i < size; i++) {
+            source[i] = alphabet[rand() % (int)(sizeof(alphabet) - 1)];
+        }
+        // Sprinkle in lines longer than one 64-byte window
+        if (round % 5 == 0) memset(source + 1000, 'A', 300);
+        if (round % 7 == 0) memset(source + 5000, ' ', 200);
+        check_against_reference(source, size - (size_t)round);
+    }
+    free(source);
+    printf("\t✅ test_random_sources passed!\n");
+}
+
+int main(void) {
+    test_classification();
+    test_random_sources();
+    return 0;
+}
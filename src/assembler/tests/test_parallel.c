@@ -0,0 +1,178 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parallel.h"
+#include "instruction.h"
+#include <thread_pool.h>
+
+typedef struct {
+    StringPool *string_pool;
+    TokenTable *instructions;  // Packed instruction records
+    SymbolTable *symbol_table;
+    int rom_address;
+    int line_count;
+    ScannedLine error_line;
+    ProcessStatus status;
+} FirstPass;
+
+// Builds a program spanning several parallel chunks, with labels redefined across chunks
+static char *build_program(const size_t min_size, size_t *size) {
+    size_t capacity = min_size + 4096;
+    char *program = malloc(capacity);
+    assert(program);
+    size_t length = 0;
+    for (int block = 0; length < min_size; block++) {
+        length += (size_t)snprintf(program + length, capacity - length,
+                                   "(BLOCK_%d)\n"
+                                   "  @counter_%d   // variable\n"
+                                   "\tD = M\n"
+                                   "(SHARED_%d)\n"
+                                   "@BLOCK_%d\n"
+                                   "\n"
+                                   "D;JGT\r\n",
+                                   block, block % 97, block % 13, block / 2);
+    }
+    *size = length;
+    return program;
+}
+
+static FirstPass run(const char *program, const size_t size, const unsigned jobs) {
+    FirstPass pass = {0};
+    pass.string_pool = string_pool_create();
+    pass.instructions = token_table_create(sizeof(PackedInstruction), NULL, NULL);
+    pass.symbol_table = symbol_table_create(pass.string_pool);
+    assert(pass.string_pool && pass.instructions && pass.symbol_table);
+    pass.status = parallel_lex_source(program, size, jobs, pass.instructions, pass.string_pool,
+                                      pass.symbol_table, &pass.rom_address, &pass.line_count, &pass.error_line);
+    return pass;
+}
+
+static void free_pass(FirstPass *pass) {
+    symbol_table_free(pass->symbol_table);
+    token_table_free(pass->instructions);
+    string_pool_free(pass->string_pool);
+}
+
+static void assert_same(const FirstPass *a, const FirstPass *b) {
+    assert(a->status == b->status);
+    assert(a->rom_address == b->rom_address);
+    assert(a->line_count == b->line_count);
+
+    // Same strings interned in the same order, so symbol ids match directly
+    assert(string_pool_count(a->string_pool) == string_pool_count(b->string_pool));
+    for (StringId id = 0; id < string_pool_count(a->string_pool); id++) {
+        assert(strcmp(string_pool_get(a->string_pool, id), string_pool_get(b->string_pool, id)) == 0);
+        assert(symbol_table_get_address_id(a->symbol_table, id) == symbol_table_get_address_id(b->symbol_table, id));
+    }
+    assert(token_table_size(a->instructions) == token_table_size(b->instructions));
+    for (size_t i = 0; i < token_table_size(a->instructions); i++) {
+        assert(memcmp(token_table_get(a->instructions, i), token_table_get(b->instructions, i),
+                      sizeof(PackedInstruction)) == 0);
+    }
+}
+
+void test_parallel_matches_sequential(void) {
+    size_t size = 0;
+    char *program = build_program(5 * PARALLEL_MIN_CHUNK_SIZE, &size);
+
+    FirstPass sequential = run(program, size, 1);
+    assert(sequential.status == PROCESS_SUCCESS);
+    for (unsigned jobs = 2; jobs <= 6; jobs += 2) {
+        FirstPass parallel = run(program, size, jobs);
+        assert_same(&sequential, &parallel);
+        free_pass(&parallel);
+    }
+    free_pass(&sequential);
+    free(program);
+    printf("\t✅ test_parallel_matches_sequential passed!\n");
+}
+
+void test_parallel_reports_first_error(void) {
+    size_t size = 0;
+    char *program = build_program(4 * PARALLEL_MIN_CHUNK_SIZE, &size);
+
+    // Two bad lines in different chunks; only the earlier one is reported
+    char *second = strstr(program + size / 2, "D;JGT");
+    memcpy(second, "D;JXX", 5);
+    char *first = strstr(program + size / 3, "D = M");
+    memcpy(first, "D = Q", 5);
+
+    FirstPass sequential = run(program, size, 1);
+    FirstPass parallel = run(program, size, 4);
+    assert(sequential.status == PROCESS_INVALID);
+    assert_same(&sequential, &parallel);
+    assert(parallel.error_line.start == (size_t)(first - program));
+
+    free_pass(&parallel);
+    free_pass(&sequential);
+    free(program);
+    printf("\t✅ test_parallel_reports_first_error passed!\n");
+}
+
+static void write_word(const uint16_t word, char *destination) {
+    memcpy(destination, &word, sizeof(word));
+}
+
+void test_parallel_encode_matches_sequential(void) {
+    size_t size = 0;
+    char *program = build_program(5 * PARALLEL_MIN_CHUNK_SIZE, &size);
+
+    uint16_t *images[2];
+    int ram_addresses[2];
+    const unsigned jobs[2] = {1, 5};
+    for (int run_index = 0; run_index < 2; run_index++) {
+        FirstPass pass = run(program, size, 1);
+        assert(pass.status == PROCESS_SUCCESS);
+        const size_t capacity = (size_t)pass.rom_address;
+        images[run_index] = calloc(capacity, sizeof(uint16_t));
+        assert(images[run_index]);
+
+        size_t count = 0;
+        ram_addresses[run_index] = 16;
+        assert(parallel_encode(pass.instructions, pass.symbol_table, jobs[run_index], &ram_addresses[run_index],
+                               (char *)images[run_index], sizeof(uint16_t), capacity, write_word, &count) ==
+               PROCESS_SUCCESS);
+        assert(count == capacity);
+
+        // Variables are allocated in first-use order: counter_0 is the first one referenced
+        const StringId counter = string_pool_find(pass.string_pool, "counter_0", 9);
+        assert(symbol_table_get_address_id(pass.symbol_table, counter) == 16);
+        assert(images[run_index][0] == 16);
+        free_pass(&pass);
+
+        // Too small an image is refused instead of overrun
+        pass = run(program, size, 1);
+        assert(parallel_encode(pass.instructions, pass.symbol_table, jobs[run_index], &(int){16},
+                               (char *)images[run_index], sizeof(uint16_t), capacity - 1, write_word, &count) ==
+               PROCESS_ERROR);
+        free_pass(&pass);
+    }
+    assert(ram_addresses[0] == 16 + 97);
+    assert(ram_addresses[0] == ram_addresses[1]);
+
+    FirstPass pass = run(program, size, 1);
+    assert(memcmp(images[0], images[1], (size_t)pass.rom_address * sizeof(uint16_t)) == 0);
+    free_pass(&pass);
+
+    free(images[0]);
+    free(images[1]);
+    free(program);
+    printf("\t✅ test_parallel_encode_matches_sequential passed!\n");
+}
+
+int main(void) {
+    // The parallel stages run on the global pool
+    ThreadPool *pool = thread_pool_create(4, false);
+    assert(pool);
+    thread_pool_set_global(pool);
+
+    test_parallel_matches_sequential();
+    test_parallel_reports_first_error();
+    test_parallel_encode_matches_sequential();
+
+    thread_pool_set_global(NULL);
+    thread_pool_free(pool);
+    return 0;
+}
@@ -8,36 +8,48 @@
 #include <token_table.h>
 #include <lexer.h>
 #include <instruction.h>
+#include <code_generator.h>
 #include <string.h>
 #include <stdio.h>
 
 void test_parser(void);
+void test_fused_front_end(void);
+void test_mnemonic_lookup(void);
 
 int main(void) {
     test_parser();
+    test_fused_front_end();
+    test_mnemonic_lookup();
     return 0;
 }
 
 void test_parser(void) {
-    SymbolTable *symbol_table = symbol_table_create();
+    StringPool *string_pool = string_pool_create();
+    SymbolTable *symbol_table = symbol_table_create(string_pool);
     int rom_address = 0;
-    TokenTable *table = token_table_create((TokenFreeFunc)free_token, (TokenToStr)token_to_str);
+    TokenTable *table = token_table_create(sizeof(Token), NULL, (TokenToStr)token_to_str);
 
     Parser *parser = parser_create(table, symbol_table);
 
     // === Input program with all 3 instruction types ===
-    char *program[] = {
-        "@21",
-        "D=M",
-        "(LOOP)",
-        "D;JGT",
-        NULL
-    };
+    const char *program =
+        "@21\n"
+        "  D = M   // comment\n"
+        "(LOOP)\n"
+        "\n"
+        "D;JGT";
 
-    // Lex all lines first
-    for (int i = 0; program[i] != NULL; i++) {
-        assert(lex_line(program[i], strlen(program[i]), table, symbol_table, &rom_address) == PROCESS_SUCCESS);
+    // Lex all lines first (in place, no copy of the program is made)
+    size_t line_start = 0;
+    const size_t program_size = strlen(program);
+    while (line_start < program_size) {
+        const char *newline = strchr(program + line_start, '\n');
+        const size_t line_end = newline ? (size_t)(newline - program) : program_size;
+        assert(lex_line(program, line_start, line_end - line_start, table, string_pool,
+                        symbol_table, &rom_address) == PROCESS_SUCCESS);
+        line_start = line_end + 1;
     }
+    assert(rom_address == 3);
 
     token_table_reset(table);
 
@@ -59,7 +71,8 @@ void test_parser(void) {
     assert(parser_has_more_commands(parser));
     assert(advance(parser));
     assert(parser->instruction->type == L_INSTRUCTION);
-    assert(strcmp(parser->instruction->symbol, "LOOP") == 0);
+    assert(strcmp(string_pool_get(string_pool, parser->instruction->symbol), "LOOP") == 0);
+    assert(symbol_table_get_address_id(symbol_table, parser->instruction->symbol) == 2);
 
     // === Parse and check C-instruction with jump ===
     assert(parser_has_more_commands(parser));
@@ -76,5 +89,147 @@ void test_parser(void) {
     parser_free(parser);
     token_table_free(table);
     symbol_table_free(symbol_table);
+    string_pool_free(string_pool);
     printf("\t✅ test_parser passed!\n");
 }
+
+void test_fused_front_end(void) {
+    const char *program =
+        "(START)\n"
+        "  @counter   // variable\n"
+        "\tAM = M+1 ; JNE\n"
+        "@32767\n"
+        "\n"
+        "0;JMP\r\n";
+    const size_t program_size = strlen(program);
+
+    // Token stream parsed back by the parser
+    StringPool *token_pool = string_pool_create();
+    SymbolTable *token_symbols = symbol_table_create(token_pool);
+    TokenTable *tokens = token_table_create(sizeof(Token), NULL, (TokenToStr)token_to_str);
+    int token_rom = 0, token_lines = 0;
+    ScannedLine error_line;
+    assert(lex_source(program, 0, program_size, tokens, token_pool, token_symbols, &token_rom, &token_lines,
+                      &error_line) == PROCESS_SUCCESS);
+
+    // Instruction records straight from the source
+    StringPool *pool = string_pool_create();
+    SymbolTable *symbols = symbol_table_create(pool);
+    TokenTable *instructions = token_table_create(sizeof(PackedInstruction), NULL, NULL);
+    int rom = 0, lines = 0;
+    assert(lex_source_instructions(program, 0, program_size, instructions, pool, symbols, &rom, &lines,
+                                   &error_line) == PROCESS_SUCCESS);
+    assert(rom == token_rom && rom == 4 && lines == token_lines);
+    assert(token_table_size(instructions) == 5);
+
+    // Every record matches what the parser makes of the tokens, and expands back to those tokens
+    Parser *parser = parser_create(tokens, token_symbols);
+    size_t token_index = 0;
+    for (size_t i = 0; i < token_table_size(instructions); i++) {
+        Instruction record;
+        unpack_instruction(*(const PackedInstruction *)token_table_get(instructions, i), &record);
+        assert(parser_has_more_commands(parser) && advance(parser));
+        const Instruction *parsed = parser->instruction;
+        assert(record.type == parsed->type);
+        if (record.type == C_INSTRUCTION) {
+            assert(record.dest == parsed->dest && record.comp == parsed->comp && record.jump == parsed->jump);
+        } else {
+            assert(record.value == parsed->value);
+        }
+
+        Token expanded[INSTRUCTION_MAX_TOKENS];
+        const size_t count = instruction_to_tokens(&record, expanded);
+        for (size_t j = 0; j < count; j++) {
+            const Token *token = token_table_get(tokens, token_index++);
+            assert(expanded[j].type == token->type);
+            assert(token->type != TOKEN_SYMBOL || expanded[j].value.symbol == token->value.symbol);
+            assert(token->type != TOKEN_INTEGER || expanded[j].value.integer == token->value.integer);
+        }
+    }
+    assert(!parser_has_more_commands(parser) && token_index == token_table_size(tokens));
+
+    // Errors stop at the same line, without a partial record
+    const char *bad = "@1\nD=M\nAMD=X\n@2\n";
+    token_table_clear(instructions);
+    assert(lex_source_instructions(bad, 0, strlen(bad), instructions, pool, symbols, &rom, &lines,
+                                   &error_line) == PROCESS_INVALID);
+    assert(lines == 3 && token_table_size(instructions) == 2);
+
+    parser_free(parser);
+    token_table_free(instructions);
+    symbol_table_free(symbols);
+    string_pool_free(pool);
+    token_table_free(tokens);
+    symbol_table_free(token_symbols);
+    string_pool_free(token_pool);
+    printf("\t✅ test_fused_front_end passed!\n");
+}
+
+// Lexes a one-line program into 'instruction'
+static ProcessStatus lex_text(const char *text, Instruction *instruction) {
+    StringPool *pool = string_pool_create();
+    SymbolTable *symbols = symbol_table_create(pool);
+    TokenTable *table = token_table_create(sizeof(PackedInstruction), NULL, NULL);
+    int rom = 0, lines = 0;
+    ScannedLine error_line;
+    const ProcessStatus status = lex_source_instructions(text, 0, strlen(text), table, pool, symbols, &rom, &lines,
+                                                         &error_line);
+    if (status == PROCESS_SUCCESS) {
+        assert(token_table_size(table) == 1);
+        unpack_instruction(*(const PackedInstruction *)token_table_get(table, 0), instruction);
+    }
+    token_table_free(table);
+    symbol_table_free(symbols);
+    string_pool_free(pool);
+    return status;
+}
+
+void test_mnemonic_lookup(void) {
+    static const struct {
+        int token;
+        char text[8];
+    } comps[] = {
+#define COMP(token, bits, ...) {token, {__VA_ARGS__}},
+#include <mnemonics.def>
+    }, dests[] = {
+#define DEST(token, bits, ...) {token, {__VA_ARGS__}},
+#include <mnemonics.def>
+    }, jumps[] = {
+#define JUMP(token, bits, ...) {token, {__VA_ARGS__}},
+#include <mnemonics.def>
+    };
+    const size_t dest_count = sizeof(dests) / sizeof(dests[0]);
+    const size_t jump_count = sizeof(jumps) / sizeof(jumps[0]);
+
+    // Every mnemonic is found, alone and in combination
+    char line[32];
+    Instruction instruction;
+    for (size_t i = 0; i < sizeof(comps) / sizeof(comps[0]); i++) {
+        snprintf(line, sizeof(line), "%s=%s;%s\n", dests[i % dest_count].text, comps[i].text,
+                 jumps[i % jump_count].text);
+        assert(lex_text(line, &instruction) == PROCESS_SUCCESS);
+        assert(instruction.comp == comps[i].token && instruction.dest == dests[i % dest_count].token &&
+               instruction.jump == jumps[i % jump_count].token);
+        snprintf(line, sizeof(line), "%s\n", comps[i].text);
+        assert(lex_text(line, &instruction) == PROCESS_SUCCESS && instruction.comp == comps[i].token);
+    }
+    assert(lex_text("A M D = D | M ; J M P\n", &instruction) == PROCESS_SUCCESS);
+    assert(instruction.dest == TOKEN_DEST_AMD && instruction.comp == TOKEN_COMP_DORM &&
+           instruction.jump == TOKEN_JUMP_JMP);
+
+    // Near misses are not
+    const char *invalid[] = {
+        "DM=M\n", "AMDA=M\n", "=M\n", "D=M+D\n", "D=D+2\n", "D=\n", "D=M;JM\n", "D=M;JMPS\n",
+        "D=M;jmp\n", "0;\n", "(SCREEN)\n", "(R15)\n", "(AMD)\n", "(JGE)\n", "(TEMP)\n",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        assert(lex_text(invalid[i], &instruction) == PROCESS_INVALID);
+    }
+
+    // Names that only start or end like a keyword are ordinary labels
+    const char *labels[] = {"(SCREENS)\n", "(R16)\n", "(R1X)\n", "(THISX)\n", "(AMDD)\n", "(S)\n"};
+    for (size_t i = 0; i < sizeof(labels) / sizeof(labels[0]); i++) {
+        assert(lex_text(labels[i], &instruction) == PROCESS_SUCCESS && instruction.type == L_INSTRUCTION);
+    }
+    printf("\t✅ test_mnemonic_lookup passed!\n");
+}
@@ -0,0 +1,112 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "server.h"
+#include <thread_pool.h>
+
+static char socket_path[64];
+
+static void *run_server(void *arg) {
+    (void)arg;
+    assert(server_run(socket_path, 1) == EXIT_SUCCESS);
+    return NULL;
+}
+
+static int connect_when_ready(void) {
+    for (int attempt = 0; attempt < 200; attempt++) {
+        const int fd = server_connect(socket_path);
+        if (fd >= 0) return fd;
+        usleep(10000);
+    }
+    return -1;
+}
+
+static void assemble_inline(const int fd, const char *source, const int status, const char *expected) {
+    ServerReply reply;
+    assert(server_assemble_buffer(fd, "inline.asm", source, strlen(source), OUTPUT_FORMAT_HACK, false, &reply));
+    assert(reply.status == status);
+    if (expected) {
+        assert(reply.output_size == strlen(expected));
+        assert(reply.output_size == 0 || memcmp(reply.output, expected, reply.output_size) == 0);
+    }
+    server_reply_free(&reply);
+}
+
+void test_server_requests(void) {
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, run_server, NULL) == 0);
+    const int fd = connect_when_ready();
+    assert(fd >= 0);
+
+    // A single idle instance is reused, so the label must not leak into the next request as a symbol
+    assemble_inline(fd, "(NEXT)\n@NEXT\n0;JMP\n", 0, "0000000000000000\n1110101010000111\n");
+    assemble_inline(fd, "@NEXT\nM=1\n", 0, "0000000000010000\n1110111111001000\n");
+
+    // Errors come back with the request's log
+    ServerReply reply;
+    const char *bad = "@1\nnot an instruction\n";
+    assert(server_assemble_buffer(fd, "bad.asm", bad, strlen(bad), OUTPUT_FORMAT_HACK, false, &reply));
+    assert(reply.status != 0);
+    assert(reply.log && memmem(reply.log, reply.log_size, "bad.asm:2", 9));
+    assert(!memchr(reply.log, '\033', reply.log_size));  // Plain text unless the client asks for colors
+    server_reply_free(&reply);
+    assert(server_assemble_buffer(fd, "bad.asm", bad, strlen(bad), OUTPUT_FORMAT_HACK, true, &reply));
+    assert(reply.status != 0 && memchr(reply.log, '\033', reply.log_size));
+    server_reply_free(&reply);
+    assemble_inline(fd, "", 0, "");
+
+    // Path requests read and write files on the server side
+    char source_path[64], target_path[64];
+    snprintf(source_path, sizeof(source_path), "/tmp/test_server_%d.asm", (int)getpid());
+    snprintf(target_path, sizeof(target_path), "/tmp/test_server_%d.bin", (int)getpid());
+    FILE *source = fopen(source_path, "w");
+    assert(source);
+    fputs("@5\nD=A\n", source);
+    fclose(source);
+    assert(server_assemble_paths(fd, source_path, target_path, OUTPUT_FORMAT_BIN, false, &reply));
+    assert(reply.status == 0 && reply.output_size == 0);
+    server_reply_free(&reply);
+    FILE *target = fopen(target_path, "rb");
+    assert(target);
+    unsigned char image[64];
+    const size_t size = fread(image, 1, sizeof(image), target);
+    fclose(target);
+    HackRomHeader header;
+    assert(assembler_rom_validate(image, size, &header) && header.word_count == 2);
+    assert(server_assemble_paths(fd, "/nonexistent/x.asm", target_path, OUTPUT_FORMAT_HACK, false, &reply));
+    assert(reply.status != 0 && reply.log_size > 0);
+    server_reply_free(&reply);
+    unlink(source_path);
+    unlink(target_path);
+
+    // Shutdown is acknowledged and removes the socket file
+    const int control = server_connect(socket_path);
+    assert(control >= 0);
+    close(fd);
+    assert(server_shutdown(control));
+    close(control);
+    pthread_join(thread, NULL);
+    assert(access(socket_path, F_OK) != 0);
+    assert(server_connect(socket_path) < 0);
+
+    printf("\t✅ test_server_requests passed!\n");
+}
+
+int main(void) {
+    snprintf(socket_path, sizeof(socket_path), "/tmp/test_server_%d.sock", (int)getpid());
+
+    // Connections are served on the global pool
+    ThreadPool *pool = thread_pool_create(2, false);
+    assert(pool);
+    thread_pool_set_global(pool);
+
+    test_server_requests();
+
+    thread_pool_set_global(NULL);
+    thread_pool_free(pool);
+    return 0;
+}
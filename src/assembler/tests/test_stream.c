@@ -0,0 +1,179 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "assembler.h"
+#include "stream.h"
+
+typedef struct {
+    int fd;
+    char *data;
+    size_t size;
+} PipeReader;
+
+static void *read_pipe(void *arg) {
+    PipeReader *reader = arg;
+    size_t capacity = 1 << 16;
+    reader->data = malloc(capacity);
+    assert(reader->data);
+    ssize_t n;
+    while ((n = read(reader->fd, reader->data + reader->size, capacity - reader->size)) > 0) {
+        reader->size += (size_t)n;
+        if (reader->size == capacity) {
+            capacity *= 2;
+            reader->data = realloc(reader->data, capacity);
+            assert(reader->data);
+        }
+    }
+    return NULL;
+}
+
+static FILE *source_file(const char *text) {
+    FILE *file = tmpfile();
+    assert(file);
+    fputs(text, file);
+    rewind(file);
+    return file;
+}
+
+static int assemble(FILE *source, FILE *target, const OutputFormat format, const bool streaming) {
+    const AssemblerConfig config = {
+        .source_asm = source,
+        .source_filepath = "test.asm",
+        .target_hack = target,
+        .target_filepath = "test.out",
+        .format = format,
+        .jobs = 1,
+        .streaming = streaming,
+    };
+    Assembler *assembler = assembler_create(&config);
+    assert(assembler);
+    const int status = assembler_assemble(assembler);
+    assembler_free(assembler);
+    return status;
+}
+
+// Output of the two-pass assembler, for comparison
+static char *reference_output(const char *text, const OutputFormat format, size_t *size) {
+    FILE *source = source_file(text);
+    FILE *target = tmpfile();
+    assert(target);
+    assert(assemble(source, target, format, false) == 0);
+    fflush(target);
+    *size = (size_t)lseek(fileno(target), 0, SEEK_END);
+    char *data = malloc(*size + 1);
+    assert(data);
+    assert(pread(fileno(target), data, *size, 0) == (ssize_t)*size);
+    fclose(target);
+    fclose(source);
+    return data;
+}
+
+static void check_file_target(const char *text, const OutputFormat format) {
+    size_t expected_size;
+    char *expected = reference_output(text, format, &expected_size);
+
+    FILE *source = source_file(text);
+    FILE *target = tmpfile();
+    assert(target);
+    assert(assemble(source, target, format, true) == 0);
+
+    char *actual = malloc(expected_size + 1);
+    assert(actual);
+    assert(pread(fileno(target), actual, expected_size + 1, 0) == (ssize_t)expected_size);
+    assert(memcmp(actual, expected, expected_size) == 0);
+
+    free(actual);
+    free(expected);
+    fclose(target);
+    fclose(source);
+}
+
+static void check_pipe_target(const char *text, const OutputFormat format) {
+    size_t expected_size;
+    char *expected = reference_output(text, format, &expected_size);
+
+    int fds[2];
+    assert(pipe(fds) == 0);
+    PipeReader reader = {.fd = fds[0]};
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, read_pipe, &reader) == 0);
+
+    FILE *source = source_file(text);
+    FILE *target = fdopen(fds[1], "w");
+    assert(target);
+    assert(assemble(source, target, format, true) == 0);
+    fclose(target);
+    assert(pthread_join(thread, NULL) == 0);
+    close(fds[0]);
+
+    assert(reader.size == expected_size);
+    assert(expected_size == 0 || memcmp(reader.data, expected, expected_size) == 0);
+
+    free(reader.data);
+    free(expected);
+    fclose(source);
+}
+
+// A program spanning many read pieces and output windows, with labels referenced long before
+// they are defined and variables first used at different points
+static char *large_program(void) {
+    size_t capacity = 1 << 20;
+    size_t size = 0;
+    char *text = malloc(capacity);
+    assert(text);
+    for (int block = 0; block < 800; block++) {
+        if (size + 4096 > capacity) {
+            capacity *= 2;
+            text = realloc(text, capacity);
+            assert(text);
+        }
+        size += (size_t)sprintf(text + size, "// block %d\n@END\n0;JMP\n@var%d\nM=D\n", block, block % 37);
+        if (block % 50 == 49) size += (size_t)sprintf(text + size, "(FORWARD%d)\n", block / 50);
+        for (int i = 0; i < 20; i++) size += (size_t)sprintf(text + size, "  @%d\n  D=D+A // add\n", block + i);
+        size += (size_t)sprintf(text + size, "@FORWARD%d\nD;JGT\n@SCREEN\n", (block + 60) / 50 % 8);
+    }
+    sprintf(text + size, "(END)\n@END\n0;JMP");  // No newline at the very end
+    return text;
+}
+
+void test_stream_small(void) {
+    const char *text = "@x\nD=A\n(x)\n@y\nM=1\n@x\n@y\n@R2\n(LOOP)\n@LOOP\n0;JMP\n";
+    check_file_target(text, OUTPUT_FORMAT_HACK);
+    check_pipe_target(text, OUTPUT_FORMAT_HACK);
+    check_pipe_target(text, OUTPUT_FORMAT_BIN);
+    check_pipe_target("", OUTPUT_FORMAT_HACK);
+    check_pipe_target("// only a comment\n", OUTPUT_FORMAT_BIN);
+    printf("\t✅ test_stream_small passed!\n");
+}
+
+void test_stream_large(void) {
+    char *text = large_program();
+    assert(strlen(text) > 4 * STREAM_READ_SIZE);
+    check_file_target(text, OUTPUT_FORMAT_HACK);
+    check_file_target(text, OUTPUT_FORMAT_BIN);
+    check_pipe_target(text, OUTPUT_FORMAT_HACK);
+    check_pipe_target(text, OUTPUT_FORMAT_BIN);
+    free(text);
+    printf("\t✅ test_stream_large passed!\n");
+}
+
+void test_stream_errors(void) {
+    FILE *source = source_file("@1\nD=A\nnot an instruction\n");
+    FILE *target = tmpfile();
+    assert(target);
+    assert(assemble(source, target, OUTPUT_FORMAT_HACK, true) != 0);
+    fclose(target);
+    fclose(source);
+    printf("\t✅ test_stream_errors passed!\n");
+}
+
+int main(void) {
+    test_stream_small();
+    test_stream_large();
+    test_stream_errors();
+    return 0;
+}
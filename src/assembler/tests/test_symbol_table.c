@@ -8,16 +8,19 @@
 
 void test_symbol_table(void);
 void test_load_symbol_table(void);
+void test_lookup_or_insert(void);
 
 int main(void) {
     test_symbol_table();
     test_load_symbol_table();
+    test_lookup_or_insert();
     return 0;
 }
 
 void test_symbol_table(void) {
     // Create a new symbol table
-    SymbolTable *table = symbol_table_create();
+    StringPool *pool = string_pool_create();
+    SymbolTable *table = symbol_table_create(pool);
     assert(table != NULL);
 
     // Add symbols
@@ -42,25 +45,33 @@ void test_symbol_table(void) {
     // Attempt to add a duplicate symbol (should fail)
     assert(!symbol_table_add(table, "START", 400));  // "START" already exists
 
-    // Fill up the rest of symbol table to max capacity
-    for (int i = 3; i < MAX_NUM_SYMBOLS; i++) {
-        char buffer[10];
+    // Grow well past the initial capacity (no fixed symbol ceiling)
+    for (int i = 3; i < 5000; i++) {
+        char buffer[16];
         snprintf(buffer, sizeof(buffer), "SYM_%d", i);
-        symbol_table_add(table, buffer, i * 10);
+        assert(symbol_table_add(table, buffer, i * 10));
     }
+    assert(symbol_table_count(table) == 5000);
 
-    // Adding one more should fail (table is full)
-    assert(!symbol_table_add(table, "EXTRA", 9999));
+    // Everything added before and after growth is still retrievable
+    assert(symbol_table_get_address(table, "START") == 100);
+    for (int i = 3; i < 5000; i++) {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "SYM_%d", i);
+        assert(symbol_table_get_address(table, buffer) == i * 10);
+    }
 
     // Cleanup
     symbol_table_free(table);
+    string_pool_free(pool);
 
     printf("\t✅ test_symbol_table passed!\n");
 }
 
 void test_load_symbol_table(void) {
     // Create a new symbol table
-    SymbolTable *table = symbol_table_create();
+    StringPool *pool = string_pool_create();
+    SymbolTable *table = symbol_table_create(pool);
     assert(table != NULL);
 
     // Load predefined symbols into the table
@@ -108,6 +119,62 @@ void test_load_symbol_table(void) {
 
     // Cleanup
     symbol_table_free(table);
+    string_pool_free(pool);
 
     printf("\t✅ test_load_symbol_table passed!\n");
 }
+
+void test_lookup_or_insert(void) {
+    StringPool *pool = string_pool_create();
+    SymbolTable *table = symbol_table_create(pool);
+    assert(table != NULL);
+    assert(load_predefined_symbols(table));
+
+    bool inserted = true;
+
+    // Existing symbols return their address and are not re-inserted
+    assert(symbol_table_lookup_or_insert(table, "SCREEN", 16, &inserted) == 16384);
+    assert(!inserted);
+
+    // New symbols receive the supplied address
+    assert(symbol_table_lookup_or_insert(table, "counter", 16, &inserted) == 16);
+    assert(inserted);
+    assert(symbol_table_lookup_or_insert(table, "counter", 17, &inserted) == 16);
+    assert(!inserted);
+    assert(symbol_table_get_address(table, "counter") == 16);
+
+    // 'inserted' is optional
+    assert(symbol_table_lookup_or_insert(table, "other", 17, NULL) == 17);
+
+    // Lookups by interned id agree with lookups by text
+    const StringId counter = string_pool_find(pool, "counter", 7);
+    assert(counter != STRING_ID_NONE);
+    assert(symbol_table_get_address_id(table, counter) == 16);
+    assert(symbol_table_lookup_or_insert_id(table, counter, 99, &inserted) == 16);
+    assert(!inserted);
+    const StringId fresh = string_pool_intern(pool, "fresh", 5);
+    assert(symbol_table_get_address_id(table, fresh) == -1);
+    assert(symbol_table_lookup_or_insert_id(table, fresh, 18, &inserted) == 18);
+    assert(inserted);
+
+    // Invalid arguments
+    assert(symbol_table_create(NULL) == NULL);
+    assert(symbol_table_lookup_or_insert_id(table, STRING_ID_NONE, 0, &inserted) == -1);
+    assert(symbol_table_lookup_or_insert(NULL, "x", 0, &inserted) == -1);
+    assert(symbol_table_lookup_or_insert(table, NULL, 0, &inserted) == -1);
+
+    // Truncating with the pool returns the table to its predefined state
+    const size_t predefined = symbol_table_count(table) - 3;
+    assert(symbol_table_truncate(table, counter));
+    string_pool_truncate(pool, counter);
+    assert(symbol_table_count(table) == predefined);
+    assert(symbol_table_get_address(table, "KBD") == 24576);
+    assert(symbol_table_get_address(table, "counter") == -1);
+    assert(symbol_table_lookup_or_insert(table, "counter", 20, &inserted) == 20);
+    assert(inserted);
+
+    symbol_table_free(table);
+    string_pool_free(pool);
+
+    printf("\t✅ test_lookup_or_insert passed!\n");
+}
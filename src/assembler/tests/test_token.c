@@ -4,6 +4,7 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <token.h>
 #include <stdio.h>
@@ -16,21 +17,26 @@ int main(void) {
 }
 
 void test_create_token(void) {
-    // Test SYMBOL token
-    Token *symbol_token = create_token(TOKEN_SYMBOL, "LOOP");
+    // Test SYMBOL token (carries an interned id)
+    StringPool *pool = string_pool_create();
+    const StringId loop = string_pool_intern(pool, "LOOP", 4);
+    Token *symbol_token = create_token(TOKEN_SYMBOL, loop);
     assert(symbol_token != NULL);
     assert(symbol_token->type == TOKEN_SYMBOL);
-    assert(symbol_token->value.symbol != NULL);
-    assert(strcmp(symbol_token->value.symbol, "LOOP") == 0);
+    assert(symbol_token->value.symbol == loop);
+    char *symbol_str = token_to_str(symbol_token, pool);
+    assert(strcmp(symbol_str, "TOKEN_SYMBOL LOOP") == 0);
+    free(symbol_str);
     free_token(symbol_token);
 
     // Edge case: Empty string for SYMBOL
-    Token *empty_symbol_token = create_token(TOKEN_SYMBOL, "");
+    const StringId empty = string_pool_intern(pool, "", 0);
+    Token *empty_symbol_token = create_token(TOKEN_SYMBOL, empty);
     assert(empty_symbol_token != NULL);
     assert(empty_symbol_token->type == TOKEN_SYMBOL);
-    assert(empty_symbol_token->value.symbol != NULL);
-    assert(strcmp(empty_symbol_token->value.symbol, "") == 0);
+    assert(strcmp(string_pool_get(pool, empty_symbol_token->value.symbol), "") == 0);
     free_token(empty_symbol_token);
+    string_pool_free(pool);
 
     // Test INTEGER_LITERAL token
     Token *int_token = create_token(TOKEN_INTEGER, 42);
@@ -60,14 +66,14 @@ void test_create_token(void) {
     Token *newline_token = create_token(NEWLINE);
     assert(newline_token != NULL);
     assert(newline_token->type == NEWLINE);
-    assert(newline_token->value.symbol == NULL);
+    assert(newline_token->value.symbol == STRING_ID_NONE);
     free_token(newline_token);
 
     // Edge case: NEWLINE with unexpected value (should still be NULL)
     Token *unexpected_newline = create_token(NEWLINE, "unexpected");
     assert(unexpected_newline != NULL);
     assert(unexpected_newline->type == NEWLINE);
-    assert(unexpected_newline->value.symbol == NULL);
+    assert(unexpected_newline->value.symbol == STRING_ID_NONE);
     free_token(unexpected_newline);
 
     printf("\t✅ test_create_token passed!\n");
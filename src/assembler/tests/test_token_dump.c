@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "token.h"
+#include "token_dump.h"
+
+static char *read_all(FILE *file, size_t *size) {
+    fflush(file);
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    rewind(file);
+    char *data = malloc(*size + 1);
+    assert(data);
+    assert(fread(data, 1, *size, file) == *size);
+    data[*size] = '\0';
+    return data;
+}
+
+static void add(TokenTable *table, const TokenType type, const int value) {
+    Token token = {.type = type};
+    if (type == TOKEN_SYMBOL) {
+        token.value.symbol = (StringId)value;
+    } else {
+        token.value.integer = value;
+    }
+    assert(token_table_add(table, &token));
+}
+
+void test_token_dump_round_trip(void) {
+    StringPool *pool = string_pool_create();
+    TokenTable *first = token_table_create(sizeof(Token), NULL, (TokenToStr)token_to_str);
+    TokenTable *second = token_table_create(sizeof(Token), NULL, (TokenToStr)token_to_str);
+    const StringId loop = string_pool_intern(pool, "LOOP", 4);
+    const StringId empty = string_pool_intern(pool, "", 0);
+    char long_name[300];
+    memset(long_name, 'x', sizeof(long_name));
+    const StringId wide = string_pool_intern(pool, long_name, sizeof(long_name));
+
+    // Every token type, symbols used more than once, and values needing several varint bytes
+    for (TokenType type = TOKEN_AT; type <= NEWLINE; type++) add(first, type, type == TOKEN_SYMBOL ? (int)loop : 7);
+    add(first, TOKEN_INTEGER, 32767);
+    add(first, TOKEN_INTEGER, INT_MAX);
+    add(first, TOKEN_INTEGER, -1);
+    add(first, TOKEN_SYMBOL, (int)empty);
+    add(second, TOKEN_SYMBOL, (int)loop);
+    add(second, TOKEN_SYMBOL, (int)wide);
+    add(second, NEWLINE, 0);
+
+    // The dump of two tables renders exactly as the text writer prints them one after the other
+    FILE *expected_file = tmpfile();
+    assert(expected_file);
+    token_table_write_to_file(expected_file, first, pool);
+    token_table_write_to_file(expected_file, second, pool);
+
+    FILE *dump_file = tmpfile();
+    assert(dump_file);
+    TokenDump *dump = token_dump_create(dump_file);
+    assert(dump);
+    assert(token_dump_write(dump, first, pool));
+    assert(token_dump_write(dump, second, pool));
+    assert(token_dump_close(dump));
+
+    size_t dump_size;
+    free(read_all(dump_file, &dump_size));
+    assert(dump_size < token_table_size(first) * 4 + sizeof(long_name));  // Names are written once
+
+    FILE *text_file = tmpfile();
+    assert(text_file);
+    rewind(dump_file);
+    assert(token_dump_render(dump_file, text_file));
+
+    size_t expected_size, text_size;
+    char *expected = read_all(expected_file, &expected_size);
+    char *text = read_all(text_file, &text_size);
+    assert(text_size == expected_size && memcmp(text, expected, text_size) == 0);
+
+    free(expected);
+    free(text);
+    fclose(expected_file);
+    fclose(dump_file);
+    fclose(text_file);
+    token_table_free(first);
+    token_table_free(second);
+    string_pool_free(pool);
+    printf("\t✅ test_token_dump_round_trip passed!\n");
+}
+
+void test_token_dump_malformed(void) {
+    const char *cases[] = {
+        "",                     // No header
+        "HTOX\x01",             // Wrong magic
+        "HTOK\x01\x01\x85",     // Symbol id cut short
+        "HTOK\x01\xff\x00\x05x", // Name cut short
+        "HTOK\x01\x7f",         // Unknown token type
+    };
+    const size_t sizes[] = {0, 5, 7, 9, 6};
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        FILE *in = tmpfile();
+        FILE *out = tmpfile();
+        assert(in && out);
+        fwrite(cases[i], 1, sizes[i], in);
+        rewind(in);
+        assert(!token_dump_render(in, out));
+        fclose(in);
+        fclose(out);
+    }
+    printf("\t✅ test_token_dump_malformed passed!\n");
+}
+
+int main(void) {
+    test_token_dump_round_trip();
+    test_token_dump_malformed();
+    return 0;
+}
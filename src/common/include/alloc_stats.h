@@ -0,0 +1,69 @@
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Allocation accounting per subsystem.
+ *
+ * Modules allocate through the TRACKED_* macros with the tag of the subsystem that owns the
+ * memory. With ALLOC_STATS_ENABLED (CMake option ENABLE_ALLOC_STATS) each call counts the
+ * allocation, its bytes and the live bytes per tag; otherwise the macros are the plain libc
+ * calls. Sizes are taken from the allocator (malloc_usable_size), so no header is added to
+ * blocks and memory from a tracked call may still be released with plain free() (its bytes
+ * then stay counted as live). Counters are atomic: any thread may allocate.
+ */
+typedef enum {
+    ALLOC_TAG_TOKENS,   // Token records and token tables
+    ALLOC_TAG_LEXER,    // First-pass working state (per-chunk tables and remaps)
+    ALLOC_TAG_SYMBOLS,  // Symbol table
+    ALLOC_TAG_STRINGS,  // Interned strings
+    ALLOC_TAG_ARENA,    // Arena chunks (malloc-backed ones; huge-page chunks are mapped directly)
+    ALLOC_TAG_COUNT
+} AllocTag;
+
+typedef struct {
+    uint64_t count;       // Allocations made (a realloc counts as one)
+    uint64_t bytes;       // Bytes allocated in total
+    uint64_t live_bytes;  // Bytes currently allocated
+    uint64_t peak_bytes;  // Highest live_bytes seen
+} AllocTagStats;
+
+/**
+ * @brief Returns the name of a tag ("tokens", "lexer", ...).
+ */
+const char *alloc_tag_name(AllocTag tag);
+
+/**
+ * @brief Reads the counters of a tag (zero if nothing was tracked).
+ */
+AllocTagStats alloc_stats_get(AllocTag tag);
+
+/**
+ * @brief Sets every counter back to zero.
+ */
+void alloc_stats_reset(void);
+
+// Tracked libc equivalents (use the macros below rather than calling these directly)
+void *alloc_tracked_malloc(AllocTag tag, size_t size);
+void *alloc_tracked_calloc(AllocTag tag, size_t count, size_t size);
+void *alloc_tracked_realloc(AllocTag tag, void *ptr, size_t size);
+char *alloc_tracked_strdup(AllocTag tag, const char *str);
+void alloc_tracked_free(AllocTag tag, void *ptr);
+
+#ifdef ALLOC_STATS_ENABLED
+#define TRACKED_MALLOC(tag, size) alloc_tracked_malloc(tag, size)
+#define TRACKED_CALLOC(tag, count, size) alloc_tracked_calloc(tag, count, size)
+#define TRACKED_REALLOC(tag, ptr, size) alloc_tracked_realloc(tag, ptr, size)
+#define TRACKED_STRDUP(tag, str) alloc_tracked_strdup(tag, str)
+#define TRACKED_FREE(tag, ptr) alloc_tracked_free(tag, ptr)
+#else
+#define TRACKED_MALLOC(tag, size) malloc(size)
+#define TRACKED_CALLOC(tag, count, size) calloc(count, size)
+#define TRACKED_REALLOC(tag, ptr, size) realloc(ptr, size)
+#define TRACKED_STRDUP(tag, str) strdup(str)
+#define TRACKED_FREE(tag, ptr) free(ptr)
+#endif
+
+#endif // ALLOC_STATS_H
@@ -0,0 +1,74 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Bump allocator for data that dies together.
+ *
+ * Allocations are carved out of large chunks and never freed one by one: arena_reset() rewinds
+ * to an earlier mark (keeping the chunks for reuse) and arena_free() releases every chunk, so
+ * teardown costs one call per chunk however many objects were allocated. Chunks double in size
+ * as the arena grows (up to ARENA_MAX_CHUNK), and memory never moves.
+ */
+typedef struct Arena Arena;
+
+// Position in an arena, taken with arena_mark() and restored with arena_reset()
+typedef struct {
+    size_t chunk;
+    size_t used;
+} ArenaMark;
+
+#define ARENA_MAX_CHUNK ((size_t)64 << 20)  // Largest chunk the arena grows to on its own
+#define ARENA_HUGE_PAGES 1u                 // Back chunks with transparent huge pages where available
+
+/**
+ * @brief Creates an empty arena (no chunk is allocated until the first allocation).
+ *
+ * @param chunk_size Size of the first chunk; later chunks double up to ARENA_MAX_CHUNK.
+ * @param flags      0 or ARENA_HUGE_PAGES, which maps chunks in 2 MiB multiples and asks the
+ *                   kernel to back them with huge pages (fewer TLB misses on large tables).
+ * @return Pointer to Arena (free with arena_free), or NULL on failure.
+ */
+Arena *arena_create(size_t chunk_size, unsigned flags);
+
+/**
+ * @brief Releases every chunk and the arena itself (may be NULL).
+ */
+void arena_free(Arena *arena);
+
+/**
+ * @brief Allocates 'size' bytes aligned for any type.
+ * @return Pointer valid until the arena is reset past it or freed, or NULL on failure.
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * @brief Allocates 'size' bytes with no alignment (packs strings and byte data tightly).
+ */
+void *arena_alloc_bytes(Arena *arena, size_t size);
+
+/**
+ * @brief Returns the current position; everything allocated after it is dropped by arena_reset().
+ */
+ArenaMark arena_mark(const Arena *arena);
+
+/**
+ * @brief Finds the mark just past 'end', the end of some memory allocated from the arena.
+ *
+ * @return true with *mark set, or false if 'end' does not point into the arena's live memory.
+ */
+bool arena_mark_at(const Arena *arena, const void *end, ArenaMark *mark);
+
+/**
+ * @brief Rewinds to 'mark'. Chunks stay allocated and are reused by later allocations.
+ */
+void arena_reset(Arena *arena, ArenaMark mark);
+
+/**
+ * @brief Returns the bytes in use up to the current position (unused chunk tails included).
+ */
+size_t arena_used(const Arena *arena);
+
+#endif // ARENA_H
@@ -7,6 +7,7 @@
 #include <stddef.h>
 
 // Supported file types (extensions)
+#define EXT_ASM  ".asm"
 #define EXT_VM   ".vm"
 #define EXT_JACK ".jack"
 
@@ -39,9 +40,11 @@ FileList *file_list_new(void);
  * If 'path' is a file, adds it if it matches the given extension.
  * If 'path' is a directory, scans and adds matching files.
  *
+ * Directories are scanned one level deep (no recursion); entries that are not regular files are skipped.
+ *
  * @param list Pointer to an existing FileList
  * @param path File or directory path
- * @param extension Extension to match (e.g., EXT_VM or EXT_JACK)
+ * @param extension Extension to match (e.g., EXT_ASM, EXT_VM or EXT_JACK)
  * @return true on success, false on error
  */
 bool file_list_add(FileList *list, const char *path, const char *extension);
@@ -51,6 +54,11 @@ bool file_list_add(FileList *list, const char *path, const char *extension);
  */
 void file_list_sort(FileList *list);
 
+/**
+ * Removes entries whose full_path repeats the previous entry's (call after file_list_sort).
+ */
+void file_list_remove_duplicates(FileList *list);
+
 /**
  * Opens the next file in the list for reading.
  * Returns NULL when all files have been processed.
@@ -2,8 +2,10 @@
 #define LOGGER_H
 
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Log levels
 typedef enum {
@@ -13,23 +15,56 @@ typedef enum {
     LOG_ERROR
 } LogLevel;
 
+#define LOGGER_RECORD_MAX 4096      // Longest record; longer messages are truncated
+#define LOGGER_RING_SIZE 65536      // Bytes buffered per thread by an asynchronous logger
+#define LOGGER_MEMORY_SIZE 65536    // Bytes kept by logger_create(NULL, ...)
+
+// Background writer of an asynchronous logger (see logger_create_async)
+typedef struct LoggerAsync LoggerAsync;
+
 typedef struct {
-    FILE *stream;         // File or memory stream
-    char *mem_buffer;     // Buffer if using memory stream
-    size_t mem_size;      // Size of the memory buffer
+    FILE *stream;         // Log file, or NULL when logging to memory
+    char *mem_buffer;     // Circular buffer holding the latest memory log output
+    size_t mem_size;      // Capacity of mem_buffer (fixed at creation)
+    uint64_t mem_written; // Bytes ever logged to memory; the buffer keeps the last mem_size of them
+    uint64_t mem_first;   // Where the oldest complete record starts (counted like mem_written)
+    bool mem_dropped;     // Older output was overwritten since creation or the last logger_clear
+    atomic_flag mem_lock; // Guards the memory log (records are short copies)
     LogLevel level;       // Current log level threshold
     bool use_colors;      // Enable ANSI colors for terminal
+    LoggerAsync *async;   // Per-thread rings and drainer thread, or NULL when writing directly
 } Logger;
 
-// Create a new logger
+// Create a new logger (NULL path = memory log of LOGGER_MEMORY_SIZE bytes)
 Logger *logger_create(const char *log_filepath, LogLevel level, bool use_colors);
 
+// Create a memory logger keeping the last 'capacity' bytes of output. Its buffer is allocated
+// here once; logging never allocates, and older records are overwritten when it is full.
+Logger *logger_create_memory(size_t capacity, LogLevel level, bool use_colors);
+
+// Create a logger whose records are formatted on the calling thread, queued in that thread's
+// lock-free ring buffer, and written to the file by a background thread, so logging threads
+// never contend on the stream. Records of one thread keep their order. NULL path = stderr.
+Logger *logger_create_async(const char *log_filepath, LogLevel level, bool use_colors);
+
+// Write out everything logged so far (waits for an asynchronous logger to drain)
+void logger_flush(Logger *logger);
+
 // Log a message (internal usage)
 void logger_log(Logger *logger, LogLevel level, const char *file, int line, const char *fmt, ...);
 
-// Dump memory log buffer to a target stream (if using memory logging)
+// Dump memory log buffer to a target stream (if using memory logging). If older output was
+// overwritten, a note says so and the dump starts at the first complete record.
 void logger_dump(Logger *logger, FILE *target);
 
+// Return the retained memory log as one contiguous run (rearranging the buffer in place), starting
+// at its first complete record. *dropped tells whether older output was overwritten (may be NULL).
+// Valid until the next log call. Returns NULL (and *size 0) for file loggers.
+const char *logger_contents(Logger *logger, size_t *size, bool *dropped);
+
+// Discard the contents of a memory logger so it can be reused (no effect on file loggers)
+void logger_clear(Logger *logger);
+
 // Free logger resources
 void logger_free(Logger *logger);
 
@@ -37,18 +72,25 @@ void logger_free(Logger *logger);
 void logger_set_global(Logger *logger);
 Logger *logger_get_global(void);
 
-// General user log - no source file or line shown
-#define GLOG(level, ...) \
+// Override the global logger for the calling thread only (NULL restores the global one).
+// logger_get_global() returns the override while it is set.
+void logger_set_thread(Logger *logger);
+
+// General user log - no source file or line shown.
+// A filtered-out level costs one logger lookup and a compare; the arguments are not evaluated.
+#define GLOG(log_level, ...) \
     do { \
-        if (logger_get_global()) \
-            logger_log(logger_get_global(), level, NULL, 0, __VA_ARGS__); \
+        Logger *glog_logger_ = logger_get_global(); \
+        if (glog_logger_ && (log_level) >= glog_logger_->level) \
+            logger_log(glog_logger_, log_level, NULL, 0, __VA_ARGS__); \
     } while (0)
 
 // User error log pointing to their source file and line number
-#define GUSERLOG(level, user_file, user_line, ...) \
+#define GUSERLOG(log_level, user_file, user_line, ...) \
     do { \
-        if (logger_get_global()) \
-            logger_log(logger_get_global(), level, user_file, user_line, __VA_ARGS__); \
+        Logger *glog_logger_ = logger_get_global(); \
+        if (glog_logger_ && (log_level) >= glog_logger_->level) \
+            logger_log(glog_logger_, log_level, user_file, user_line, __VA_ARGS__); \
     } while (0)
 
 #endif // LOGGER_H
@@ -0,0 +1,65 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Growable contiguous output buffer.
+ *
+ * Producers append (or claim space and fill it in place) and the whole buffer is
+ * handed to the kernel with a single write() when flushed, instead of one stdio
+ * call per line.
+ */
+typedef struct {
+    char *data;          // Buffered bytes
+    size_t size;         // Bytes currently buffered
+    size_t capacity;     // Allocated size of 'data'
+} OutputBuffer;
+
+/**
+ * @brief Creates an empty OutputBuffer.
+ *
+ * @param initial_capacity Bytes to preallocate (may be 0).
+ * @return Pointer to OutputBuffer (free with output_buffer_free), or NULL on failure.
+ */
+OutputBuffer *output_buffer_create(size_t initial_capacity);
+
+/**
+ * @brief Ensures at least 'additional' more bytes can be appended without reallocating.
+ *
+ * @return true on success, false on allocation failure.
+ */
+bool output_buffer_reserve(OutputBuffer *buffer, size_t additional);
+
+/**
+ * @brief Claims 'length' bytes at the end of the buffer for the caller to fill in.
+ *
+ * @return Pointer to the claimed bytes (valid until the next append/claim), or NULL on failure.
+ */
+char *output_buffer_claim(OutputBuffer *buffer, size_t length);
+
+/**
+ * @brief Appends 'length' bytes from 'data'.
+ *
+ * @return true on success, false on allocation failure.
+ */
+bool output_buffer_append(OutputBuffer *buffer, const void *data, size_t length);
+
+/**
+ * @brief Writes all buffered bytes to 'target' and empties the buffer.
+ *
+ * Streams backed by a file descriptor receive the data through write() directly
+ * (after flushing any stdio-buffered bytes); other streams fall back to fwrite().
+ *
+ * @return true if every byte was written, false on I/O error.
+ */
+bool output_buffer_flush(OutputBuffer *buffer, FILE *target);
+
+/**
+ * @brief Frees the buffer and its contents.
+ */
+void output_buffer_free(OutputBuffer *buffer);
+
+#endif // OUTPUT_BUFFER_H
@@ -0,0 +1,39 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Read-only view of an entire source file.
+ *
+ * Regular files are memory-mapped so front ends can lex directly out of the page
+ * cache without copying; other streams (pipes, memory streams) are read into a
+ * single heap buffer. Either way the contents are contiguous and immutable.
+ */
+typedef struct {
+    const char *data;     // File contents (not null-terminated)
+    size_t size;          // Number of bytes in 'data'
+    bool mapped;          // true if 'data' is an mmap of the file
+} SourceBuffer;
+
+/**
+ * @brief Loads the full contents of an open file.
+ *
+ * Regular files are mapped from offset 0; any other stream is read from its
+ * current position until EOF.
+ *
+ * @param file Open file to load (remains owned by the caller).
+ * @return Pointer to SourceBuffer (free with source_buffer_free), or NULL on failure.
+ */
+SourceBuffer *source_buffer_create(FILE *file);
+
+/**
+ * @brief Unmaps or frees the buffer contents and the SourceBuffer itself.
+ *
+ * @param buffer SourceBuffer to free (may be NULL).
+ */
+void source_buffer_free(SourceBuffer *buffer);
+
+#endif // SOURCE_BUFFER_H
@@ -0,0 +1,106 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define STATS_MAX_PHASES 16
+#define STATS_MAX_COUNTERS 16
+
+/**
+ * Run statistics: time spent per named phase and named counters.
+ *
+ * Phases are measured with the monotonic clock (wall time) and the process CPU clock (CPU
+ * time of every thread, so parallel phases can show more CPU than wall time). A phase that
+ * runs several times accumulates. Names must be string literals (or otherwise outlive the
+ * Stats); phases and counters are reported in the order they were first recorded.
+ *
+ * Stages record through the STATS_* macros against the global instance, which costs nothing
+ * when no instance is installed. Building without STATS_ENABLED (CMake option ENABLE_STATS)
+ * removes the macros' code entirely.
+ */
+typedef struct {
+    const char *name;
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+} StatsPhase;
+
+typedef struct {
+    const char *name;
+    uint64_t value;
+} StatsCounter;
+
+typedef struct {
+    uint64_t start_wall_ns;   // When the Stats was created
+    uint64_t start_cpu_ns;
+    StatsPhase phases[STATS_MAX_PHASES];
+    size_t phase_count;
+    StatsCounter counters[STATS_MAX_COUNTERS];
+    size_t counter_count;
+} Stats;
+
+// Start of a timed section (see stats_begin)
+typedef struct {
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    bool active;              // False when there was no Stats to record into
+} StatsMark;
+
+/**
+ * @brief Creates an empty Stats; the total wall and CPU time is measured from here.
+ * @return Pointer to Stats (free with stats_free), or NULL on failure.
+ */
+Stats *stats_create(void);
+
+/**
+ * @brief Frees a Stats (may be NULL).
+ */
+void stats_free(Stats *stats);
+
+/**
+ * @brief Reads the clocks at the start of a phase if a global Stats is installed.
+ */
+void stats_begin(StatsMark *mark);
+
+/**
+ * @brief Adds the time since 'mark' to a phase of the global Stats.
+ */
+void stats_end(const char *phase, const StatsMark *mark);
+
+/**
+ * @brief Adds 'value' to a counter of the global Stats (no effect without one).
+ */
+void stats_count(const char *counter, uint64_t value);
+
+/**
+ * @brief Writes a report: every phase, the total, each counter with its rate per second of
+ * total wall time, the allocations per tag when built with ALLOC_STATS_ENABLED (see
+ * alloc_stats.h), and the peak resident set size.
+ *
+ * @param stats Stats to report.
+ * @param file Output stream.
+ * @param json Write one JSON object instead of a text table.
+ */
+void stats_report(const Stats *stats, FILE *file, bool json);
+
+/**
+ * @brief Installs (or with NULL removes) the Stats the STATS_* macros record into.
+ *
+ * Recording is meant for one thread at a time (the thread driving the stages).
+ */
+void stats_set_global(Stats *stats);
+Stats *stats_get_global(void);
+
+#ifdef STATS_ENABLED
+#define STATS_BEGIN(mark) StatsMark mark; stats_begin(&mark)
+#define STATS_END(phase, mark) stats_end(phase, &mark)
+#define STATS_COUNT(counter, value) stats_count(counter, value)
+#else
+#define STATS_BEGIN(mark) do { } while (0)
+#define STATS_END(phase, mark) do { } while (0)
+#define STATS_COUNT(counter, value) do { } while (0)
+#endif
+
+#endif // STATS_H
@@ -0,0 +1,111 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Opaque StringPool type
+typedef struct StringPool StringPool;
+
+// Stable integer handle for an interned string (ids are dense, starting at 0)
+typedef uint32_t StringId;
+
+// Returned when a string is not present or could not be interned
+#define STRING_ID_NONE UINT32_MAX
+
+/**
+ * Creates a new, empty StringPool.
+ *
+ * Each distinct string is stored once and identified by a StringId; interning the
+ * same text again returns the same id. Stored strings never move, so pointers
+ * returned by string_pool_get() stay valid until the pool is freed.
+ *
+ * @return Pointer to the new StringPool, or NULL on failure. Free with string_pool_free().
+ */
+StringPool *string_pool_create(void);
+
+/**
+ * Frees the StringPool and every string it holds.
+ *
+ * @param pool Pointer to the StringPool (may be NULL).
+ */
+void string_pool_free(StringPool *pool);
+
+/**
+ * Interns a string given as a pointer and length (need not be null-terminated).
+ *
+ * @param pool Pointer to the StringPool.
+ * @param str Start of the string.
+ * @param length Length of the string in bytes.
+ * @return The id of the (existing or new) string, or STRING_ID_NONE on failure.
+ */
+StringId string_pool_intern(StringPool *pool, const char *str, size_t length);
+
+/**
+ * Looks up a string without interning it.
+ *
+ * @param pool Pointer to the StringPool.
+ * @param str Start of the string.
+ * @param length Length of the string in bytes.
+ * @return The id of the string, or STRING_ID_NONE if it has not been interned.
+ */
+StringId string_pool_find(const StringPool *pool, const char *str, size_t length);
+
+/**
+ * Returns the null-terminated text of an interned string.
+ *
+ * @param pool Pointer to the StringPool.
+ * @param id Id returned by string_pool_intern().
+ * @return Pointer to the string, or NULL if id is invalid.
+ */
+const char *string_pool_get(const StringPool *pool, StringId id);
+
+/**
+ * Returns the length in bytes of an interned string.
+ *
+ * @param pool Pointer to the StringPool.
+ * @param id Id returned by string_pool_intern().
+ * @return Length of the string, or 0 if id is invalid.
+ */
+size_t string_pool_length(const StringPool *pool, StringId id);
+
+/**
+ * Returns the hash computed when the string was interned (see string_pool_hash_bytes()).
+ *
+ * @param pool Pointer to the StringPool.
+ * @param id Id returned by string_pool_intern().
+ * @return The stored hash, or 0 if id is invalid.
+ */
+uint32_t string_pool_hash(const StringPool *pool, StringId id);
+
+/**
+ * Returns the number of distinct strings in the pool.
+ *
+ * @param pool Pointer to the StringPool.
+ * @return Number of interned strings, or 0 if pool is NULL.
+ */
+size_t string_pool_count(const StringPool *pool);
+
+/**
+ * Forgets every string with an id >= 'count', keeping the first 'count' strings.
+ *
+ * Storage used by the dropped strings is reclaimed, so a pool can be reset to a
+ * prefilled state (e.g. after interning a fixed set of keywords) and reused.
+ * Ids and pointers of the dropped strings become invalid.
+ *
+ * @param pool Pointer to the StringPool.
+ * @param count Number of strings to keep (no effect if >= string_pool_count()).
+ */
+void string_pool_truncate(StringPool *pool, size_t count);
+
+/**
+ * Hash function used by the pool (32-bit FNV-1a, never 0).
+ *
+ * @param str Start of the bytes to hash.
+ * @param length Number of bytes.
+ * @return Non-zero 32-bit hash.
+ */
+uint32_t string_pool_hash_bytes(const char *str, size_t length);
+
+#endif // STRING_POOL_H
@@ -0,0 +1,87 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Work-stealing thread pool shared by the toolchain stages.
+ *
+ * Every worker owns a deque of tasks. A worker pushes and pops tasks at the bottom of its
+ * own deque (newest first, which keeps nested work cache-warm) and, when that runs dry,
+ * steals the oldest task from the top of another worker's deque. Tasks submitted from
+ * outside the pool are spread over the workers' deques round-robin. Deques are small
+ * mutex-protected ring buffers; tasks are stored by value, so submitting never allocates
+ * once a deque has grown to its working size.
+ *
+ * Tasks are tracked in TaskGroups. Waiting on a group runs queued tasks on the waiting
+ * thread until the group is done, so tasks may themselves create groups and wait on them
+ * without deadlocking or tying up a worker.
+ */
+typedef struct ThreadPool ThreadPool;
+typedef struct TaskGroup TaskGroup;
+
+typedef void (*TaskFunc)(void *arg);
+
+/**
+ * @brief Creates a pool and starts its workers.
+ *
+ * @param workers Number of worker threads (0 = one per online CPU).
+ * @param pin_workers If true, worker i is pinned to CPU i (modulo the CPU count); failures are ignored.
+ * @return Pointer to ThreadPool (free with thread_pool_free), or NULL on failure.
+ */
+ThreadPool *thread_pool_create(unsigned workers, bool pin_workers);
+
+/**
+ * @brief Returns the number of worker threads in the pool.
+ */
+unsigned thread_pool_size(const ThreadPool *pool);
+
+/**
+ * @brief Stops the workers and frees the pool.
+ *
+ * Tasks still queued are run before the workers exit. No group may be submitting to the pool.
+ *
+ * @param pool Pool to free (may be NULL).
+ */
+void thread_pool_free(ThreadPool *pool);
+
+/**
+ * @brief Creates an empty task group on a pool.
+ *
+ * @param pool Pool that runs the group's tasks.
+ * @return Pointer to TaskGroup, or NULL on failure.
+ */
+TaskGroup *task_group_create(ThreadPool *pool);
+
+/**
+ * @brief Queues func(arg) as part of a group.
+ *
+ * @param group Task group.
+ * @param func Task function.
+ * @param arg Argument passed to 'func' (caller-owned, must stay valid until the group is waited on).
+ * @return true if queued; false on allocation failure (the task was not queued and may be run inline).
+ */
+bool task_group_submit(TaskGroup *group, TaskFunc func, void *arg);
+
+/**
+ * @brief Blocks until every task of the group has finished, running queued tasks meanwhile.
+ *
+ * The group can be reused afterwards.
+ *
+ * @param group Task group.
+ */
+void task_group_wait(TaskGroup *group);
+
+/**
+ * @brief Waits for the group (as task_group_wait) and frees it.
+ *
+ * @param group Task group (may be NULL).
+ */
+void task_group_join(TaskGroup *group);
+
+// Set or get the process-wide pool used by the toolchain stages (NULL: run work on the calling thread)
+void thread_pool_set_global(ThreadPool *pool);
+ThreadPool *thread_pool_get_global(void);
+
+#endif // THREAD_POOL_H
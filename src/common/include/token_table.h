@@ -2,32 +2,97 @@
 #define TOKEN_TABLE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
+#include "arena.h"
 
 // Opaque TokenTable type
 typedef struct TokenTable TokenTable;
 
 // Function pointer types for handling generic tokens
 typedef void (*TokenFreeFunc)(void *token);
-typedef char* (*TokenToStr)(void *token);
+typedef char* (*TokenToStr)(void *token, const void *context);
 
 /**
  * Creates a new, empty TokenTable instance.
  *
- * @param free_func Function pointer for freeing tokens (user must provide).
+ * Tokens are fixed-size records of 'token_size' bytes stored inline in large
+ * contiguous chunks, so adding a token never allocates per token and the whole
+ * table is released in one pass over its chunks.
+ *
+ * @param token_size Size in bytes of one token record (e.g. sizeof(Token)).
+ * @param free_func Function releasing resources owned by a record (optional, can be NULL).
+ *                  It must not free the record itself, which is owned by the table.
  * @param token_to_str Function pointer for converting token to string (optional, can be NULL).
  * @return Pointer to the new TokenTable. Caller must free it with token_table_free().
  */
-TokenTable *token_table_create(TokenFreeFunc free_func, TokenToStr token_to_str);
+TokenTable *token_table_create(size_t token_size, TokenFreeFunc free_func, TokenToStr token_to_str);
+
+/**
+ * Creates a TokenTable whose chunks are allocated from 'arena' instead of the heap.
+ *
+ * The table never frees its chunks; they go with the arena (arena_free() or a reset past
+ * them, after which the table must not be used). token_table_free() then only releases the
+ * table's bookkeeping.
+ *
+ * @param arena Arena providing chunk storage; must outlive the table.
+ * @return Pointer to the new TokenTable, or NULL on failure.
+ */
+TokenTable *token_table_create_arena(Arena *arena, size_t token_size, TokenFreeFunc free_func,
+                                     TokenToStr token_to_str);
 
 /**
- * Adds a token to the TokenTable (ownership is transferred).
+ * Copies a token record into the TokenTable.
+ * Ownership of any resources referenced by the record is transferred to the table.
  *
  * @param table Pointer to the TokenTable.
- * @param token Pointer to the token data to add.
+ * @param token Pointer to the token record to copy ('token_size' bytes).
  * @return true if successful, false otherwise.
  */
-bool token_table_add(TokenTable *table, void *token);
+bool token_table_add(TokenTable *table, const void *token);
+
+/**
+ * Moves every record of 'src' to the end of 'dst', preserving order.
+ * Records are copied in chunk-sized runs; ownership of their resources moves with them,
+ * and 'src' is left empty (its free function is not called for the moved records).
+ * Both tables must have the same record size.
+ *
+ * @param dst Table receiving the records.
+ * @param src Table whose records are moved.
+ * @return true if successful, false on size mismatch or allocation failure (both tables are then unchanged).
+ */
+bool token_table_splice(TokenTable *dst, TokenTable *src);
+
+/**
+ * Returns the number of tokens stored in the TokenTable.
+ *
+ * @param table Pointer to the TokenTable.
+ * @return Number of tokens, or 0 if table is NULL.
+ */
+size_t token_table_size(const TokenTable *table);
+
+/**
+ * Retrieves the token at a given index.
+ * The returned pointer remains valid until the table is freed.
+ *
+ * @param table Pointer to the TokenTable.
+ * @param index Zero-based token index.
+ * @return Pointer to the token, or NULL if index is out of range.
+ */
+void *token_table_get(const TokenTable *table, size_t index);
+
+/**
+ * Retrieves the run of records stored contiguously from a given index (up to the end of its chunk).
+ *
+ * Walking a table span by span visits every record with plain pointer increments:
+ * for (i = 0; (p = token_table_span(t, i, &n)); i += n) { ... p[0 .. n-1] ... }
+ *
+ * @param table Pointer to the TokenTable.
+ * @param index Zero-based index of the first record.
+ * @param count Output: number of contiguous records starting at 'index' (at least 1).
+ * @return Pointer to the record at 'index', or NULL if index is out of range.
+ */
+void *token_table_span(const TokenTable *table, size_t index, size_t *count);
 
 /**
  * Retrieves the next token and advances the iterator.
@@ -45,6 +110,24 @@ void *token_table_next(TokenTable *table);
  */
 void *token_table_peek(TokenTable *table);
 
+/**
+ * Peeks 'offset' tokens ahead of the iterator without advancing it.
+ * An offset of 0 is equivalent to token_table_peek().
+ *
+ * @param table Pointer to the TokenTable.
+ * @param offset Number of tokens to look ahead.
+ * @return Pointer to the token, or NULL if past the end.
+ */
+void *token_table_peek_ahead(TokenTable *table, size_t offset);
+
+/**
+ * Advances the iterator by 'count' tokens (clamped to the end of the table).
+ *
+ * @param table Pointer to the TokenTable.
+ * @param count Number of tokens to skip.
+ */
+void token_table_skip(TokenTable *table, size_t count);
+
 /**
  * Resets the internal iterator.
  *
@@ -52,6 +135,14 @@ void *token_table_peek(TokenTable *table);
  */
 void token_table_reset(TokenTable *table);
 
+/**
+ * Removes every token (calling the free function on each) and resets the iterator.
+ * Allocated chunks are kept, so refilling the table up to its previous size does not allocate.
+ *
+ * @param table Pointer to the TokenTable.
+ */
+void token_table_clear(TokenTable *table);
+
 /**
  * Frees the TokenTable and all contained tokens using the user-provided free function.
  *
@@ -64,7 +155,9 @@ void token_table_free(TokenTable *table);
  *
  * @param file Output stream.
  * @param table TokenTable to print.
+ * @param context Passed through to the token_to_str function (e.g. the source buffer
+ *                that token spans refer to); may be NULL.
  */
-void token_table_write_to_file(FILE *file, TokenTable *table);
+void token_table_write_to_file(FILE *file, TokenTable *table, const void *context);
 
 #endif //TOKEN_TABLE_H
@@ -0,0 +1,82 @@
+#include "alloc_stats.h"
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const TAG_NAMES[ALLOC_TAG_COUNT] = {"tokens", "lexer", "symbols", "strings", "arena"};
+
+static _Atomic uint64_t counts[ALLOC_TAG_COUNT];
+static _Atomic uint64_t totals[ALLOC_TAG_COUNT];
+static _Atomic uint64_t lives[ALLOC_TAG_COUNT];
+static _Atomic uint64_t peaks[ALLOC_TAG_COUNT];
+
+static void record_alloc(const AllocTag tag, void *ptr, const size_t previous) {
+    const uint64_t size = malloc_usable_size(ptr);
+    atomic_fetch_add_explicit(&counts[tag], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&totals[tag], size, memory_order_relaxed);
+    // Unsigned wrap-around handles a shrinking realloc
+    const uint64_t live = atomic_fetch_add_explicit(&lives[tag], size - previous, memory_order_relaxed) +
+                          (size - previous);
+
+    // A "negative" live count (untracked memory freed through a tracked call) is not a peak
+    uint64_t peak = atomic_load_explicit(&peaks[tag], memory_order_relaxed);
+    while (live > peak && live < UINT64_MAX / 2 &&
+           !atomic_compare_exchange_weak_explicit(&peaks[tag], &peak, live, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+const char *alloc_tag_name(const AllocTag tag) {
+    return (unsigned)tag < ALLOC_TAG_COUNT ? TAG_NAMES[tag] : "unknown";
+}
+
+AllocTagStats alloc_stats_get(const AllocTag tag) {
+    AllocTagStats stats = {0};
+    if ((unsigned)tag >= ALLOC_TAG_COUNT) return stats;
+    stats.count = atomic_load(&counts[tag]);
+    stats.bytes = atomic_load(&totals[tag]);
+    stats.live_bytes = atomic_load(&lives[tag]);
+    stats.peak_bytes = atomic_load(&peaks[tag]);
+    return stats;
+}
+
+void alloc_stats_reset(void) {
+    for (size_t i = 0; i < ALLOC_TAG_COUNT; i++) {
+        atomic_store(&counts[i], 0);
+        atomic_store(&totals[i], 0);
+        atomic_store(&lives[i], 0);
+        atomic_store(&peaks[i], 0);
+    }
+}
+
+void *alloc_tracked_malloc(const AllocTag tag, const size_t size) {
+    void *ptr = malloc(size);
+    if (ptr) record_alloc(tag, ptr, 0);
+    return ptr;
+}
+
+void *alloc_tracked_calloc(const AllocTag tag, const size_t count, const size_t size) {
+    void *ptr = calloc(count, size);
+    if (ptr) record_alloc(tag, ptr, 0);
+    return ptr;
+}
+
+void *alloc_tracked_realloc(const AllocTag tag, void *ptr, const size_t size) {
+    const size_t previous = ptr ? malloc_usable_size(ptr) : 0;
+    void *grown = realloc(ptr, size);
+    if (grown) record_alloc(tag, grown, previous);
+    return grown;
+}
+
+char *alloc_tracked_strdup(const AllocTag tag, const char *str) {
+    char *copy = strdup(str);
+    if (copy) record_alloc(tag, copy, 0);
+    return copy;
+}
+
+void alloc_tracked_free(const AllocTag tag, void *ptr) {
+    if (!ptr) return;
+    atomic_fetch_sub_explicit(&lives[tag], malloc_usable_size(ptr), memory_order_relaxed);
+    free(ptr);
+}
@@ -0,0 +1,142 @@
+#include "arena.h"
+#include "alloc_stats.h"
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+#define INITIAL_CHUNK_SLOTS 8
+
+typedef struct {
+    char *data;
+    size_t size;
+} Chunk;
+
+// Internal struct definition (hidden from user)
+struct Arena {
+    Chunk *chunks;        // Every chunk in allocation order; those after 'current' are free for reuse
+    size_t chunk_count;
+    size_t chunk_slots;   // Capacity of the chunks array
+    size_t current;       // Chunk being bumped (chunk_count when there is none yet)
+    size_t used;          // Bytes used in the current chunk
+    size_t next_size;     // Size of the next chunk to allocate
+    unsigned flags;
+};
+
+Arena *arena_create(const size_t chunk_size, const unsigned flags) {
+    Arena *arena = calloc(1, sizeof(Arena));
+    if (!arena) return NULL;
+    arena->next_size = chunk_size ? chunk_size : 4096;
+    arena->flags = flags;
+    return arena;
+}
+
+static void release_chunk(const Arena *arena, const Chunk *chunk) {
+    if (arena->flags & ARENA_HUGE_PAGES) {
+        munmap(chunk->data, chunk->size);
+    } else {
+        TRACKED_FREE(ALLOC_TAG_ARENA, chunk->data);
+    }
+}
+
+void arena_free(Arena *arena) {
+    if (!arena) return;
+    for (size_t i = 0; i < arena->chunk_count; i++) release_chunk(arena, &arena->chunks[i]);
+    free(arena->chunks);
+    free(arena);
+}
+
+// Allocates a chunk of at least 'min_size' bytes and inserts it right after the current one
+static bool add_chunk(Arena *arena, const size_t min_size) {
+    if (arena->chunk_count == arena->chunk_slots) {
+        const size_t slots = arena->chunk_slots ? arena->chunk_slots * 2 : INITIAL_CHUNK_SLOTS;
+        Chunk *chunks = realloc(arena->chunks, slots * sizeof(Chunk));
+        if (!chunks) return false;
+        arena->chunks = chunks;
+        arena->chunk_slots = slots;
+    }
+
+    Chunk chunk = {NULL, min_size > arena->next_size ? min_size : arena->next_size};
+    if (arena->flags & ARENA_HUGE_PAGES) {
+        chunk.size = (chunk.size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        chunk.data = mmap(NULL, chunk.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk.data == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+        madvise(chunk.data, chunk.size, MADV_HUGEPAGE);  // Only a hint; ordinary pages still work
+#endif
+    } else {
+        chunk.data = TRACKED_MALLOC(ALLOC_TAG_ARENA, chunk.size);
+        if (!chunk.data) return false;
+    }
+    if (arena->next_size < ARENA_MAX_CHUNK) arena->next_size *= 2;
+
+    // The new chunk becomes the next one to bump; later (free) chunks move up one place
+    const size_t position = arena->current < arena->chunk_count ? arena->current + 1 : arena->chunk_count;
+    for (size_t i = arena->chunk_count; i > position; i--) arena->chunks[i] = arena->chunks[i - 1];
+    arena->chunks[position] = chunk;
+    arena->chunk_count++;
+    return true;
+}
+
+static void *bump(Arena *arena, const size_t size, const size_t align) {
+    if (!arena) return NULL;
+    if (arena->current < arena->chunk_count) {
+        const Chunk *chunk = &arena->chunks[arena->current];
+        const size_t start = (arena->used + align - 1) & ~(align - 1);
+        if (start <= chunk->size && chunk->size - start >= size) {
+            arena->used = start + size;
+            return chunk->data + start;
+        }
+    }
+
+    // Move on to the next free chunk if it is large enough, else insert a new one
+    const size_t next = arena->current < arena->chunk_count ? arena->current + 1 : 0;
+    if (next >= arena->chunk_count || arena->chunks[next].size < size) {
+        if (size > SIZE_MAX / 2 || !add_chunk(arena, size)) return NULL;
+    }
+    arena->current = next;
+    arena->used = size;
+    return arena->chunks[next].data;  // Chunk starts are aligned by malloc/mmap
+}
+
+void *arena_alloc(Arena *arena, const size_t size) {
+    return bump(arena, size, alignof(max_align_t));
+}
+
+void *arena_alloc_bytes(Arena *arena, const size_t size) {
+    return bump(arena, size, 1);
+}
+
+ArenaMark arena_mark(const Arena *arena) {
+    if (!arena || arena->current >= arena->chunk_count) return (ArenaMark){0, 0};
+    return (ArenaMark){arena->current, arena->used};
+}
+
+bool arena_mark_at(const Arena *arena, const void *end, ArenaMark *mark) {
+    if (!arena || !end || !mark || arena->current >= arena->chunk_count) return false;
+    const char *position = end;
+    for (size_t i = 0; i <= arena->current; i++) {
+        const Chunk *chunk = &arena->chunks[i];
+        const size_t limit = i == arena->current ? arena->used : chunk->size;
+        if (position > chunk->data && position <= chunk->data + limit) {
+            *mark = (ArenaMark){i, (size_t)(position - chunk->data)};
+            return true;
+        }
+    }
+    return false;
+}
+
+void arena_reset(Arena *arena, const ArenaMark mark) {
+    if (!arena || arena->chunk_count == 0) return;
+    if (mark.chunk > arena->current || (mark.chunk == arena->current && mark.used > arena->used)) return;
+    arena->current = mark.chunk;
+    arena->used = mark.used;
+}
+
+size_t arena_used(const Arena *arena) {
+    if (!arena || arena->current >= arena->chunk_count) return 0;
+    size_t used = arena->used;
+    for (size_t i = 0; i < arena->current; i++) used += arena->chunks[i].size;
+    return used;
+}
@@ -0,0 +1,136 @@
+#include "file_list.h"
+#include "file_utils.h"
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+
+FileList *file_list_new(void) {
+    return calloc(1, sizeof(FileList));
+}
+
+// The files array starts at 8 entries and doubles, so it is full exactly when count is 8, 16, 32, ...
+static bool reserve_entry(FileList *list) {
+    const size_t count = list->count;
+    if (count != 0 && (count < 8 || (count & (count - 1)) != 0)) return true;  // Room left
+
+    FileEntry *files = realloc(list->files, (count ? count * 2 : 8) * sizeof(FileEntry));
+    if (!files) return false;
+    list->files = files;
+    return true;
+}
+
+static bool add_entry(FileList *list, const char *path) {
+    if (!reserve_entry(list)) return false;
+
+    // Split "dir/Name.ext" into source "dir/" and base name "Name"
+    const char *slash = strrchr(path, '/');
+    const char *name = slash ? slash + 1 : path;
+    const char *dot = strrchr(name, '.');
+    const size_t name_length = (dot && dot != name) ? (size_t)(dot - name) : strlen(name);
+
+    FileEntry entry = {
+        .full_path = strdup(path),
+        .base_name = strndup(name, name_length),
+        .source = slash ? strndup(path, (size_t)(name - path)) : strdup("./"),
+    };
+    if (!entry.full_path || !entry.base_name || !entry.source) {
+        free(entry.full_path);
+        free(entry.base_name);
+        free(entry.source);
+        return false;
+    }
+    list->files[list->count++] = entry;
+    return true;
+}
+
+bool file_list_add(FileList *list, const char *path, const char *extension) {
+    if (!list || !path || !extension) return false;
+
+    struct stat info;
+    if (stat(path, &info) != 0) return false;
+
+    if (!S_ISDIR(info.st_mode)) {
+        return has_extension(path, extension) ? add_entry(list, path) : true;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+
+    const size_t path_length = strlen(path);
+    const bool has_slash = path_length > 0 && path[path_length - 1] == '/';
+    bool ok = true;
+    const struct dirent *entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (!has_extension(entry->d_name, extension)) continue;
+
+        char full_path[MAX_PATH_LEN];
+        const int length = snprintf(full_path, sizeof(full_path), "%s%s%s", path, has_slash ? "" : "/",
+                                    entry->d_name);
+        if (length < 0 || (size_t)length >= sizeof(full_path)) {
+            ok = false;
+            break;
+        }
+        if (stat(full_path, &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        ok = add_entry(list, full_path);
+    }
+    closedir(dir);
+    return ok;
+}
+
+static int compare_entries(const void *a, const void *b) {
+    return strcmp(((const FileEntry *)a)->full_path, ((const FileEntry *)b)->full_path);
+}
+
+void file_list_sort(FileList *list) {
+    if (!list || list->count < 2) return;
+    qsort(list->files, list->count, sizeof(FileEntry), compare_entries);
+}
+
+void file_list_remove_duplicates(FileList *list) {
+    if (!list || list->count < 2) return;
+    size_t kept = 1;
+    for (size_t i = 1; i < list->count; i++) {
+        if (strcmp(list->files[i].full_path, list->files[kept - 1].full_path) == 0) {
+            free(list->files[i].full_path);
+            free(list->files[i].base_name);
+            free(list->files[i].source);
+        } else {
+            list->files[kept++] = list->files[i];
+        }
+    }
+    list->count = kept;
+}
+
+FILE *file_list_open_next(FileList *list) {
+    if (!list) return NULL;
+    while (list->index < list->count) {
+        FILE *file = fopen(list->files[list->index++].full_path, "r");
+        if (file) return file;
+    }
+    return NULL;
+}
+
+const char *file_list_current_basename(FileList *list) {
+    if (!list || list->index == 0 || list->index > list->count) return NULL;
+    return list->files[list->index - 1].base_name;
+}
+
+const char *file_list_current_source(FileList *list) {
+    if (!list || list->index == 0 || list->index > list->count) return NULL;
+    return list->files[list->index - 1].source;
+}
+
+void file_list_reset(FileList *list) {
+    if (list) list->index = 0;
+}
+
+void file_list_free(FileList *list) {
+    if (!list) return;
+    for (size_t i = 0; i < list->count; i++) {
+        free(list->files[i].full_path);
+        free(list->files[i].base_name);
+        free(list->files[i].source);
+    }
+    free(list->files);
+    free(list);
+}
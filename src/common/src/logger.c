@@ -2,11 +2,18 @@
 // Created by alexanderfisher on 23/03/25.
 //
 #include "logger.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 #include <time.h>
 
+#define DRAIN_INTERVAL_MS 50    // Longest time a record waits in a ring
+#define RING_CACHE_SIZE 4       // Rings remembered per thread (one per logger it logs to)
+
 // Optional color codes
 static const char *level_colors[] = {
     "\x1b[36m", // DEBUG - Cyan
@@ -16,85 +23,388 @@ static const char *level_colors[] = {
 };
 
 static const char *level_names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+static const char color_reset[] = "\x1b[0m";
+static const char dropped_note[] = "... earlier log output dropped ...\n";
+
+// Single-producer single-consumer byte ring: the owning thread appends whole records,
+// the drainer writes out [tail, head)
+typedef struct LogRing {
+    _Atomic size_t head;        // Bytes ever written (only the owner stores it)
+    _Atomic size_t tail;        // Bytes ever drained (only the drainer stores it)
+    struct LogRing *next;
+    char data[LOGGER_RING_SIZE];
+} LogRing;
+
+struct LoggerAsync {
+    uint64_t id;                // Never reused, so thread caches cannot confuse two loggers
+    pthread_t thread;
+    pthread_mutex_t lock;       // Held while draining and while adding a ring
+    pthread_cond_t wake;
+    LogRing *rings;
+    bool stopping;
+};
+
+// Ring of this thread for a recently used asynchronous logger
+typedef struct {
+    uint64_t id;
+    LogRing *ring;
+} RingCacheEntry;
+
+// Global logger instance, and an optional per-thread override
+static _Atomic(Logger *) global_logger = NULL;
+static _Thread_local Logger *thread_logger = NULL;
+
+static atomic_uint_fast64_t next_async_id = 1;
+static _Thread_local RingCacheEntry ring_cache[RING_CACHE_SIZE];
+static _Thread_local unsigned ring_cache_next;
+
+// Formatted local time, recomputed only when the second changes
+static const char *timestamp(void) {
+    static _Thread_local time_t cached_second = (time_t)-1;
+    static _Thread_local char cached_text[20];
+    const time_t now = time(NULL);
+    if (now != cached_second) {
+        struct tm tm_info;
+        localtime_r(&now, &tm_info);
+        strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S", &tm_info);
+        cached_second = now;
+    }
+    return cached_text;
+}
+
+// Formats one complete record (colors, header, message, newline) into 'record'
+static size_t format_record(const Logger *logger, const LogLevel level, const char *file, const int line,
+                            const char *fmt, va_list args, char *record) {
+    // Room kept back for the newline and the color reset, so a truncated record still ends cleanly
+    const size_t limit = LOGGER_RECORD_MAX - sizeof(color_reset);
+    int length = snprintf(record, limit, "%s[%s] %s", logger->use_colors ? level_colors[level] : "", timestamp(),
+                          level_names[level]);
+    if (file && line > 0 && length >= 0 && (size_t)length < limit) {
+        length += snprintf(record + length, limit - (size_t)length, " [%s:%d]", file, line);
+    }
+    if (length >= 0 && (size_t)length < limit) {
+        length += snprintf(record + length, limit - (size_t)length, ": ");
+    }
+    if (length >= 0 && (size_t)length < limit) {
+        length += vsnprintf(record + length, limit - (size_t)length, fmt, args);
+    }
+    size_t size = length < 0 ? 0 : (size_t)length < limit ? (size_t)length : limit - 1;
+
+    record[size++] = '\n';
+    if (logger->use_colors) {
+        memcpy(record + size, color_reset, sizeof(color_reset) - 1);
+        size += sizeof(color_reset) - 1;
+    }
+    return size;
+}
+
+// Writes the unread part of every ring; the caller holds async->lock
+static void drain(LoggerAsync *async, FILE *stream) {
+    for (LogRing *ring = async->rings; ring; ring = ring->next) {
+        const size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        if (head == tail) continue;
+
+        const size_t start = tail % LOGGER_RING_SIZE;
+        const size_t size = head - tail;
+        const size_t first = size < LOGGER_RING_SIZE - start ? size : LOGGER_RING_SIZE - start;
+        fwrite(ring->data + start, 1, first, stream);
+        if (first < size) fwrite(ring->data, 1, size - first, stream);
+        atomic_store_explicit(&ring->tail, head, memory_order_release);
+    }
+    fflush(stream);
+}
+
+static void *drain_loop(void *arg) {
+    Logger *logger = arg;
+    LoggerAsync *async = logger->async;
+    pthread_mutex_lock(&async->lock);
+    while (!async->stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += DRAIN_INTERVAL_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&async->wake, &async->lock, &deadline);
+        drain(async, logger->stream);
+    }
+    drain(async, logger->stream);
+    pthread_mutex_unlock(&async->lock);
+    return NULL;
+}
+
+// Finds (or registers) the calling thread's ring of an asynchronous logger
+static LogRing *thread_ring(LoggerAsync *async) {
+    for (unsigned i = 0; i < RING_CACHE_SIZE; i++) {
+        if (ring_cache[i].id == async->id) return ring_cache[i].ring;
+    }
+
+    LogRing *ring = malloc(sizeof(LogRing));
+    if (!ring) return NULL;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    pthread_mutex_lock(&async->lock);
+    ring->next = async->rings;
+    async->rings = ring;
+    pthread_mutex_unlock(&async->lock);
+
+    RingCacheEntry *entry = &ring_cache[ring_cache_next++ % RING_CACHE_SIZE];
+    entry->id = async->id;
+    entry->ring = ring;
+    return ring;
+}
+
+// Appends a record to a ring, waiting for the drainer while the ring is full
+static void ring_put(LoggerAsync *async, LogRing *ring, const char *record, const size_t size) {
+    const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (head + size - atomic_load_explicit(&ring->tail, memory_order_acquire) > LOGGER_RING_SIZE) {
+        pthread_cond_signal(&async->wake);
+        sched_yield();
+    }
+
+    const size_t start = head % LOGGER_RING_SIZE;
+    const size_t first = size < LOGGER_RING_SIZE - start ? size : LOGGER_RING_SIZE - start;
+    memcpy(ring->data + start, record, first);
+    memcpy(ring->data, record + first, size - first);
+    atomic_store_explicit(&ring->head, head + size, memory_order_release);
+}
+
+static void memory_lock(Logger *logger) {
+    while (atomic_flag_test_and_set_explicit(&logger->mem_lock, memory_order_acquire)) sched_yield();
+}
+
+static void memory_unlock(Logger *logger) {
+    atomic_flag_clear_explicit(&logger->mem_lock, memory_order_release);
+}
+
+// Start of the first record that follows a newline logged in [from, to), or 'to' if there is none
+static uint64_t memory_next_record(const Logger *logger, uint64_t from, const uint64_t to) {
+    while (from < to) {
+        const size_t index = (size_t)(from % logger->mem_size);
+        const size_t length = to - from < logger->mem_size - index ? (size_t)(to - from) : logger->mem_size - index;
+        const char *newline = memchr(logger->mem_buffer + index, '\n', length);
+        if (newline) return from + (uint64_t)(newline - (logger->mem_buffer + index)) + 1;
+        from += length;
+    }
+    return to;
+}
+
+// Appends a record to the circular memory log
+static void memory_put(Logger *logger, const char *record, size_t size) {
+    memory_lock(logger);
+    const bool truncated = size > logger->mem_size;
+    if (truncated) {
+        logger->mem_written += size - logger->mem_size;
+        record += size - logger->mem_size;
+        size = logger->mem_size;
+    }
+
+    // If this write reaches into the oldest record, the next one becomes the oldest complete record.
+    // Its start is found before the bytes that end the damaged record are overwritten.
+    const uint64_t end = logger->mem_written + size;
+    if (end > logger->mem_size) {
+        logger->mem_dropped = true;
+        const uint64_t kept = end - logger->mem_size;  // Oldest byte still held after this write
+        if (logger->mem_first < kept) logger->mem_first = memory_next_record(logger, kept - 1, logger->mem_written);
+    }
 
-// Global logger instance
-static Logger *global_logger = NULL;
+    const size_t start = (size_t)(logger->mem_written % logger->mem_size);
+    const size_t first = size < logger->mem_size - start ? size : logger->mem_size - start;
+    memcpy(logger->mem_buffer + start, record, first);
+    memcpy(logger->mem_buffer, record + first, size - first);
+    logger->mem_written = end;
+    if (truncated) logger->mem_first = end;  // Not even this record is whole
+    memory_unlock(logger);
+}
+
+static void reverse(char *begin, char *end) {
+    while (begin < --end) {
+        const char c = *begin;
+        *begin++ = *end;
+        *end = c;
+    }
+}
 
 Logger *logger_create(const char *log_filepath, const LogLevel level, const bool use_colors) {
+    if (!log_filepath) return logger_create_memory(LOGGER_MEMORY_SIZE, level, use_colors);
+
     Logger *logger = calloc(1, sizeof(Logger));
     if (!logger) return NULL;
 
     logger->level = level;
     logger->use_colors = use_colors;
+    atomic_flag_clear(&logger->mem_lock);
 
-    if (log_filepath) {
-        logger->stream = fopen(log_filepath, "w");
-        if (!logger->stream) {
-            free(logger);
-            return NULL;
-        }
-    } else {
-        logger->stream = open_memstream(&logger->mem_buffer, &logger->mem_size);
-        if (!logger->stream) {
-            free(logger);
-            return NULL;
-        }
+    logger->stream = fopen(log_filepath, "w");
+    if (!logger->stream) {
+        free(logger);
+        return NULL;
     }
 
     return logger;
 }
 
-void logger_log(Logger *logger, LogLevel level, const char *file, int line, const char *fmt, ...) {
-    if (!logger || level < logger->level) return;
-
-    // Timestamp
-    time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
-    char time_buf[20];
-    strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", tm_info);
+Logger *logger_create_memory(const size_t capacity, const LogLevel level, const bool use_colors) {
+    if (capacity == 0) return NULL;
+    Logger *logger = calloc(1, sizeof(Logger));
+    if (!logger) return NULL;
 
-    // Color if enabled
-    if (logger->use_colors) fprintf(logger->stream, "%s", level_colors[level]);
+    logger->level = level;
+    logger->use_colors = use_colors;
+    atomic_flag_clear(&logger->mem_lock);
+    logger->mem_buffer = malloc(capacity);
+    if (!logger->mem_buffer) {
+        free(logger);
+        return NULL;
+    }
+    logger->mem_size = capacity;
+    return logger;
+}
 
-    // Log format start
-    fprintf(logger->stream, "[%s] %s", time_buf, level_names[level]);
+Logger *logger_create_async(const char *log_filepath, const LogLevel level, const bool use_colors) {
+    Logger *logger = calloc(1, sizeof(Logger));
+    LoggerAsync *async = calloc(1, sizeof(LoggerAsync));
+    if (!logger || !async) {
+        free(logger);
+        free(async);
+        return NULL;
+    }
+    logger->level = level;
+    logger->use_colors = use_colors;
+    atomic_flag_clear(&logger->mem_lock);
+    logger->stream = log_filepath ? fopen(log_filepath, "w") : stderr;
+    if (!logger->stream) {
+        free(logger);
+        free(async);
+        return NULL;
+    }
 
-    // Conditionally print user file and line if provided
-    if (file && line > 0) {
-        fprintf(logger->stream, " [%s:%d]", file, line);
+    async->id = atomic_fetch_add(&next_async_id, 1);
+    pthread_mutex_init(&async->lock, NULL);
+    pthread_cond_init(&async->wake, NULL);
+    logger->async = async;
+    if (pthread_create(&async->thread, NULL, drain_loop, logger) != 0) {
+        pthread_cond_destroy(&async->wake);
+        pthread_mutex_destroy(&async->lock);
+        if (logger->stream != stderr) fclose(logger->stream);
+        free(async);
+        free(logger);
+        return NULL;
     }
+    return logger;
+}
 
-    fprintf(logger->stream, ": ");
+void logger_log(Logger *logger, LogLevel level, const char *file, int line, const char *fmt, ...) {
+    if (!logger || level < logger->level) return;
 
-    // Formatted message
+    char record[LOGGER_RECORD_MAX];
     va_list args;
     va_start(args, fmt);
-    vfprintf(logger->stream, fmt, args);
+    const size_t size = format_record(logger, level, file, line, fmt, args, record);
     va_end(args);
 
-    fprintf(logger->stream, "\n");
-    if (logger->use_colors) fprintf(logger->stream, "\x1b[0m"); // Reset color
+    LogRing *ring = logger->async ? thread_ring(logger->async) : NULL;
+    if (!logger->stream) {
+        memory_put(logger, record, size);
+    } else if (ring) {
+        ring_put(logger->async, ring, record, size);
+    } else {
+        // One fwrite takes the stream lock once, so records from concurrent threads do not interleave
+        fwrite(record, 1, size, logger->stream);
+    }
+}
+
+void logger_flush(Logger *logger) {
+    if (!logger) return;
+    if (logger->async) {
+        pthread_mutex_lock(&logger->async->lock);
+        drain(logger->async, logger->stream);
+        pthread_mutex_unlock(&logger->async->lock);
+    } else if (logger->stream) {
+        fflush(logger->stream);
+    }
+}
+
+const char *logger_contents(Logger *logger, size_t *size, bool *dropped) {
+    *size = 0;
+    if (dropped) *dropped = false;
+    if (!logger || logger->stream) return NULL;
+
+    memory_lock(logger);
+    if (logger->mem_written > logger->mem_size) {
+        // Rotate the oldest byte to the front; the next record then overwrites it, as before
+        const size_t start = (size_t)(logger->mem_written % logger->mem_size);
+        reverse(logger->mem_buffer, logger->mem_buffer + start);
+        reverse(logger->mem_buffer + start, logger->mem_buffer + logger->mem_size);
+        reverse(logger->mem_buffer, logger->mem_buffer + logger->mem_size);
+        logger->mem_first -= logger->mem_written - logger->mem_size;
+        logger->mem_written = logger->mem_size;
+    }
+
+    // Start at the oldest complete record; only a partly overwritten one is skipped
+    const size_t skip = (size_t)logger->mem_first;
+    *size = (size_t)logger->mem_written - skip;
+    if (dropped) *dropped = logger->mem_dropped;
+    memory_unlock(logger);
+    return logger->mem_buffer + skip;
 }
 
 void logger_dump(Logger *logger, FILE *target) {
-    if (!logger || !logger->mem_buffer || !target) return;
-    fflush(logger->stream); // Ensure all data is written to buffer
-    fwrite(logger->mem_buffer, 1, logger->mem_size, target);
+    if (!logger || !target) return;
+    size_t size;
+    bool dropped;
+    const char *contents = logger_contents(logger, &size, &dropped);
+    if (dropped) fputs(dropped_note, target);
+    if (contents) fwrite(contents, 1, size, target);
+}
+
+void logger_clear(Logger *logger) {
+    if (!logger || logger->stream) return;
+    memory_lock(logger);
+    logger->mem_written = 0;
+    logger->mem_first = 0;
+    logger->mem_dropped = false;
+    memory_unlock(logger);
 }
 
 void logger_free(Logger *logger) {
     if (!logger) return;
-    fflush(logger->stream);
-    fclose(logger->stream);
+    LoggerAsync *async = logger->async;
+    if (async) {
+        // The drainer writes out what is left before it exits
+        pthread_mutex_lock(&async->lock);
+        async->stopping = true;
+        pthread_cond_signal(&async->wake);
+        pthread_mutex_unlock(&async->lock);
+        pthread_join(async->thread, NULL);
+        while (async->rings) {
+            LogRing *next = async->rings->next;
+            free(async->rings);
+            async->rings = next;
+        }
+        pthread_cond_destroy(&async->wake);
+        pthread_mutex_destroy(&async->lock);
+        free(async);
+    }
+    if (logger->stream) {
+        fflush(logger->stream);
+        if (logger->stream != stderr) fclose(logger->stream);
+    }
     free(logger->mem_buffer);
     free(logger);
 }
 
 // Global logger setters/getters
 void logger_set_global(Logger *logger) {
-    global_logger = logger;
+    atomic_store(&global_logger, logger);
 }
 
 Logger *logger_get_global(void) {
-    return global_logger;
+    return thread_logger ? thread_logger : atomic_load_explicit(&global_logger, memory_order_acquire);
+}
+
+void logger_set_thread(Logger *logger) {
+    thread_logger = logger;
 }
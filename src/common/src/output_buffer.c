@@ -0,0 +1,80 @@
+#include "output_buffer.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MIN_CAPACITY 4096
+
+OutputBuffer *output_buffer_create(const size_t initial_capacity) {
+    OutputBuffer *buffer = calloc(1, sizeof(OutputBuffer));
+    if (!buffer) return NULL;
+    if (initial_capacity > 0 && !output_buffer_reserve(buffer, initial_capacity)) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+bool output_buffer_reserve(OutputBuffer *buffer, const size_t additional) {
+    if (!buffer) return false;
+    // Always allocate on first use, so an empty claim still returns a valid pointer
+    if (buffer->data && buffer->capacity - buffer->size >= additional) return true;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : MIN_CAPACITY;
+    while (capacity - buffer->size < additional) capacity *= 2;
+
+    char *data = realloc(buffer->data, capacity);
+    if (!data) return false;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+char *output_buffer_claim(OutputBuffer *buffer, const size_t length) {
+    if (!output_buffer_reserve(buffer, length)) return NULL;
+    char *claimed = buffer->data + buffer->size;
+    buffer->size += length;
+    return claimed;
+}
+
+bool output_buffer_append(OutputBuffer *buffer, const void *data, const size_t length) {
+    char *claimed = output_buffer_claim(buffer, length);
+    if (!claimed) return false;
+    memcpy(claimed, data, length);
+    return true;
+}
+
+bool output_buffer_flush(OutputBuffer *buffer, FILE *target) {
+    if (!buffer || !target) return false;
+
+    // Anything already in the stdio buffer must land first
+    if (fflush(target) != 0) return false;
+
+    const int fd = fileno(target);
+    if (fd < 0) {
+        // Memory streams and similar have no descriptor
+        const bool ok = fwrite(buffer->data, 1, buffer->size, target) == buffer->size;
+        buffer->size = 0;
+        return ok;
+    }
+
+    // One write() covers the whole buffer unless the kernel accepts it in pieces
+    size_t written = 0;
+    while (written < buffer->size) {
+        const ssize_t n = write(fd, buffer->data + written, buffer->size - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += (size_t)n;
+    }
+    buffer->size = 0;
+    return true;
+}
+
+void output_buffer_free(OutputBuffer *buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    free(buffer);
+}
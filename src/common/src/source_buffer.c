@@ -0,0 +1,75 @@
+#include "source_buffer.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define READ_CHUNK_SIZE 65536
+
+// Reads a non-mappable stream to EOF into one heap buffer
+static bool read_stream(SourceBuffer *buffer, FILE *file) {
+    char *data = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    for (;;) {
+        if (capacity - size < READ_CHUNK_SIZE) {
+            capacity = capacity ? capacity * 2 : READ_CHUNK_SIZE;
+            char *grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                return false;
+            }
+            data = grown;
+        }
+        const size_t n = fread(data + size, 1, capacity - size, file);
+        size += n;
+        if (n == 0) break;
+    }
+
+    if (ferror(file)) {
+        free(data);
+        return false;
+    }
+
+    buffer->data = data;
+    buffer->size = size;
+    buffer->mapped = false;
+    return true;
+}
+
+SourceBuffer *source_buffer_create(FILE *file) {
+    if (!file) return NULL;
+
+    SourceBuffer *buffer = calloc(1, sizeof(SourceBuffer));
+    if (!buffer) return NULL;
+
+    // Memory streams have no descriptor; fall back to reading
+    const int fd = fileno(file);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+            buffer->data = data;
+            buffer->size = (size_t)st.st_size;
+            buffer->mapped = true;
+            return buffer;
+        }
+    }
+
+    if (!read_stream(buffer, file)) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+void source_buffer_free(SourceBuffer *buffer) {
+    if (!buffer) return;
+    if (buffer->mapped) {
+        munmap((void *)buffer->data, buffer->size);
+    } else {
+        free((void *)buffer->data);
+    }
+    free(buffer);
+}
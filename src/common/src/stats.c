@@ -0,0 +1,132 @@
+#include "stats.h"
+#include "alloc_stats.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+static Stats *global_stats = NULL;
+
+static uint64_t clock_ns(const clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+Stats *stats_create(void) {
+    Stats *stats = calloc(1, sizeof(Stats));
+    if (!stats) return NULL;
+    stats->start_wall_ns = clock_ns(CLOCK_MONOTONIC);
+    stats->start_cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+    return stats;
+}
+
+void stats_free(Stats *stats) {
+    free(stats);
+}
+
+void stats_begin(StatsMark *mark) {
+    mark->active = global_stats != NULL;
+    if (!mark->active) return;
+    mark->wall_ns = clock_ns(CLOCK_MONOTONIC);
+    mark->cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+void stats_end(const char *phase, const StatsMark *mark) {
+    Stats *stats = global_stats;
+    if (!stats || !mark->active) return;
+    const uint64_t wall = clock_ns(CLOCK_MONOTONIC) - mark->wall_ns;
+    const uint64_t cpu = clock_ns(CLOCK_PROCESS_CPUTIME_ID) - mark->cpu_ns;
+
+    size_t i = 0;
+    while (i < stats->phase_count && strcmp(stats->phases[i].name, phase) != 0) i++;
+    if (i == stats->phase_count) {
+        if (i == STATS_MAX_PHASES) return;
+        stats->phases[stats->phase_count++].name = phase;
+    }
+    stats->phases[i].wall_ns += wall;
+    stats->phases[i].cpu_ns += cpu;
+}
+
+void stats_count(const char *counter, const uint64_t value) {
+    Stats *stats = global_stats;
+    if (!stats) return;
+
+    size_t i = 0;
+    while (i < stats->counter_count && strcmp(stats->counters[i].name, counter) != 0) i++;
+    if (i == stats->counter_count) {
+        if (i == STATS_MAX_COUNTERS) return;
+        stats->counters[stats->counter_count++].name = counter;
+    }
+    stats->counters[i].value += value;
+}
+
+static double ms(const uint64_t ns) {
+    return (double)ns / 1e6;
+}
+
+void stats_report(const Stats *stats, FILE *file, const bool json) {
+    if (!stats || !file) return;
+    const uint64_t wall = clock_ns(CLOCK_MONOTONIC) - stats->start_wall_ns;
+    const uint64_t cpu = clock_ns(CLOCK_PROCESS_CPUTIME_ID) - stats->start_cpu_ns;
+    const double seconds = wall > 0 ? (double)wall / 1e9 : 1e-9;
+    struct rusage usage;
+    const long peak_rss_kb = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+
+    if (json) {
+        fprintf(file, "{\"phases\":{");
+        for (size_t i = 0; i < stats->phase_count; i++) {
+            const StatsPhase *phase = &stats->phases[i];
+            fprintf(file, "%s\"%s\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f}", i ? "," : "", phase->name,
+                    ms(phase->wall_ns), ms(phase->cpu_ns));
+        }
+        fprintf(file, "},\"total\":{\"wall_ms\":%.3f,\"cpu_ms\":%.3f},\"counters\":{", ms(wall), ms(cpu));
+        for (size_t i = 0; i < stats->counter_count; i++) {
+            const StatsCounter *counter = &stats->counters[i];
+            fprintf(file, "%s\"%s\":%" PRIu64 ",\"%s_per_second\":%.0f", i ? "," : "", counter->name,
+                    counter->value, counter->name, (double)counter->value / seconds);
+        }
+        fprintf(file, "},");
+#ifdef ALLOC_STATS_ENABLED
+        fprintf(file, "\"allocations\":{");
+        for (int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+            const AllocTagStats alloc = alloc_stats_get((AllocTag)tag);
+            fprintf(file, "%s\"%s\":{\"count\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"peak_bytes\":%" PRIu64 "}",
+                    tag ? "," : "", alloc_tag_name((AllocTag)tag), alloc.count, alloc.bytes, alloc.peak_bytes);
+        }
+        fprintf(file, "},");
+#endif
+        fprintf(file, "\"peak_rss_kb\":%ld}\n", peak_rss_kb);
+        return;
+    }
+
+    fprintf(file, "%-12s %12s %12s\n", "phase", "wall ms", "cpu ms");
+    for (size_t i = 0; i < stats->phase_count; i++) {
+        const StatsPhase *phase = &stats->phases[i];
+        fprintf(file, "%-12s %12.3f %12.3f\n", phase->name, ms(phase->wall_ns), ms(phase->cpu_ns));
+    }
+    fprintf(file, "%-12s %12.3f %12.3f\n", "total", ms(wall), ms(cpu));
+    for (size_t i = 0; i < stats->counter_count; i++) {
+        const StatsCounter *counter = &stats->counters[i];
+        fprintf(file, "%-12s %12" PRIu64 " %12.2f M/s\n", counter->name, counter->value,
+                (double)counter->value / seconds / 1e6);
+    }
+#ifdef ALLOC_STATS_ENABLED
+    fprintf(file, "%-12s %12s %12s %12s\n", "allocations", "count", "bytes", "peak bytes");
+    for (int tag = 0; tag < ALLOC_TAG_COUNT; tag++) {
+        const AllocTagStats alloc = alloc_stats_get((AllocTag)tag);
+        fprintf(file, "%-12s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n", alloc_tag_name((AllocTag)tag),
+                alloc.count, alloc.bytes, alloc.peak_bytes);
+    }
+#endif
+    fprintf(file, "%-12s %12ld KiB\n", "peak RSS", peak_rss_kb);
+}
+
+void stats_set_global(Stats *stats) {
+    global_stats = stats;
+}
+
+Stats *stats_get_global(void) {
+    return global_stats;
+}
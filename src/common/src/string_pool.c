@@ -0,0 +1,191 @@
+#include "string_pool.h"
+#include <alloc_stats.h>
+#include <arena.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_SIZE 65536          // Bytes of the first storage chunk (later ones grow)
+#define INITIAL_IDS 256
+#define INITIAL_SLOTS 512         // Must be a power of two
+#define EMPTY_SLOT 0u             // Slots store id + 1, so 0 means empty
+
+// Internal struct definition (hidden from user)
+struct StringPool {
+    // Per-id data (structure of arrays, indexed by StringId)
+    const char **strings;
+    uint32_t *lengths;
+    uint32_t *hashes;
+    size_t count;
+    size_t id_capacity;
+
+    // Open-addressing index from hash to id (linear probing)
+    uint32_t *slots;
+    size_t slot_capacity;
+
+    Arena *storage;          // String bytes; arena memory never moves, so neither do strings
+};
+
+uint32_t string_pool_hash_bytes(const char *str, const size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1u;
+}
+
+// Returns the slot holding the string, or the empty slot where it would be inserted
+static size_t find_slot(const StringPool *pool, const char *str, const size_t length, const uint32_t hash) {
+    const size_t mask = pool->slot_capacity - 1;
+    size_t slot = hash & mask;
+    while (pool->slots[slot] != EMPTY_SLOT) {
+        const StringId id = pool->slots[slot] - 1;
+        if (pool->hashes[id] == hash && pool->lengths[id] == length &&
+            memcmp(pool->strings[id], str, length) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Doubles the index and reinserts every id using its stored hash
+static bool grow_slots(StringPool *pool) {
+    const size_t capacity = pool->slot_capacity * 2;
+    uint32_t *slots = TRACKED_CALLOC(ALLOC_TAG_STRINGS, capacity, sizeof(uint32_t));
+    if (!slots) return false;
+
+    const size_t mask = capacity - 1;
+    for (size_t id = 0; id < pool->count; id++) {
+        size_t slot = pool->hashes[id] & mask;
+        while (slots[slot] != EMPTY_SLOT) slot = (slot + 1) & mask;
+        slots[slot] = (uint32_t)id + 1;
+    }
+
+    TRACKED_FREE(ALLOC_TAG_STRINGS, pool->slots);
+    pool->slots = slots;
+    pool->slot_capacity = capacity;
+    return true;
+}
+
+static bool grow_ids(StringPool *pool) {
+    const size_t capacity = pool->id_capacity * 2;
+    const char **strings = TRACKED_REALLOC(ALLOC_TAG_STRINGS, pool->strings, capacity * sizeof(char *));
+    if (!strings) return false;
+    pool->strings = strings;
+    uint32_t *lengths = TRACKED_REALLOC(ALLOC_TAG_STRINGS, pool->lengths, capacity * sizeof(uint32_t));
+    if (!lengths) return false;
+    pool->lengths = lengths;
+    uint32_t *hashes = TRACKED_REALLOC(ALLOC_TAG_STRINGS, pool->hashes, capacity * sizeof(uint32_t));
+    if (!hashes) return false;
+    pool->hashes = hashes;
+    pool->id_capacity = capacity;
+    return true;
+}
+
+// Copies a string (plus terminator) into arena storage
+static const char *store(StringPool *pool, const char *str, const size_t length) {
+    char *copy = arena_alloc_bytes(pool->storage, length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+StringPool *string_pool_create(void) {
+    StringPool *pool = TRACKED_CALLOC(ALLOC_TAG_STRINGS, 1, sizeof(StringPool));
+    if (!pool) return NULL;
+
+    pool->strings = TRACKED_MALLOC(ALLOC_TAG_STRINGS, INITIAL_IDS * sizeof(char *));
+    pool->lengths = TRACKED_MALLOC(ALLOC_TAG_STRINGS, INITIAL_IDS * sizeof(uint32_t));
+    pool->hashes = TRACKED_MALLOC(ALLOC_TAG_STRINGS, INITIAL_IDS * sizeof(uint32_t));
+    pool->slots = TRACKED_CALLOC(ALLOC_TAG_STRINGS, INITIAL_SLOTS, sizeof(uint32_t));
+    pool->storage = arena_create(BLOCK_SIZE, 0);
+    if (!pool->strings || !pool->lengths || !pool->hashes || !pool->slots || !pool->storage) {
+        string_pool_free(pool);
+        return NULL;
+    }
+    pool->id_capacity = INITIAL_IDS;
+    pool->slot_capacity = INITIAL_SLOTS;
+    return pool;
+}
+
+void string_pool_free(StringPool *pool) {
+    if (!pool) return;
+
+    arena_free(pool->storage);
+    TRACKED_FREE(ALLOC_TAG_STRINGS, pool->strings);
+    TRACKED_FREE(ALLOC_TAG_STRINGS, pool->lengths);
+    TRACKED_FREE(ALLOC_TAG_STRINGS, pool->hashes);
+    TRACKED_FREE(ALLOC_TAG_STRINGS, pool->slots);
+    TRACKED_FREE(ALLOC_TAG_STRINGS, pool);
+}
+
+StringId string_pool_intern(StringPool *pool, const char *str, const size_t length) {
+    if (!pool || !str || length > UINT32_MAX || pool->count >= STRING_ID_NONE - 1) return STRING_ID_NONE;
+
+    const uint32_t hash = string_pool_hash_bytes(str, length);
+    size_t slot = find_slot(pool, str, length, hash);
+    if (pool->slots[slot] != EMPTY_SLOT) return pool->slots[slot] - 1;
+
+    // Keep the index at most half full
+    if ((pool->count + 1) * 2 > pool->slot_capacity) {
+        if (!grow_slots(pool)) return STRING_ID_NONE;
+        slot = find_slot(pool, str, length, hash);
+    }
+    if (pool->count == pool->id_capacity && !grow_ids(pool)) return STRING_ID_NONE;
+
+    const char *copy = store(pool, str, length);
+    if (!copy) return STRING_ID_NONE;
+
+    const StringId id = (StringId)pool->count++;
+    pool->strings[id] = copy;
+    pool->lengths[id] = (uint32_t)length;
+    pool->hashes[id] = hash;
+    pool->slots[slot] = id + 1;
+    return id;
+}
+
+StringId string_pool_find(const StringPool *pool, const char *str, const size_t length) {
+    if (!pool || !str) return STRING_ID_NONE;
+    const size_t slot = find_slot(pool, str, length, string_pool_hash_bytes(str, length));
+    return pool->slots[slot] != EMPTY_SLOT ? pool->slots[slot] - 1 : STRING_ID_NONE;
+}
+
+const char *string_pool_get(const StringPool *pool, const StringId id) {
+    if (!pool || id >= pool->count) return NULL;
+    return pool->strings[id];
+}
+
+size_t string_pool_length(const StringPool *pool, const StringId id) {
+    if (!pool || id >= pool->count) return 0;
+    return pool->lengths[id];
+}
+
+uint32_t string_pool_hash(const StringPool *pool, const StringId id) {
+    if (!pool || id >= pool->count) return 0;
+    return pool->hashes[id];
+}
+
+size_t string_pool_count(const StringPool *pool) {
+    return pool ? pool->count : 0;
+}
+
+void string_pool_truncate(StringPool *pool, const size_t count) {
+    if (!pool || count >= pool->count) return;
+
+    // Strings are stored in id order, so rewinding past the last kept string drops all the others
+    ArenaMark mark = {0, 0};
+    if (count) arena_mark_at(pool->storage, pool->strings[count - 1] + pool->lengths[count - 1] + 1, &mark);
+    arena_reset(pool->storage, mark);
+
+    // Rebuild the index from the kept ids
+    memset(pool->slots, 0, pool->slot_capacity * sizeof(uint32_t));
+    const size_t mask = pool->slot_capacity - 1;
+    for (size_t id = 0; id < count; id++) {
+        size_t slot = pool->hashes[id] & mask;
+        while (pool->slots[slot] != EMPTY_SLOT) slot = (slot + 1) & mask;
+        pool->slots[slot] = (uint32_t)id + 1;
+    }
+    pool->count = count;
+}
@@ -0,0 +1,303 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np, CPU_SET
+#include "thread_pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define INITIAL_DEQUE_CAPACITY 64
+
+typedef struct {
+    TaskFunc func;
+    void *arg;
+    TaskGroup *group;
+} Task;
+
+// Ring buffer of tasks; the owner uses the bottom (tail), thieves take from the top (head)
+typedef struct {
+    pthread_mutex_t lock;
+    Task *tasks;
+    size_t capacity;    // Power of two
+    size_t head;
+    size_t tail;
+} TaskDeque;
+
+typedef struct {
+    ThreadPool *pool;
+    unsigned index;
+    pthread_t thread;
+    TaskDeque deque;
+} Worker;
+
+struct ThreadPool {
+    Worker *workers;
+    unsigned worker_count;
+    atomic_size_t queued;        // Tasks sitting in deques
+    atomic_uint next_victim;     // Round-robin target for external submissions
+    pthread_mutex_t lock;        // Protects sleeping/waking and 'stop'
+    pthread_cond_t wake;
+    bool stop;
+};
+
+struct TaskGroup {
+    ThreadPool *pool;
+    atomic_size_t pending;       // Submitted tasks not yet finished (finishing ones decrement under 'lock')
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+};
+
+static ThreadPool *global_pool = NULL;
+
+// Identifies the pool worker running on this thread, if any
+static _Thread_local Worker *current_worker = NULL;
+
+static bool deque_init(TaskDeque *deque) {
+    deque->tasks = malloc(INITIAL_DEQUE_CAPACITY * sizeof(Task));
+    if (!deque->tasks) return false;
+    deque->capacity = INITIAL_DEQUE_CAPACITY;
+    deque->head = deque->tail = 0;
+    pthread_mutex_init(&deque->lock, NULL);
+    return true;
+}
+
+static void deque_destroy(TaskDeque *deque) {
+    pthread_mutex_destroy(&deque->lock);
+    free(deque->tasks);
+}
+
+static bool deque_push(TaskDeque *deque, const Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail - deque->head == deque->capacity) {
+        // Grow and unwrap the ring so head starts at index 0
+        Task *tasks = malloc(deque->capacity * 2 * sizeof(Task));
+        if (!tasks) {
+            pthread_mutex_unlock(&deque->lock);
+            return false;
+        }
+        const size_t mask = deque->capacity - 1;
+        for (size_t i = deque->head; i != deque->tail; i++) tasks[i - deque->head] = deque->tasks[i & mask];
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->tail -= deque->head;
+        deque->head = 0;
+        deque->capacity *= 2;
+    }
+    deque->tasks[deque->tail++ & (deque->capacity - 1)] = *task;
+    pthread_mutex_unlock(&deque->lock);
+    return true;
+}
+
+static bool deque_pop_bottom(TaskDeque *deque, Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    const bool found = deque->tail != deque->head;
+    if (found) *task = deque->tasks[--deque->tail & (deque->capacity - 1)];
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool deque_steal_top(TaskDeque *deque, Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    const bool found = deque->tail != deque->head;
+    if (found) *task = deque->tasks[deque->head++ & (deque->capacity - 1)];
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Takes a task for the calling thread: its own deque first, then the other deques in turn
+static bool find_task(ThreadPool *pool, Task *task) {
+    if (atomic_load_explicit(&pool->queued, memory_order_relaxed) == 0) return false;
+
+    unsigned start = 0;
+    if (current_worker && current_worker->pool == pool) {
+        if (deque_pop_bottom(&current_worker->deque, task)) goto found;
+        start = current_worker->index + 1;
+    }
+    for (unsigned i = 0; i < pool->worker_count; i++) {
+        if (deque_steal_top(&pool->workers[(start + i) % pool->worker_count].deque, task)) goto found;
+    }
+    return false;
+
+    found:
+    atomic_fetch_sub(&pool->queued, 1);
+    return true;
+}
+
+static void run_task(const Task *task) {
+    task->func(task->arg);
+
+    // Finish under the lock: a waiter that sees 'pending' reach 0 under it may free the group at once,
+    // so this thread must be done with the group by the time it lets go of the lock
+    TaskGroup *group = task->group;
+    pthread_mutex_lock(&group->lock);
+    if (atomic_fetch_sub(&group->pending, 1) == 1) pthread_cond_broadcast(&group->done);
+    pthread_mutex_unlock(&group->lock);
+}
+
+static void *worker_main(void *arg) {
+    Worker *worker = arg;
+    ThreadPool *pool = worker->pool;
+    current_worker = worker;
+
+    for (;;) {
+        Task task;
+        if (find_task(pool, &task)) {
+            run_task(&task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->stop) pthread_cond_wait(&pool->wake, &pool->lock);
+        const bool exit = pool->stop && atomic_load(&pool->queued) == 0;
+        pthread_mutex_unlock(&pool->lock);
+        if (exit) return NULL;
+    }
+}
+
+static void pin_to_cpu(const pthread_t thread, const unsigned index) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus <= 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % (unsigned)cpus, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);  // Best effort
+}
+
+ThreadPool *thread_pool_create(unsigned workers, const bool pin_workers) {
+    if (workers == 0) {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (unsigned)cpus : 1;
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+    pool->workers = calloc(workers, sizeof(Worker));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->next_victim, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (unsigned i = 0; i < workers; i++) {
+        Worker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        if (!deque_init(&worker->deque)) break;
+        pool->worker_count++;
+    }
+
+    // Start as many threads as possible; a pool with at least one worker is usable
+    unsigned started = 0;
+    for (; started < pool->worker_count; started++) {
+        Worker *worker = &pool->workers[started];
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) break;
+        if (pin_workers) pin_to_cpu(worker->thread, started);
+    }
+    for (unsigned i = started; i < pool->worker_count; i++) deque_destroy(&pool->workers[i].deque);
+    pool->worker_count = started;
+
+    if (started == 0) {
+        thread_pool_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+unsigned thread_pool_size(const ThreadPool *pool) {
+    return pool ? pool->worker_count : 0;
+}
+
+void thread_pool_free(ThreadPool *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    // Workers still running may steal from any deque, so destroy them only once all have exited
+    for (unsigned i = 0; i < pool->worker_count; i++) pthread_join(pool->workers[i].thread, NULL);
+    for (unsigned i = 0; i < pool->worker_count; i++) deque_destroy(&pool->workers[i].deque);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+TaskGroup *task_group_create(ThreadPool *pool) {
+    if (!pool) return NULL;
+    TaskGroup *group = malloc(sizeof(TaskGroup));
+    if (!group) return NULL;
+    group->pool = pool;
+    atomic_init(&group->pending, 0);
+    pthread_mutex_init(&group->lock, NULL);
+    pthread_cond_init(&group->done, NULL);
+    return group;
+}
+
+bool task_group_submit(TaskGroup *group, const TaskFunc func, void *arg) {
+    if (!group || !func) return false;
+    ThreadPool *pool = group->pool;
+
+    // Workers push onto their own deque; other threads spread tasks over all deques
+    Worker *worker = (current_worker && current_worker->pool == pool)
+        ? current_worker
+        : &pool->workers[atomic_fetch_add(&pool->next_victim, 1) % pool->worker_count];
+
+    // Count the task before it becomes visible, so 'queued' never drops below the real number
+    const Task task = {.func = func, .arg = arg, .group = group};
+    atomic_fetch_add(&group->pending, 1);
+    atomic_fetch_add(&pool->queued, 1);
+    if (!deque_push(&worker->deque, &task)) {
+        atomic_fetch_sub(&pool->queued, 1);
+        atomic_fetch_sub(&group->pending, 1);
+        return false;
+    }
+
+    // Signal under the lock so an idle worker cannot miss the wake-up
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+void task_group_wait(TaskGroup *group) {
+    if (!group) return;
+    ThreadPool *pool = group->pool;
+
+    for (;;) {
+        // Help with any queued work (this group's or another's) before sleeping
+        Task task;
+        if (atomic_load(&group->pending) > 0 && find_task(pool, &task)) {
+            run_task(&task);
+            continue;
+        }
+
+        // Everything left is running on other threads. Completion is only trusted under the lock,
+        // once the last task has released it (see run_task).
+        pthread_mutex_lock(&group->lock);
+        const bool finished = atomic_load(&group->pending) == 0;
+        if (!finished) pthread_cond_wait(&group->done, &group->lock);
+        pthread_mutex_unlock(&group->lock);
+        if (finished) return;
+    }
+}
+
+void task_group_join(TaskGroup *group) {
+    if (!group) return;
+    task_group_wait(group);
+    pthread_cond_destroy(&group->done);
+    pthread_mutex_destroy(&group->lock);
+    free(group);
+}
+
+void thread_pool_set_global(ThreadPool *pool) {
+    global_pool = pool;
+}
+
+ThreadPool *thread_pool_get_global(void) {
+    return global_pool;
+}
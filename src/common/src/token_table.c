@@ -1,97 +1,186 @@
 // Created by Alexander Fisher on 09/03/2025.
 
 #include "token_table.h"
+#include <alloc_stats.h>
 #include <stdlib.h>
+#include <string.h>
 
-// Internal node structure (hidden from user)
-typedef struct TokenNode {
-    void *token;
-    struct TokenNode *next;
-} TokenNode;
+// Tokens per chunk (power of two so index -> chunk is a shift and a mask)
+#define CHUNK_SHIFT 12
+#define CHUNK_TOKENS ((size_t)1 << CHUNK_SHIFT)
+#define CHUNK_MASK (CHUNK_TOKENS - 1)
+
+#define INITIAL_CHUNK_SLOTS 8
 
 // Internal struct definition (hidden from user)
 struct TokenTable {
-    TokenNode *head;
-    TokenNode *tail;
-    TokenNode *current;
+    unsigned char **chunks;    // Array of chunk pointers, each holding CHUNK_TOKENS records
+    size_t chunk_count;        // Number of allocated chunks
+    size_t chunk_slots;        // Capacity of the chunks array
+    size_t token_size;         // Size of a single record in bytes
+    size_t count;              // Number of records stored
+    size_t current;            // Iterator index
+
+    Arena *arena;              // Owner of the chunks, or NULL when they are heap blocks
 
     TokenFreeFunc free_func;
     TokenToStr token_to_str;
 };
 
-TokenTable *token_table_create(const TokenFreeFunc free_func, const TokenToStr token_to_str) {
-    TokenTable *table = malloc(sizeof(TokenTable));
+static inline void *record_at(const TokenTable *table, const size_t index) {
+    return table->chunks[index >> CHUNK_SHIFT] + (index & CHUNK_MASK) * table->token_size;
+}
+
+static bool add_chunk(TokenTable *table) {
+    if (table->chunk_count == table->chunk_slots) {
+        const size_t slots = table->chunk_slots ? table->chunk_slots * 2 : INITIAL_CHUNK_SLOTS;
+        unsigned char **chunks = TRACKED_REALLOC(ALLOC_TAG_TOKENS, table->chunks,
+                                                 slots * sizeof(unsigned char *));
+        if (!chunks) return false;
+        table->chunks = chunks;
+        table->chunk_slots = slots;
+    }
+
+    unsigned char *chunk = table->arena ? arena_alloc(table->arena, CHUNK_TOKENS * table->token_size)
+                                        : TRACKED_MALLOC(ALLOC_TAG_TOKENS, CHUNK_TOKENS * table->token_size);
+    if (!chunk) return false;
+    table->chunks[table->chunk_count++] = chunk;
+    return true;
+}
+
+TokenTable *token_table_create(const size_t token_size, const TokenFreeFunc free_func, const TokenToStr token_to_str) {
+    if (token_size == 0) return NULL;
+
+    TokenTable *table = TRACKED_CALLOC(ALLOC_TAG_TOKENS, 1, sizeof(TokenTable));
     if (!table) {
         return NULL;
     }
-    table->head = table->tail = table->current = NULL;
+    table->token_size = token_size;
     table->free_func = free_func;
     table->token_to_str = token_to_str;
     return table;
 }
 
-bool token_table_add(TokenTable *table, void *token) {
+TokenTable *token_table_create_arena(Arena *arena, const size_t token_size, const TokenFreeFunc free_func,
+                                     const TokenToStr token_to_str) {
+    if (!arena) return NULL;
+    TokenTable *table = token_table_create(token_size, free_func, token_to_str);
+    if (table) table->arena = arena;
+    return table;
+}
+
+bool token_table_add(TokenTable *table, const void *token) {
     if (!table || !token) return false;
 
-    TokenNode *new_node = malloc(sizeof(TokenNode));
-    if (!new_node) {
+    if (table->count == table->chunk_count * CHUNK_TOKENS && !add_chunk(table)) {
         return false;
     }
 
-    new_node->token = token;
-    new_node->next = NULL;
+    memcpy(record_at(table, table->count), token, table->token_size);
+    table->count++;
+    return true;
+}
 
-    if (table->tail) {
-        table->tail->next = new_node;
-    } else {
-        table->head = new_node;
+bool token_table_splice(TokenTable *dst, TokenTable *src) {
+    if (!dst || !src || dst == src || dst->token_size != src->token_size) return false;
+
+    const size_t dst_count = dst->count;
+    size_t moved = 0;
+    while (moved < src->count) {
+        if (dst->count == dst->chunk_count * CHUNK_TOKENS && !add_chunk(dst)) {
+            dst->count = dst_count;  // Drop the partial copy; src still owns every record
+            return false;
+        }
+        // Copy the longest run that stays inside one chunk of each table
+        const size_t dst_room = CHUNK_TOKENS - (dst->count & CHUNK_MASK);
+        const size_t src_room = CHUNK_TOKENS - (moved & CHUNK_MASK);
+        size_t run = src->count - moved;
+        if (run > dst_room) run = dst_room;
+        if (run > src_room) run = src_room;
+
+        memcpy(record_at(dst, dst->count), record_at(src, moved), run * src->token_size);
+        dst->count += run;
+        moved += run;
     }
 
-    table->tail = new_node;
+    src->count = 0;
+    src->current = 0;
     return true;
 }
 
-void *token_table_next(TokenTable *table) {
-    if (!table || !table->current) return NULL;
+size_t token_table_size(const TokenTable *table) {
+    return table ? table->count : 0;
+}
 
-    void *token = table->current->token;
-    table->current = table->current->next;
-    return token;
+void *token_table_get(const TokenTable *table, const size_t index) {
+    if (!table || index >= table->count) return NULL;
+    return record_at(table, index);
+}
+
+void *token_table_span(const TokenTable *table, const size_t index, size_t *count) {
+    if (!table || !count || index >= table->count) return NULL;
+    const size_t chunk_end = (index | CHUNK_MASK) + 1;
+    *count = (chunk_end < table->count ? chunk_end : table->count) - index;
+    return record_at(table, index);
+}
+
+void *token_table_next(TokenTable *table) {
+    if (!table || table->current >= table->count) return NULL;
+    return record_at(table, table->current++);
 }
 
 void *token_table_peek(TokenTable *table) {
-    if (!table || !table->current) return NULL;
-    return table->current->token;
+    return token_table_peek_ahead(table, 0);
+}
+
+void *token_table_peek_ahead(TokenTable *table, const size_t offset) {
+    if (!table || offset >= table->count - table->current) return NULL;
+    return record_at(table, table->current + offset);
+}
+
+void token_table_skip(TokenTable *table, const size_t count) {
+    if (!table) return;
+    const size_t remaining = table->count - table->current;
+    table->current += (count < remaining) ? count : remaining;
 }
 
 void token_table_reset(TokenTable *table) {
-    if (table) table->current = table->head;
+    if (table) table->current = 0;
+}
+
+void token_table_clear(TokenTable *table) {
+    if (!table) return;
+
+    if (table->free_func) {
+        for (size_t i = 0; i < table->count; i++) {
+            table->free_func(record_at(table, i));
+        }
+    }
+    table->count = 0;
+    table->current = 0;
 }
 
 void token_table_free(TokenTable *table) {
     if (!table) return;
 
-    TokenNode *current = table->head;
-    while (current) {
-        TokenNode *next = current->next;
-        if (table->free_func) {
-            table->free_func(current->token);  // Use user-supplied free function
+    if (table->free_func) {
+        for (size_t i = 0; i < table->count; i++) {
+            table->free_func(record_at(table, i));  // Release resources owned by the record
         }
-        free(current);
-        current = next;
     }
 
-    free(table);
+    for (size_t i = 0; !table->arena && i < table->chunk_count; i++) {
+        TRACKED_FREE(ALLOC_TAG_TOKENS, table->chunks[i]);
+    }
+    TRACKED_FREE(ALLOC_TAG_TOKENS, table->chunks);
+    TRACKED_FREE(ALLOC_TAG_TOKENS, table);
 }
 
-void token_table_write_to_file(FILE *file, TokenTable *table) {
+void token_table_write_to_file(FILE *file, TokenTable *table, const void *context) {
     if (!file || !table || !table->token_to_str) return;
 
-    token_table_reset(table);
-
-    void *token;
-    while ((token = token_table_next(table)) != NULL) {
-        char *token_str = table->token_to_str(token);
+    for (size_t i = 0; i < table->count; i++) {
+        char *token_str = table->token_to_str(record_at(table, i), context);
         fprintf(file, "%s\n", token_str);
         free(token_str);
     }
@@ -0,0 +1,44 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "alloc_stats.h"
+
+void test_alloc_stats_tags(void) {
+    alloc_stats_reset();
+
+    char *block = alloc_tracked_malloc(ALLOC_TAG_TOKENS, 100);
+    int *zeroed = alloc_tracked_calloc(ALLOC_TAG_TOKENS, 10, sizeof(int));
+    char *copy = alloc_tracked_strdup(ALLOC_TAG_STRINGS, "symbol");
+    assert(block && zeroed && zeroed[9] == 0 && copy && strcmp(copy, "symbol") == 0);
+
+    AllocTagStats tokens = alloc_stats_get(ALLOC_TAG_TOKENS);
+    assert(tokens.count == 2 && tokens.bytes >= 140 && tokens.live_bytes == tokens.bytes);
+    assert(alloc_stats_get(ALLOC_TAG_STRINGS).count == 1);
+    assert(alloc_stats_get(ALLOC_TAG_SYMBOLS).count == 0);
+
+    // A realloc is one more allocation; live bytes follow the new size
+    block = alloc_tracked_realloc(ALLOC_TAG_TOKENS, block, 4000);
+    assert(block != NULL);
+    tokens = alloc_stats_get(ALLOC_TAG_TOKENS);
+    assert(tokens.count == 3 && tokens.live_bytes >= 4040 && tokens.peak_bytes == tokens.live_bytes);
+
+    // Frees lower the live bytes but not the peak
+    const uint64_t peak = tokens.peak_bytes;
+    alloc_tracked_free(ALLOC_TAG_TOKENS, block);
+    alloc_tracked_free(ALLOC_TAG_TOKENS, zeroed);
+    alloc_tracked_free(ALLOC_TAG_STRINGS, copy);
+    alloc_tracked_free(ALLOC_TAG_STRINGS, NULL);
+    tokens = alloc_stats_get(ALLOC_TAG_TOKENS);
+    assert(tokens.live_bytes == 0 && tokens.peak_bytes == peak && tokens.count == 3);
+    assert(alloc_stats_get(ALLOC_TAG_STRINGS).live_bytes == 0);
+    assert(strcmp(alloc_tag_name(ALLOC_TAG_SYMBOLS), "symbols") == 0);
+
+    alloc_stats_reset();
+    assert(alloc_stats_get(ALLOC_TAG_TOKENS).peak_bytes == 0);
+    printf("\t✅ test_alloc_stats_tags passed!\n");
+}
+
+int main(void) {
+    test_alloc_stats_tags();
+    return 0;
+}
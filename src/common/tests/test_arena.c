@@ -0,0 +1,78 @@
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+
+void test_arena_alloc(void) {
+    Arena *arena = arena_create(256, 0);
+    assert(arena != NULL);
+    assert(arena_used(arena) == 0);
+
+    // Aligned allocations are aligned; byte allocations pack tightly
+    char *a = arena_alloc_bytes(arena, 3);
+    void *b = arena_alloc(arena, 8);
+    char *c = arena_alloc_bytes(arena, 5);
+    assert(a && b && c && (uintptr_t)b % alignof(max_align_t) == 0);
+    assert(c == (char *)b + 8);
+
+    // Requests beyond the chunk get their own chunk; earlier memory stays put
+    memset(a, 'x', 3);
+    char *big = arena_alloc(arena, 10000);
+    assert(big != NULL);
+    memset(big, 'y', 10000);
+    assert(a[0] == 'x' && a[2] == 'x');
+    for (int i = 0; i < 1000; i++) assert(arena_alloc(arena, 100) != NULL);
+    assert(arena_used(arena) >= 100000);
+
+    arena_free(arena);
+    printf("\t✅ test_arena_alloc passed!\n");
+}
+
+void test_arena_mark_reset(void) {
+    Arena *arena = arena_create(1024, 0);
+    assert(arena != NULL);
+    char *kept = arena_alloc_bytes(arena, 10);
+    const ArenaMark mark = arena_mark(arena);
+
+    // Memory after the mark is handed out again after a reset, without new chunks
+    char *first = arena_alloc_bytes(arena, 600);
+    char *second = arena_alloc_bytes(arena, 600);
+    const size_t used = arena_used(arena);
+    arena_reset(arena, mark);
+    assert(arena_used(arena) == 10);
+    assert(arena_alloc_bytes(arena, 600) == first);
+    assert(arena_alloc_bytes(arena, 600) == second);
+    assert(arena_used(arena) == used);
+
+    // A mark can be found from the end of an allocation
+    ArenaMark found;
+    assert(arena_mark_at(arena, kept + 10, &found));
+    assert(found.chunk == mark.chunk && found.used == mark.used);
+    assert(!arena_mark_at(arena, &found, &found));
+
+    // Resetting to the empty mark keeps memory for reuse
+    arena_reset(arena, (ArenaMark){0, 0});
+    assert(arena_used(arena) == 0 && arena_alloc_bytes(arena, 10) == kept);
+    arena_free(arena);
+    printf("\t✅ test_arena_mark_reset passed!\n");
+}
+
+void test_arena_huge_pages(void) {
+    Arena *arena = arena_create(4096, ARENA_HUGE_PAGES);
+    assert(arena != NULL);
+    int *values = arena_alloc(arena, 1000 * sizeof(int));
+    assert(values != NULL);
+    for (int i = 0; i < 1000; i++) values[i] = i;
+    assert(values[999] == 999);
+    arena_free(arena);
+    printf("\t✅ test_arena_huge_pages passed!\n");
+}
+
+int main(void) {
+    test_arena_alloc();
+    test_arena_mark_reset();
+    test_arena_huge_pages();
+    return 0;
+}
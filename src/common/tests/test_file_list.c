@@ -0,0 +1,84 @@
+#include "file_list.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void test_file_list_directory(void);
+
+int main(void) {
+    test_file_list_directory();
+    return 0;
+}
+
+static void touch(const char *dir, const char *name) {
+    char path[MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *file = fopen(path, "w");
+    assert(file);
+    fputs("@0\n", file);
+    fclose(file);
+}
+
+void test_file_list_directory(void) {
+    char dir[] = "/tmp/test_file_list_XXXXXX";
+    assert(mkdtemp(dir));
+    touch(dir, "Zeta.asm");
+    touch(dir, "Alpha.asm");
+    touch(dir, "Other.vm");
+    char subdir[MAX_PATH_LEN];
+    snprintf(subdir, sizeof(subdir), "%s/Nested.asm", dir);
+    assert(mkdir(subdir, 0700) == 0);  // A directory with a matching name is not a file
+
+    FileList *list = file_list_new();
+    assert(list);
+    assert(file_list_add(list, dir, EXT_ASM));
+    assert(list->count == 2);
+
+    // Single files are added only if the extension matches
+    char single[MAX_PATH_LEN];
+    snprintf(single, sizeof(single), "%s/Other.vm", dir);
+    assert(file_list_add(list, single, EXT_ASM));
+    assert(list->count == 2);
+    assert(!file_list_add(list, "/nonexistent/path.asm", EXT_ASM));
+
+    // Adding the same file again is undone by sorting and removing duplicates
+    char alpha[MAX_PATH_LEN];
+    snprintf(alpha, sizeof(alpha), "%s/Alpha.asm", dir);
+    assert(file_list_add(list, alpha, EXT_ASM));
+    assert(list->count == 3);
+    file_list_sort(list);
+    file_list_remove_duplicates(list);
+    assert(list->count == 2);
+    assert(strstr(list->files[0].full_path, "/Alpha.asm"));
+    assert(strcmp(list->files[1].base_name, "Zeta") == 0);
+
+    // Iteration opens files in order and tracks the current entry
+    assert(file_list_current_basename(list) == NULL);
+    FILE *file = file_list_open_next(list);
+    assert(file);
+    fclose(file);
+    assert(strcmp(file_list_current_basename(list), "Alpha") == 0);
+    assert(strncmp(file_list_current_source(list), dir, strlen(dir)) == 0);
+    file = file_list_open_next(list);
+    assert(file);
+    fclose(file);
+    assert(file_list_open_next(list) == NULL);
+    file_list_reset(list);
+    assert(list->index == 0);
+
+    file_list_free(list);
+
+    // Clean up
+    char path[MAX_PATH_LEN];
+    const char *names[] = {"Zeta.asm", "Alpha.asm", "Other.vm"};
+    for (size_t i = 0; i < 3; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(subdir);
+    rmdir(dir);
+
+    printf("\t✅ test_file_list_directory passed!\n");
+}
@@ -0,0 +1,172 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "logger.h"
+
+#define LOG_THREADS 4
+#define LOG_RECORDS 5000
+
+static int evaluated = 0;
+
+static int count_evaluation(void) {
+    return ++evaluated;
+}
+
+void test_logger_memory(void) {
+    Logger *logger = logger_create(NULL, LOG_WARN, false);
+    assert(logger != NULL);
+    logger_set_global(logger);
+
+    // Filtered levels do not even evaluate their arguments
+    GLOG(LOG_INFO, "skipped %d", count_evaluation());
+    assert(evaluated == 0);
+    GLOG(LOG_ERROR, "kept %d", count_evaluation());
+    GUSERLOG(LOG_WARN, "prog.asm", 7, "with a location");
+    assert(evaluated == 1);
+
+    char *text = NULL;
+    size_t size = 0;
+    FILE *dump = open_memstream(&text, &size);
+    logger_dump(logger, dump);
+    fclose(dump);
+    assert(text[0] == '[' && strstr(text, "] ERROR: kept 1\n") != NULL);
+    assert(strstr(text, "] WARN [prog.asm:7]: with a location\n") != NULL);
+    assert(strstr(text, "skipped") == NULL);
+    free(text);
+
+    // Overlong messages are cut, but the record still ends with its newline
+    char long_message[2 * LOGGER_RECORD_MAX];
+    memset(long_message, 'x', sizeof(long_message) - 1);
+    long_message[sizeof(long_message) - 1] = '\0';
+    logger_clear(logger);
+    GLOG(LOG_ERROR, "%s", long_message);
+    const char *contents = logger_contents(logger, &size, NULL);
+    assert(size < LOGGER_RECORD_MAX && contents[size - 1] == '\n');
+
+    logger_set_global(NULL);
+    logger_free(logger);
+    printf("\t✅ test_logger_memory passed!\n");
+}
+
+typedef struct {
+    Logger *logger;
+    int thread;
+} LogWriter;
+
+static void *log_records(void *arg) {
+    const LogWriter *writer = arg;
+    for (int i = 0; i < LOG_RECORDS; i++) GLOG(LOG_INFO, "%d %d", writer->thread, i);
+    return NULL;
+}
+
+void test_logger_async(void) {
+    char path[] = "/tmp/test_logger_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    Logger *logger = logger_create_async(path, LOG_INFO, false);
+    assert(logger != NULL);
+    logger_set_global(logger);
+    pthread_t threads[LOG_THREADS];
+    LogWriter writers[LOG_THREADS];
+    for (int i = 0; i < LOG_THREADS; i++) {
+        writers[i] = (LogWriter){logger, i};
+        assert(pthread_create(&threads[i], NULL, log_records, &writers[i]) == 0);
+    }
+    for (int i = 0; i < LOG_THREADS; i++) pthread_join(threads[i], NULL);
+    logger_set_global(NULL);
+    logger_free(logger);  // Drains the rings
+
+    // Every record arrives whole, and each thread's records keep their order
+    FILE *file = fopen(path, "r");
+    assert(file != NULL);
+    char line[256];
+    int next[LOG_THREADS] = {0};
+    int lines = 0;
+    while (fgets(line, sizeof(line), file)) {
+        int thread, index;
+        assert(strstr(line, "INFO: ") && sscanf(strstr(line, "INFO: ") + 6, "%d %d", &thread, &index) == 2);
+        assert(thread >= 0 && thread < LOG_THREADS && index == next[thread]++);
+        lines++;
+    }
+    fclose(file);
+    unlink(path);
+    assert(lines == LOG_THREADS * LOG_RECORDS);
+    printf("\t✅ test_logger_async passed!\n");
+}
+
+void test_logger_circular(void) {
+    Logger *logger = logger_create_memory(256, LOG_INFO, false);
+    assert(logger != NULL);
+    char *const buffer = logger->mem_buffer;
+
+    // Far more output than fits: only the latest records survive, in order, without reallocating
+    for (int i = 0; i < 1000; i++) logger_log(logger, LOG_INFO, NULL, 0, "record %04d", i);
+    assert(logger->mem_buffer == buffer && logger->mem_size == 256);
+    size_t size;
+    bool dropped;
+    const char *contents = logger_contents(logger, &size, &dropped);
+    assert(dropped && size > 0 && size <= 256);
+    char kept[257];
+    memcpy(kept, contents, size);
+    kept[size] = '\0';
+    assert(kept[0] == '[');  // Starts at a whole record
+    assert(strstr(kept, "record 0999\n") == kept + size - strlen("record 0999\n"));
+
+    // Asking again returns the same contents, still noting the loss
+    size_t again_size;
+    bool again_dropped;
+    const char *again = logger_contents(logger, &again_size, &again_dropped);
+    assert(again_dropped && again_size == size && memcmp(again, kept, size) == 0);
+    int previous = -1;
+    for (const char *p = strstr(kept, "record "); p; p = strstr(p + 1, "record ")) {
+        const int index = atoi(p + 7);
+        assert(previous < 0 || index == previous + 1);
+        previous = index;
+    }
+
+    // Logging continues correctly after the buffer was rearranged, and the dump notes the loss
+    logger_log(logger, LOG_INFO, NULL, 0, "after");
+    char *text = NULL;
+    size_t text_size = 0;
+    FILE *dump = open_memstream(&text, &text_size);
+    logger_dump(logger, dump);
+    fclose(dump);
+    assert(strncmp(text, "... earlier log output dropped ...\n[", 36) == 0);
+    assert(strstr(text, "record 0999\n") && strstr(text, "INFO: after\n") == text + text_size - 12);
+    free(text);
+
+    // Cleared logs start over
+    logger_clear(logger);
+    contents = logger_contents(logger, &size, &dropped);
+    assert(size == 0 && !dropped);
+    logger_free(logger);
+
+    // A wrap that lands exactly on a record boundary keeps every record it did not overwrite
+    Logger *sizing = logger_create_memory(256, LOG_INFO, false);
+    logger_log(sizing, LOG_INFO, NULL, 0, "record %04d", 0);
+    size_t record_size;
+    logger_contents(sizing, &record_size, NULL);
+    logger_free(sizing);
+    logger = logger_create_memory(3 * record_size, LOG_INFO, false);
+    for (int i = 0; i < 4; i++) logger_log(logger, LOG_INFO, NULL, 0, "record %04d", i);
+    for (int read = 0; read < 2; read++) {
+        contents = logger_contents(logger, &size, &dropped);
+        assert(dropped && size == 3 * record_size && contents[0] == '[');
+        assert(strncmp(contents + record_size - 12, "record 0001\n", 12) == 0);
+        assert(strncmp(contents + size - 12, "record 0003\n", 12) == 0);
+    }
+    logger_free(logger);
+    printf("\t✅ test_logger_circular passed!\n");
+}
+
+int main(void) {
+    test_logger_memory();
+    test_logger_circular();
+    test_logger_async();
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "output_buffer.h"
+
+void test_output_buffer(void);
+void test_output_buffer_memstream(void);
+
+int main(void) {
+    test_output_buffer();
+    test_output_buffer_memstream();
+    return 0;
+}
+
+void test_output_buffer(void) {
+    OutputBuffer *buffer = output_buffer_create(4);
+    assert(buffer != NULL);
+
+    // Appends grow the buffer past its initial capacity
+    assert(output_buffer_append(buffer, "hello ", 6));
+    char *claimed = output_buffer_claim(buffer, 6);
+    assert(claimed != NULL);
+    memcpy(claimed, "world\n", 6);
+    assert(buffer->size == 12);
+
+    // Flushing to a descriptor-backed stream writes everything after any stdio-buffered data
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    fputs("> ", file);
+    assert(output_buffer_flush(buffer, file));
+    assert(buffer->size == 0);
+
+    rewind(file);
+    char contents[32] = {0};
+    assert(fread(contents, 1, sizeof(contents) - 1, file) == 14);
+    assert(strcmp(contents, "> hello world\n") == 0);
+    fclose(file);
+
+    output_buffer_free(buffer);
+
+    printf("\t✅ test_output_buffer passed!\n");
+}
+
+void test_output_buffer_memstream(void) {
+    OutputBuffer *buffer = output_buffer_create(0);
+    assert(buffer != NULL);
+    assert(output_buffer_append(buffer, "abc", 3));
+
+    // Streams without a descriptor fall back to fwrite
+    char *data = NULL;
+    size_t size = 0;
+    FILE *stream = open_memstream(&data, &size);
+    assert(stream != NULL);
+    assert(output_buffer_flush(buffer, stream));
+    fclose(stream);
+    assert(size == 3 && memcmp(data, "abc", 3) == 0);
+    free(data);
+
+    output_buffer_free(buffer);
+
+    printf("\t✅ test_output_buffer_memstream passed!\n");
+}
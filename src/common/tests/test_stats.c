@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+
+static volatile unsigned long sink;
+
+static void spin(void) {
+    for (unsigned long i = 0; i < 2000000; i++) sink += i;
+}
+
+void test_stats_phases(void) {
+    // Nothing is recorded without a global instance
+    StatsMark mark;
+    stats_begin(&mark);
+    assert(!mark.active);
+    stats_count("ignored", 1);
+
+    Stats *stats = stats_create();
+    assert(stats != NULL);
+    stats_set_global(stats);
+    assert(stats_get_global() == stats);
+
+    // Repeated phases and counters accumulate, in first-recorded order
+    for (int i = 0; i < 3; i++) {
+        stats_begin(&mark);
+        spin();
+        stats_end("lex", &mark);
+        stats_count("lines", 10);
+    }
+    stats_begin(&mark);
+    stats_end("write", &mark);
+    stats_set_global(NULL);
+
+    assert(stats->phase_count == 2 && stats->counter_count == 1);
+    assert(strcmp(stats->phases[0].name, "lex") == 0 && strcmp(stats->phases[1].name, "write") == 0);
+    assert(stats->phases[0].wall_ns > 0 && stats->phases[0].cpu_ns > 0);
+    assert(strcmp(stats->counters[0].name, "lines") == 0 && stats->counters[0].value == 30);
+
+    char *text = NULL;
+    size_t size = 0;
+    FILE *report = open_memstream(&text, &size);
+    stats_report(stats, report, true);
+    fclose(report);
+    assert(strncmp(text, "{\"phases\":{\"lex\":{\"wall_ms\":", 27) == 0);
+    assert(strstr(text, "\"counters\":{\"lines\":30,\"lines_per_second\":") != NULL);
+    assert(strstr(text, "\"peak_rss_kb\":") != NULL && text[size - 2] == '}' && text[size - 1] == '\n');
+    free(text);
+
+    report = open_memstream(&text, &size);
+    stats_report(stats, report, false);
+    fclose(report);
+    assert(strstr(text, "\nlex ") && strstr(text, "\ntotal ") && strstr(text, "\npeak RSS "));
+    free(text);
+
+    stats_free(stats);
+    printf("\t✅ test_stats_phases passed!\n");
+}
+
+int main(void) {
+    test_stats_phases();
+    return 0;
+}
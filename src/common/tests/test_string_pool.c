@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "string_pool.h"
+
+void test_string_pool(void);
+void test_string_pool_growth(void);
+void test_string_pool_truncate(void);
+
+int main(void) {
+    test_string_pool();
+    test_string_pool_growth();
+    test_string_pool_truncate();
+    return 0;
+}
+
+void test_string_pool(void) {
+    StringPool *pool = string_pool_create();
+    assert(pool != NULL);
+
+    // Distinct strings get dense ids in insertion order
+    const StringId sp = string_pool_intern(pool, "SP", 2);
+    const StringId loop = string_pool_intern(pool, "LOOP", 4);
+    assert(sp == 0);
+    assert(loop == 1);
+    assert(string_pool_count(pool) == 2);
+
+    // Interning the same text again returns the same id, including from a non-terminated span
+    const char *line = "@LOOP;JMP";
+    assert(string_pool_intern(pool, line + 1, 4) == loop);
+    assert(string_pool_count(pool) == 2);
+
+    // Stored strings are null-terminated copies with precomputed hashes
+    assert(strcmp(string_pool_get(pool, loop), "LOOP") == 0);
+    assert(string_pool_length(pool, loop) == 4);
+    assert(string_pool_hash(pool, loop) == string_pool_hash_bytes("LOOP", 4));
+    assert(string_pool_hash(pool, loop) != 0);
+
+    // Find does not insert
+    assert(string_pool_find(pool, "SP", 2) == sp);
+    assert(string_pool_find(pool, "MISSING", 7) == STRING_ID_NONE);
+    assert(string_pool_count(pool) == 2);
+
+    // Prefixes are distinct strings
+    const StringId l = string_pool_intern(pool, "L", 1);
+    assert(l != loop);
+
+    // Invalid arguments
+    assert(string_pool_get(pool, STRING_ID_NONE) == NULL);
+    assert(string_pool_get(pool, 1000) == NULL);
+    assert(string_pool_intern(NULL, "x", 1) == STRING_ID_NONE);
+    assert(string_pool_intern(pool, NULL, 0) == STRING_ID_NONE);
+
+    string_pool_free(pool);
+
+    printf("\t✅ test_string_pool passed!\n");
+}
+
+void test_string_pool_growth(void) {
+    StringPool *pool = string_pool_create();
+    assert(pool != NULL);
+
+    // Pointers handed out before growth stay valid afterwards
+    const StringId first = string_pool_intern(pool, "first", 5);
+    const char *first_str = string_pool_get(pool, first);
+
+    char buffer[32];
+    for (int i = 0; i < 50000; i++) {
+        const int n = snprintf(buffer, sizeof(buffer), "sym_%d", i);
+        assert(string_pool_intern(pool, buffer, (size_t)n) == (StringId)(i + 1));
+    }
+    assert(string_pool_count(pool) == 50001);
+    assert(string_pool_get(pool, first) == first_str);
+
+    for (int i = 0; i < 50000; i++) {
+        const int n = snprintf(buffer, sizeof(buffer), "sym_%d", i);
+        assert(string_pool_find(pool, buffer, (size_t)n) == (StringId)(i + 1));
+        assert(strcmp(string_pool_get(pool, (StringId)(i + 1)), buffer) == 0);
+    }
+
+    // Strings larger than a storage block are supported
+    static char large[100000];
+    memset(large, 'x', sizeof(large));
+    const StringId big = string_pool_intern(pool, large, sizeof(large));
+    assert(big != STRING_ID_NONE);
+    assert(string_pool_length(pool, big) == sizeof(large));
+
+    string_pool_free(pool);
+
+    printf("\t✅ test_string_pool_growth passed!\n");
+}
+
+void test_string_pool_truncate(void) {
+    StringPool *pool = string_pool_create();
+    assert(pool != NULL);
+    const StringId keep = string_pool_intern(pool, "KEEP", 4);
+    const char *keep_str = string_pool_get(pool, keep);
+
+    // Enough strings to span several storage blocks
+    char buffer[32];
+    for (int i = 0; i < 20000; i++) {
+        const int n = snprintf(buffer, sizeof(buffer), "label_%d", i);
+        assert(string_pool_intern(pool, buffer, (size_t)n) != STRING_ID_NONE);
+    }
+
+    string_pool_truncate(pool, 1);
+    assert(string_pool_count(pool) == 1);
+    assert(string_pool_get(pool, keep) == keep_str);
+    assert(string_pool_find(pool, "KEEP", 4) == keep);
+    assert(string_pool_find(pool, "label_0", 7) == STRING_ID_NONE);
+
+    // Dropped ids are handed out again
+    assert(string_pool_intern(pool, "label_5", 7) == 1);
+    assert(strcmp(string_pool_get(pool, 1), "label_5") == 0);
+    assert(strcmp(keep_str, "KEEP") == 0);
+
+    string_pool_truncate(pool, 0);
+    assert(string_pool_count(pool) == 0);
+    assert(string_pool_intern(pool, "again", 5) == 0);
+
+    string_pool_free(pool);
+
+    printf("\t✅ test_string_pool_truncate passed!\n");
+}
@@ -0,0 +1,109 @@
+#include "thread_pool.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void test_thread_pool_runs_all_tasks(void);
+void test_thread_pool_nested_groups(void);
+void test_thread_pool_pinned(void);
+
+int main(void) {
+    test_thread_pool_runs_all_tasks();
+    test_thread_pool_nested_groups();
+    test_thread_pool_pinned();
+    return 0;
+}
+
+static void square(void *arg) {
+    long *value = arg;
+    *value = *value * *value;
+}
+
+void test_thread_pool_runs_all_tasks(void) {
+    ThreadPool *pool = thread_pool_create(4, false);
+    assert(pool);
+    assert(thread_pool_size(pool) == 4);
+
+    // More tasks than the initial deque capacity, so deques must grow
+    const long count = 10000;
+    long *values = malloc((size_t)count * sizeof(long));
+    assert(values);
+    for (long i = 0; i < count; i++) values[i] = i;
+
+    TaskGroup *group = task_group_create(pool);
+    assert(group);
+    for (long i = 0; i < count; i++) assert(task_group_submit(group, square, &values[i]));
+    task_group_wait(group);
+    for (long i = 0; i < count; i++) assert(values[i] == i * i);
+
+    // A group can be reused after waiting
+    for (long i = 0; i < 10; i++) {
+        values[i] = 3;
+        assert(task_group_submit(group, square, &values[i]));
+    }
+    task_group_join(group);
+    for (long i = 0; i < 10; i++) assert(values[i] == 9);
+
+    free(values);
+    thread_pool_free(pool);
+    printf("\t✅ test_thread_pool_runs_all_tasks passed!\n");
+}
+
+typedef struct {
+    ThreadPool *pool;
+    atomic_int *leaves;
+} Parent;
+
+static void leaf(void *arg) {
+    atomic_fetch_add((atomic_int *)arg, 1);
+}
+
+// Every parent task fans out and waits on its own group from inside the pool
+static void parent(void *arg) {
+    const Parent *p = arg;
+    TaskGroup *group = task_group_create(p->pool);
+    assert(group);
+    for (int i = 0; i < 100; i++) assert(task_group_submit(group, leaf, p->leaves));
+    task_group_join(group);
+}
+
+void test_thread_pool_nested_groups(void) {
+    // A single worker proves that waiting tasks help instead of blocking the pool
+    for (unsigned workers = 1; workers <= 3; workers += 2) {
+        ThreadPool *pool = thread_pool_create(workers, false);
+        assert(pool);
+        atomic_int leaves;
+        atomic_init(&leaves, 0);
+        Parent p = {.pool = pool, .leaves = &leaves};
+
+        TaskGroup *group = task_group_create(pool);
+        for (int i = 0; i < 50; i++) assert(task_group_submit(group, parent, &p));
+        task_group_join(group);
+        assert(atomic_load(&leaves) == 50 * 100);
+
+        thread_pool_free(pool);
+    }
+    printf("\t✅ test_thread_pool_nested_groups passed!\n");
+}
+
+void test_thread_pool_pinned(void) {
+    ThreadPool *pool = thread_pool_create(0, true);
+    assert(pool);
+    assert(thread_pool_size(pool) >= 1);
+
+    long value = 7;
+    TaskGroup *group = task_group_create(pool);
+    assert(task_group_submit(group, square, &value));
+    task_group_join(group);
+    assert(value == 49);
+
+    // The global slot is only a registry
+    assert(thread_pool_get_global() == NULL);
+    thread_pool_set_global(pool);
+    assert(thread_pool_get_global() == pool);
+    thread_pool_set_global(NULL);
+
+    thread_pool_free(pool);
+    printf("\t✅ test_thread_pool_pinned passed!\n");
+}
@@ -9,75 +9,182 @@ typedef struct {
     char *value;
 } MockToken;
 
-// Free function matching TokenFreeFunc
-void mock_token_free(void *token) {
+// Release function matching TokenFreeFunc (the record itself is owned by the table)
+void mock_token_release(void *token) {
     MockToken *mt = (MockToken *)token;
     free(mt->value);
-    free(mt);
 }
 
 // To-string function matching TokenToStr
-char *mock_token_to_str(void *token) {
+char *mock_token_to_str(void *token, const void *context) {
+    (void)context;
     MockToken *mt = (MockToken *)token;
     char *str = malloc(strlen(mt->value) + 1);
     if (str) strcpy(str, mt->value);
     return str;
 }
 
-// Helper to create a MockToken
-MockToken *create_mock_token(const char *value) {
-    MockToken *mt = malloc(sizeof(MockToken));
-    if (!mt) return NULL;
-    mt->value = strdup(value);
-    if (!mt->value) {
-        free(mt);
-        return NULL;
-    }
+// Helper to create a MockToken record
+MockToken create_mock_token(const char *value) {
+    MockToken mt = {.value = strdup(value)};
     return mt;
 }
 
 void test_token_table(void);
+void test_token_table_peek_and_index(void);
+void test_token_table_many_tokens(void);
+void test_token_table_splice(void);
 
 int main(void) {
     test_token_table();
+    test_token_table_peek_and_index();
+    test_token_table_many_tokens();
+    test_token_table_splice();
     return 0;
 }
 
 void test_token_table(void) {
-    TokenTable *table = token_table_create(mock_token_free, mock_token_to_str);
+    TokenTable *table = token_table_create(sizeof(MockToken), mock_token_release, mock_token_to_str);
     assert(table != NULL);
 
     // Create mock tokens
-    MockToken *token1 = create_mock_token("FIRST");
-    MockToken *token2 = create_mock_token("SECOND");
-    MockToken *token3 = create_mock_token("THIRD");
+    MockToken token1 = create_mock_token("FIRST");
+    MockToken token2 = create_mock_token("SECOND");
+    MockToken token3 = create_mock_token("THIRD");
 
-    assert(token1 && token2 && token3);
+    assert(token1.value && token2.value && token3.value);
 
-    // Add tokens to the table
-    assert(token_table_add(table, token1));
-    assert(token_table_add(table, token2));
-    assert(token_table_add(table, token3));
+    // Add tokens to the table (records are copied, ownership of 'value' moves to the table)
+    assert(token_table_add(table, &token1));
+    assert(token_table_add(table, &token2));
+    assert(token_table_add(table, &token3));
+    assert(token_table_size(table) == 3);
 
     // Verify retrieval order
     token_table_reset(table);
-    void *retrieved = token_table_next(table);
-    assert(retrieved == token1);
+    MockToken *retrieved = token_table_next(table);
+    assert(retrieved && strcmp(retrieved->value, "FIRST") == 0);
 
     retrieved = token_table_next(table);
-    assert(retrieved == token2);
+    assert(retrieved && strcmp(retrieved->value, "SECOND") == 0);
 
     retrieved = token_table_next(table);
-    assert(retrieved == token3);
+    assert(retrieved && strcmp(retrieved->value, "THIRD") == 0);
 
     assert(token_table_next(table) == NULL);
 
+    // Invalid arguments
+    assert(token_table_create(0, NULL, NULL) == NULL);
+    assert(!token_table_add(table, NULL));
+    assert(!token_table_add(NULL, &token1));
+
     // Test writing to file (stdout here)
 //    printf("Tokens in table:\n");
-//    token_table_write_to_file(stdout, table);
+//    token_table_write_to_file(stdout, table, NULL);
 
     // Clean up
     token_table_free(table);
 
     printf("\t✅ test_token_table passed!\n");
 }
+
+void test_token_table_peek_and_index(void) {
+    TokenTable *table = token_table_create(sizeof(int), NULL, NULL);
+    assert(table != NULL);
+
+    for (int i = 0; i < 5; i++) {
+        assert(token_table_add(table, &i));
+    }
+
+    // Multi-token peek does not move the iterator
+    token_table_reset(table);
+    assert(*(int *)token_table_peek(table) == 0);
+    assert(*(int *)token_table_peek_ahead(table, 3) == 3);
+    assert(token_table_peek_ahead(table, 5) == NULL);
+    assert(*(int *)token_table_next(table) == 0);
+
+    // Skipping advances the iterator and clamps at the end
+    token_table_skip(table, 2);
+    assert(*(int *)token_table_peek(table) == 3);
+    token_table_skip(table, 100);
+    assert(token_table_peek(table) == NULL);
+    assert(token_table_next(table) == NULL);
+
+    // Index access is independent of the iterator
+    assert(*(int *)token_table_get(table, 4) == 4);
+    assert(token_table_get(table, 5) == NULL);
+
+    token_table_free(table);
+
+    printf("\t✅ test_token_table_peek_and_index passed!\n");
+}
+
+void test_token_table_many_tokens(void) {
+    TokenTable *table = token_table_create(sizeof(int), NULL, NULL);
+    assert(table != NULL);
+
+    // Spans many chunks; earlier records must not move as the table grows
+    const int count = 100000;
+    assert(token_table_add(table, &(int){0}));
+    const int *first = token_table_get(table, 0);
+    for (int i = 1; i < count; i++) {
+        assert(token_table_add(table, &i));
+    }
+    assert(token_table_size(table) == (size_t)count);
+    assert(token_table_get(table, 0) == first);
+
+    // Spans cover every record exactly once, in order
+    size_t run = 0;
+    int expected = 0;
+    for (const int *span; (span = token_table_span(table, (size_t)expected, &run)) != NULL;) {
+        assert(run > 0 && span == token_table_get(table, (size_t)expected));
+        for (size_t i = 0; i < run; i++) assert(span[i] == expected++);
+    }
+    assert(expected == count && token_table_span(table, (size_t)count, &run) == NULL);
+
+    token_table_reset(table);
+    for (int i = 0; i < count; i++) {
+        const int *value = token_table_next(table);
+        assert(value && *value == i);
+    }
+    assert(token_table_next(table) == NULL);
+
+    // Clearing keeps the chunks for reuse
+    token_table_clear(table);
+    assert(token_table_size(table) == 0);
+    assert(token_table_next(table) == NULL);
+    assert(token_table_add(table, &(int){42}));
+    assert(token_table_get(table, 0) == first && *first == 42);
+
+    token_table_free(table);
+
+    printf("\t✅ test_token_table_many_tokens passed!\n");
+}
+
+void test_token_table_splice(void) {
+    TokenTable *dst = token_table_create(sizeof(int), NULL, NULL);
+    TokenTable *src = token_table_create(sizeof(int), NULL, NULL);
+    assert(dst && src);
+
+    // Unaligned sizes on both sides so runs straddle chunk boundaries
+    const int dst_count = 5000, src_count = 9000;
+    for (int i = 0; i < dst_count; i++) assert(token_table_add(dst, &i));
+    for (int i = dst_count; i < dst_count + src_count; i++) assert(token_table_add(src, &i));
+
+    assert(token_table_splice(dst, src));
+    assert(token_table_size(src) == 0);
+    assert(token_table_size(dst) == (size_t)(dst_count + src_count));
+    for (int i = 0; i < dst_count + src_count; i++) {
+        assert(*(int *)token_table_get(dst, (size_t)i) == i);
+    }
+
+    // Mismatched record sizes are rejected
+    TokenTable *other = token_table_create(sizeof(long), NULL, NULL);
+    assert(!token_table_splice(dst, other));
+
+    token_table_free(other);
+    token_table_free(src);
+    token_table_free(dst);
+
+    printf("\t✅ test_token_table_splice passed!\n");
+}